@@ -0,0 +1,958 @@
+#include <cstdlib>
+#include <ctime>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <set>
+#include <atomic>
+#include <new>
+#include <sys/resource.h>
+
+#include "trieNode.h"
+#include "concurrentTrieNode.h"
+
+using namespace std;
+
+/**
+ * Return the number of milliseconds elapsed since start.
+ */
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Build one shard: numKeys URL-like keys ("/section/page/item"), so that shards
+ * share their upper levels and differ further down.
+ */
+TrieNode<char> *buildShard(unsigned seed, int numKeys)
+{
+    srand(seed);
+    TrieNode<char> *shard = new TrieNode<char>();
+    for (int i = 0; i < numKeys; i++) {
+        stringstream key;
+        key << "/s" << rand() % 16 << "/p" << rand() % 1000 << "/i" << rand();
+        shard->insert(key.str());
+    }
+    return shard;
+}
+
+/*
+ * The suite: every basic TrieNode operation (and stats()) on four reproducible datasets, reporting
+ * ns/op, nodes/s, heap allocations and peak RSS, and optionally writing the results as
+ * CSV (--csv FILE) so that runs on two commits can be diffed.
+ */
+
+// Heap allocations so far (every TrieNode and container buffer goes through these).
+// They are kept out of line, so that GCC does not see free() meet operator new.
+static atomic<uint64_t> numAllocations(0);
+
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    numAllocations.fetch_add(1, memory_order_relaxed);
+    void *ptr = malloc(size > 0 ? size : 1);
+    if (ptr == NULL) {
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+__attribute__((noinline)) void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete[](void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+/**
+ * Reset the peak RSS of this process to its current RSS (Linux only; elsewhere the
+ * peak stays the peak since startup).
+ */
+void resetPeakRss()
+{
+    ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+/**
+ * Return the peak RSS of this process in kB, since the last resetPeakRss().
+ */
+long peakRssKb()
+{
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return atol(line.c_str() + 6);
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * splitmix64: the datasets must be the same on every machine, which rand() is not.
+ */
+struct BenchRandom
+{
+    uint64_t state;
+
+    explicit BenchRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    size_t below(size_t n) { return next() % n; }
+
+    string word(size_t minLength, size_t maxLength)
+    {
+        string word(minLength + below(maxLength - minLength + 1), ' ');
+        for (size_t i = 0; i < word.size(); i++) {
+            word[i] = 'a' + below(26);
+        }
+        return word;
+    }
+};
+
+/**
+ * A named list of keys, in the order they are inserted and looked up.
+ */
+struct BenchDataset
+{
+    string name;
+    vector<string> keys;
+};
+
+/**
+ * The datasets:
+ *      uniform - random lowercase keys of 4 to 16 letters
+ *      zipf    - two-word phrases, words drawn from a Zipfian (s = 1) vocabulary, so
+ *                a few prefixes (and repeated keys) dominate
+ *      url     - URL-like keys whose hosts and path segments are shared a lot
+ *      chains  - a few hundred random keys thousands of values long
+ */
+vector<BenchDataset> benchDatasets()
+{
+    vector<BenchDataset> datasets(4);
+    BenchRandom random(2024);
+
+    datasets[0].name = "uniform";
+    for (int i = 0; i < 200000; i++) {
+        datasets[0].keys.push_back(random.word(4, 16));
+    }
+
+    datasets[1].name = "zipf";
+    vector<string> vocabulary;
+    vector<double> cumulative;
+    double total = 0;
+    for (int rank = 1; rank <= 20000; rank++) {
+        vocabulary.push_back(random.word(3, 10));
+        total += 1.0 / rank;
+        cumulative.push_back(total);
+    }
+    for (int i = 0; i < 200000; i++) {
+        string phrase;
+        for (int w = 0; w < 2; w++) {
+            double x = (random.next() >> 11) * (total / 9007199254740992.0);
+            size_t rank = lower_bound(cumulative.begin(), cumulative.end(), x) - cumulative.begin();
+            phrase += (w > 0 ? " " : "") + vocabulary[min(rank, vocabulary.size() - 1)];
+        }
+        datasets[1].keys.push_back(phrase);
+    }
+
+    datasets[2].name = "url";
+    for (int i = 0; i < 200000; i++) {
+        stringstream url;
+        url << "https://host" << random.below(50) << ".example.com/" << vocabulary[random.below(100)] << "/"
+            << vocabulary[random.below(2000)] << "/" << random.next() % 1000000;
+        datasets[2].keys.push_back(url.str());
+    }
+
+    datasets[3].name = "chains";
+    for (int i = 0; i < 256; i++) {
+        datasets[3].keys.push_back(random.word(2000, 2000));
+    }
+    return datasets;
+}
+
+/**
+ * One row of the suite's results.
+ */
+struct BenchResult
+{
+    string dataset;
+    string operation;
+    uint64_t ops;           // operations per run
+    uint64_t nodes;         // TrieNodes touched per run
+    double nsPerOp;         // best of the runs
+    double nodesPerSec;
+    uint64_t allocations;   // heap allocations in one run
+    long peakRssKb;         // peak RSS of the process during the runs (the datasets and
+                            // whatever the allocator kept from earlier ones included)
+};
+
+/**
+ * Time op (ops operations touching nodes TrieNodes) over the given number of runs,
+ * keeping the best. Operations that change the Trie must use one run.
+ */
+template<class Op> BenchResult measure(const string &dataset, const string &operation, uint64_t ops,
+    uint64_t nodes, int runs, Op op)
+{
+    BenchResult result = { dataset, operation, ops, nodes, 0, 0, 0, 0 };
+    double bestNs = numeric_limits<double>::max();
+    resetPeakRss();
+    for (int run = 0; run < runs; run++) {
+        uint64_t allocationsBefore = numAllocations.load();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        op();
+        bestNs = min(bestNs, chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+        result.allocations = numAllocations.load() - allocationsBefore;
+    }
+    result.peakRssKb = peakRssKb();
+    result.nsPerOp = bestNs / max(ops, (uint64_t) 1);
+    result.nodesPerSec = nodes * 1e9 / max(bestNs, 1.0);
+    return result;
+}
+
+/**
+ * Run every operation on every dataset; print a table, and write CSV to csvPath
+ * unless it is empty.
+ */
+void benchSuite(const string &csvPath)
+{
+    const int RUNS = 3;
+    vector<BenchResult> results;
+    ofstream sink("/dev/null");
+    uint64_t checksum = 0;      // keeps lookups from being optimized away
+
+    vector<BenchDataset> datasets = benchDatasets();
+    for (size_t d = 0; d < datasets.size(); d++) {
+        const string &name = datasets[d].name;
+        const vector<string> &keys = datasets[d].keys;
+        // Lookups touch one TrieNode per value; the probes all end in a miss.
+        vector<string> probes;
+        uint64_t totalLength = 0;
+        for (size_t i = 0; i < keys.size(); i++) {
+            probes.push_back(keys[i] + "#tail");
+            totalLength += keys[i].size();
+        }
+
+        TrieNode<char> *trie = new TrieNode<char>();
+        results.push_back(measure(name, "insert", keys.size(), 0, 1, [&]() {
+            for (size_t i = 0; i < keys.size(); i++) {
+                trie->insert(keys[i]);
+            }
+        }));
+        const uint64_t NUM_NODES = trie->size();
+        results.back().nodes = NUM_NODES;
+        results.back().nodesPerSec = NUM_NODES * 1e9 / (results.back().nsPerOp * keys.size());
+
+        results.push_back(measure(name, "find", keys.size(), totalLength, RUNS, [&]() {
+            for (size_t i = 0; i < keys.size(); i++) {
+                checksum += trie->find(keys[i]) != NULL;
+            }
+        }));
+        results.push_back(measure(name, "longestPrefix", keys.size(), totalLength, RUNS, [&]() {
+            for (size_t i = 0; i < probes.size(); i++) {
+                size_t length = 0;
+                trie->longestPrefix(probes[i], &length);
+                checksum += length;
+            }
+        }));
+        results.push_back(measure(name, "size", NUM_NODES, NUM_NODES, RUNS, [&]() {
+            for (TrieNode<char> &node : *trie) {
+                checksum += node.size();
+            }
+        }));
+
+        TrieNode<char> *copy = NULL;
+        results.push_back(measure(name, "clone", 1, NUM_NODES, 1, [&]() {
+            copy = trie->clone();
+        }));
+        results.push_back(measure(name, "equality", 1, 2 * NUM_NODES, 1, [&]() {
+            checksum += (*trie == *copy);
+        }));
+        results.push_back(measure(name, "display", 1, NUM_NODES, RUNS, [&]() {
+            sink << *trie;
+        }));
+        results.push_back(measure(name, "stats", 1, NUM_NODES, RUNS, [&]() {
+            checksum += trie->stats().totalBytes();
+        }));
+
+        // Merge the second half of the keys into a Trie of the first half.
+        TrieNode<char> *firstHalf = new TrieNode<char>(), *secondHalf = new TrieNode<char>();
+        for (size_t i = 0; i < keys.size(); i++) {
+            (i < keys.size() / 2 ? firstHalf : secondHalf)->insert(keys[i]);
+        }
+        results.push_back(measure(name, "merge", 1, secondHalf->size(), 1, [&]() {
+            *firstHalf += *secondHalf;
+        }));
+        delete firstHalf;
+        delete secondHalf;
+
+        delete copy;
+        results.push_back(measure(name, "destroy", 1, NUM_NODES, 1, [&]() {
+            delete trie;
+        }));
+    }
+
+    cout << "suite (best of " << RUNS << " for read-only operations):" << endl;
+    cout << "  " << left << setw(9) << "dataset" << setw(15) << "operation" << right << setw(14) << "ns/op"
+         << setw(14) << "nodes/s" << setw(12) << "allocs" << setw(12) << "peak kB" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        cout << "  " << left << setw(9) << r.dataset << setw(15) << r.operation << right << setw(14) << fixed
+             << setprecision(1) << r.nsPerOp << setw(14) << setprecision(0) << r.nodesPerSec << setw(12)
+             << r.allocations << setw(12) << r.peakRssKb << endl;
+    }
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6) << "  (checksum " << checksum << ")" << endl;
+
+    if (csvPath.empty()) {
+        return;
+    }
+    ofstream csv(csvPath.c_str());
+    csv << fixed << setprecision(1);
+    csv << "dataset,operation,ops,nodes,ns_per_op,nodes_per_sec,allocations,peak_rss_kb" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        csv << r.dataset << "," << r.operation << "," << r.ops << "," << r.nodes << "," << r.nsPerOp << ","
+            << r.nodesPerSec << "," << r.allocations << "," << r.peakRssKb << endl;
+    }
+}
+
+/**
+ * Merge the same shards with mergeAll on 1 to 64 threads, and compare against folding
+ * them in one at a time with "+=".
+ */
+void benchParallelMerge()
+{
+    const int NUM_SHARDS = 16;
+    const int KEYS_PER_SHARD = 20000;
+    vector<TrieNode<char> *> shards;
+    for (int i = 0; i < NUM_SHARDS; i++) {
+        shards.push_back(buildShard(i + 1, KEYS_PER_SHARD));
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    TrieNode<char> *sequential = new TrieNode<char>();
+    for (int i = 0; i < NUM_SHARDS; i++) {
+        *sequential += *shards[i];
+    }
+    double sequentialMs = elapsedMs(start);
+    cout << "mergeAll: " << NUM_SHARDS << " shards, " << sequential->size() << " nodes in result" << endl;
+    cout << "  sequential +=   " << fixed << setprecision(1) << setw(9) << sequentialMs << " ms" << endl;
+
+    for (unsigned threads = 1; threads <= 64; threads *= 2) {
+        start = chrono::steady_clock::now();
+        TrieNode<char> *merged = new TrieNode<char>();
+        merged->mergeAll(shards, threads);
+        double ms = elapsedMs(start);
+        if (*merged != *sequential) {
+            cout << "  mergeAll result differs from sequential merge!" << endl;
+        }
+        cout << "  " << setw(2) << threads << " thread(s)    " << setw(9) << ms << " ms  (x"
+             << setprecision(2) << sequentialMs / ms << ")" << setprecision(1) << endl;
+        delete merged;
+    }
+
+    delete sequential;
+    for (int i = 0; i < NUM_SHARDS; i++) {
+        delete shards[i];
+    }
+}
+
+/**
+ * Build the same Trie from sorted keys with insert (one lookup per value), with
+ * insertSorted (no lookups), into an arena, and straight into a FrozenTrie.
+ */
+void benchBulkLoad()
+{
+    const int NUM_KEYS = 300000;
+    srand(42);
+    vector<string> keys;
+    for (int i = 0; i < NUM_KEYS; i++) {
+        stringstream key;
+        key << "/s" << rand() % 16 << "/p" << rand() % 1000 << "/i" << rand();
+        keys.push_back(key.str());
+    }
+    sort(keys.begin(), keys.end());
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    TrieNode<char> *inserted = new TrieNode<char>();
+    for (size_t i = 0; i < keys.size(); i++) {
+        inserted->insert(keys[i]);
+    }
+    double insertMs = elapsedMs(start);
+    cout << "bulk load: " << NUM_KEYS << " sorted keys, " << inserted->size() << " nodes" << endl;
+    cout << "  insert          " << setw(9) << insertMs << " ms" << endl;
+
+    start = chrono::steady_clock::now();
+    TrieNode<char> *loaded = new TrieNode<char>();
+    loaded->insertSorted(keys);
+    double ms = elapsedMs(start);
+    cout << "  insertSorted    " << setw(9) << ms << " ms  (x" << setprecision(2) << insertMs / ms
+         << ")" << setprecision(1) << endl;
+    if (*loaded != *inserted) {
+        cout << "  insertSorted result differs from insert!" << endl;
+    }
+
+    start = chrono::steady_clock::now();
+    TrieNode<char, ArenaTrieTraits> *arenaLoaded = new TrieNode<char, ArenaTrieTraits>();
+    arenaLoaded->useArena();
+    arenaLoaded->insertSorted(keys);
+    ms = elapsedMs(start);
+    cout << "  + arena         " << setw(9) << ms << " ms  (x" << setprecision(2) << insertMs / ms
+         << ")" << setprecision(1) << endl;
+
+    start = chrono::steady_clock::now();
+    FrozenTrie<char> *frozen = FrozenTrie<char>::fromSorted(char(), keys);
+    ms = elapsedMs(start);
+    cout << "  fromSorted      " << setw(9) << ms << " ms  (x" << setprecision(2) << insertMs / ms
+         << ")" << setprecision(1) << endl;
+
+    delete inserted;
+    delete loaded;
+    delete arenaLoaded;
+    delete frozen;
+}
+
+/**
+ * Compare and merge two large Tries that differ in a single key: the first "=="
+ * computes the hashes, later ones reject from the cached root hashes, and "+="
+ * merges only the path to the difference (the identical subtrees beside it are
+ * just compared).
+ */
+void benchStructuralHash()
+{
+    TrieNode<char> *trie = buildShard(45, 300000);
+    TrieNode<char> *copy = trie->clone();
+    copy->insert(string("/s3/p7/extra"));
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool equal = (*trie == *copy);
+    double firstMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++) {
+        equal = equal || (*trie == *copy);
+    }
+    double cachedUs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    *trie += *copy;
+    double mergeMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    equal = !equal && (*trie == *copy);
+    double equalMs = elapsedMs(start);
+
+    cout << "structural hash: " << trie->size() << " nodes" << endl;
+    cout << "  == (hashing)    " << setw(9) << firstMs << " ms" << endl;
+    cout << "  == (cached)     " << setw(9) << cachedUs << " us/op" << endl;
+    cout << "  += (1 key off)  " << setw(9) << mergeMs << " ms" << endl;
+    cout << "  == (equal)      " << setw(9) << equalMs << " ms" << (equal ? "" : "  (unexpected result!)") << endl;
+    delete trie;
+    delete copy;
+}
+
+/**
+ * Return the p-th percentile (0-100) of the given latencies.
+ */
+double percentile(vector<double> latencies, double p)
+{
+    sort(latencies.begin(), latencies.end());
+    return latencies[min(latencies.size() - 1, size_t(p / 100 * latencies.size()))];
+}
+
+/**
+ * Autocomplete the 10 heaviest keys for single-letter and two-letter prefixes, with
+ * topK against walking the whole subtree below the prefix and sorting what it finds.
+ */
+void benchTopK()
+{
+    const int NUM_KEYS = 300000;
+    const size_t K = 10;
+    srand(46);
+    typedef TrieNode<char, WeightedTrieTraits> WeightedNode;
+    WeightedNode *root = new WeightedNode();
+    for (int i = 0; i < NUM_KEYS; i++) {
+        string key;
+        for (int length = 3 + rand() % 8; length > 0; length--) {
+            key += char('a' + rand() % 26);
+        }
+        // Heavy-tailed weights, as search counts tend to be.
+        root->insert(key, 1e6 / (1 + rand() % 100000));
+    }
+
+    cout << "top-" << K << " autocomplete: " << NUM_KEYS << " weighted keys" << endl;
+    for (int prefixLength = 1; prefixLength <= 2; prefixLength++) {
+        vector<double> topKUs, walkUs;
+        for (int q = 0; q < 500; q++) {
+            string prefix;
+            for (int i = 0; i < prefixLength; i++) {
+                prefix += char('a' + rand() % 26);
+            }
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            vector<pair<vector<char>, double> > top = root->topK(prefix, K);
+            topKUs.push_back(elapsedMs(start) * 1000);
+
+            start = chrono::steady_clock::now();
+            vector<double> weights;
+            vector<WeightedNode *> pending;
+            WeightedNode *node = root;
+            for (size_t i = 0; i < prefix.size() && node != NULL; i++) {
+                node = (*node)[prefix[i]];
+            }
+            if (node != NULL) {
+                pending.push_back(node);
+            }
+            while (!pending.empty()) {
+                node = pending.back();
+                pending.pop_back();
+                if (node->isEndOfKey()) {
+                    weights.push_back(node->getWeight());
+                }
+                for (int i = 0; i < node->getNumChildren(); i++) {
+                    pending.push_back(node->getChildAtIndex(i));
+                }
+            }
+            size_t found = min(K, weights.size());
+            partial_sort(weights.begin(), weights.begin() + found, weights.end(), greater<double>());
+            walkUs.push_back(elapsedMs(start) * 1000);
+            if (top.size() != found || (found > 0 && top[0].second != weights[0])) {
+                cout << "  topK result differs from walking!" << endl;
+            }
+        }
+        cout << "  prefix length " << prefixLength << ": topK p50 " << setw(7) << percentile(topKUs, 50)
+             << " us, p99 " << setw(7) << percentile(topKUs, 99) << " us; walk p50 " << setw(8)
+             << percentile(walkUs, 50) << " us, p99 " << setw(8) << percentile(walkUs, 99) << " us" << endl;
+    }
+    delete root;
+}
+
+/**
+ * Add every string one edit (insert, delete or replace one letter) away from each of
+ * words to variants.
+ */
+void addEditVariants(const set<string> &words, set<string> &variants)
+{
+    for (set<string>::const_iterator word = words.begin(); word != words.end(); ++word) {
+        for (size_t i = 0; i <= word->size(); i++) {
+            if (i < word->size()) {
+                variants.insert(word->substr(0, i) + word->substr(i + 1));
+            }
+            for (char c = 'a'; c <= 'z'; c++) {
+                variants.insert(word->substr(0, i) + c + word->substr(i));
+                if (i < word->size()) {
+                    variants.insert(word->substr(0, i) + c + word->substr(i + 1));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Typo-tolerant lookup of misspelled dictionary words: fuzzyFind against generating
+ * every string within the distance and probing the Trie for each.
+ */
+void benchFuzzyFind()
+{
+    const int NUM_KEYS = 200000;
+    const int NUM_QUERIES = 200;
+    srand(47);
+    TrieNode<char> *root = new TrieNode<char>();
+    vector<string> keys;
+    for (int i = 0; i < NUM_KEYS; i++) {
+        string key;
+        for (int length = 4 + rand() % 7; length > 0; length--) {
+            key += char('a' + rand() % 26);
+        }
+        root->insert(key);
+        keys.push_back(key);
+    }
+    vector<string> queries;
+    for (int q = 0; q < NUM_QUERIES; q++) {
+        string query = keys[rand() % keys.size()];
+        query[rand() % query.size()] = char('a' + rand() % 26);
+        queries.push_back(query);
+    }
+
+    cout << "fuzzy search: " << NUM_KEYS << " keys, " << NUM_QUERIES << " misspelled queries" << endl;
+    for (size_t distance = 1; distance <= 2; distance++) {
+        uint64_t numFound = 0, numProbed = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (size_t q = 0; q < queries.size(); q++) {
+            numFound += root->fuzzyFind(queries[q], distance).size();
+        }
+        double fuzzyMs = elapsedMs(start);
+
+        uint64_t numVariantHits = 0;
+        start = chrono::steady_clock::now();
+        for (size_t q = 0; q < queries.size(); q++) {
+            set<string> variants, frontier;
+            variants.insert(queries[q]);
+            for (size_t d = 0; d < distance; d++) {
+                frontier = variants;
+                addEditVariants(frontier, variants);
+            }
+            for (set<string>::iterator it = variants.begin(); it != variants.end(); ++it) {
+                numVariantHits += (root->find(*it) != NULL) ? 1 : 0;
+            }
+            numProbed += variants.size();
+        }
+        double variantMs = elapsedMs(start);
+        cout << "  distance " << distance << ": fuzzyFind " << setw(8) << fuzzyMs * 1000 / NUM_QUERIES
+             << " us/query, edit variants " << setw(9) << variantMs * 1000 / NUM_QUERIES << " us/query ("
+             << numProbed / NUM_QUERIES << " probes)" << (numFound == numVariantHits ? "" : "  results differ!")
+             << endl;
+    }
+    delete root;
+}
+
+/**
+ * Walk every node, and every key, of a large Trie: iterators against the explicit
+ * stack that callers used to write, and against rebuilding each key from the stack.
+ */
+void benchTraversal()
+{
+    TrieNode<char> *trie = buildShard(48, 300000);
+    uint64_t iteratedNodes = 0, stackedNodes = 0, iteratedKeys = 0, stackedKeys = 0, keyEnds = 0;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (TrieNode<char> &node : *trie) {
+        iteratedNodes++;
+        keyEnds += node.isEndOfKey();
+    }
+    double iteratorMs = elapsedMs(start);
+
+    start = chrono::steady_clock::now();
+    vector<TrieNode<char> *> pending(1, trie);
+    while (!pending.empty()) {
+        TrieNode<char> *node = pending.back();
+        pending.pop_back();
+        stackedNodes++;
+        for (int i = node->getNumChildren(); i-- > 0;) {
+            pending.push_back(node->getChildAtIndex(i));
+        }
+    }
+    double stackMs = elapsedMs(start);
+
+    start = chrono::steady_clock::now();
+    for (const vector<char> &key : trie->keys()) {
+        iteratedKeys += !key.empty();
+    }
+    double keysMs = elapsedMs(start);
+
+    start = chrono::steady_clock::now();
+    vector<pair<TrieNode<char> *, string> > pendingKeys(1, make_pair(trie, string()));
+    while (!pendingKeys.empty()) {
+        TrieNode<char> *node = pendingKeys.back().first;
+        string key = pendingKeys.back().second;
+        pendingKeys.pop_back();
+        if (node->isEndOfKey()) {
+            stackedKeys += !key.empty();
+        }
+        for (int i = node->getNumChildren(); i-- > 0;) {
+            pendingKeys.push_back(make_pair(node->getChildAtIndex(i), key + node->getChildAtIndex(i)->getValue()));
+        }
+    }
+    double copiedKeysMs = elapsedMs(start);
+
+    cout << "traversal: " << iteratedNodes << " nodes (" << stackedNodes << " by stack), " << iteratedKeys << " keys ("
+         << stackedKeys << " by stack, " << keyEnds << " key ends)" << endl;
+    cout << "  pre-order iterator " << setw(9) << iteratorMs << " ms, explicit stack " << setw(9) << stackMs
+         << " ms" << endl;
+    cout << "  key iterator       " << setw(9) << keysMs << " ms, stack of copied keys " << setw(9) << copiedKeysMs
+         << " ms" << endl;
+    delete trie;
+}
+
+/**
+ * Build and probe a word-level TrieNode<string> (one path segment per node) through the
+ * per-child API - operator<<, operator[], hasChild and getValue - counting heap
+ * allocations. Segments are long enough that every string copy allocates.
+ */
+void benchStringTrie()
+{
+    srand(50);
+    vector<vector<string> > paths(100000);
+    for (size_t i = 0; i < paths.size(); i++) {
+        for (int depth = 0; depth < 4; depth++) {
+            stringstream segment;
+            segment << "segment-" << depth << "-" << rand() % (depth == 0 ? 20 : 200) << "-of-the-path";
+            paths[i].push_back(segment.str());
+        }
+    }
+
+    TrieNode<string> *trie = new TrieNode<string>();
+    uint64_t allocationsBefore = numAllocations.load();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < paths.size(); i++) {
+        TrieNode<string> *node = trie;
+        for (size_t j = 0; j < paths[i].size(); j++) {
+            *node << paths[i][j];
+            node = (*node)[paths[i][j]];
+        }
+        node->setEndOfKey(true);
+    }
+    double buildMs = elapsedMs(start);
+    uint64_t buildAllocations = numAllocations.load() - allocationsBefore;
+
+    uint64_t found = 0, length = 0;
+    allocationsBefore = numAllocations.load();
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < paths.size(); i++) {
+        TrieNode<string> *node = trie;
+        for (size_t j = 0; j < paths[i].size() && node->hasChild(paths[i][j]); j++) {
+            node = (*node)[paths[i][j]];
+            length += node->getValue().size();
+        }
+        found += node->isEndOfKey();
+    }
+    double lookupMs = elapsedMs(start);
+    uint64_t lookupAllocations = numAllocations.load() - allocationsBefore;
+
+    cout << "string trie: " << trie->size() << " nodes, " << found << " paths found (" << length << " chars)" << endl;
+    cout << "  build  " << setw(9) << buildMs << " ms, " << setw(9) << buildAllocations << " allocations" << endl;
+    cout << "  lookup " << setw(9) << lookupMs << " ms, " << setw(9) << lookupAllocations << " allocations" << endl;
+    delete trie;
+}
+
+/**
+ * Dump a large Trie the way displayTrie used to (a stringstream and a flushed line per
+ * node), and through TrieExporter in all three formats, to /dev/null.
+ */
+void benchExport()
+{
+    TrieNode<char> *trie = buildShard(49, 300000);
+    ofstream sink("/dev/null");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (TrieNode<char> &node : *trie) {
+        if (node.hasChildren()) {
+            sink << displayNode(node) << endl << endl;
+        }
+    }
+    double perNodeMs = elapsedMs(start);
+
+    double exportMs[3];
+    const char *NAMES[3] = { "pretty", "DOT", "JSON" };
+    TrieExporter<char> exporter(sink);
+    for (int format = 0; format < 3; format++) {
+        start = chrono::steady_clock::now();
+        exporter.write(*trie, (TrieExportFormat) format);
+        exportMs[format] = elapsedMs(start);
+    }
+
+    cout << "export: " << trie->size() << " nodes" << endl;
+    cout << "  per-node stringstreams " << setw(9) << perNodeMs << " ms" << endl;
+    for (int format = 0; format < 3; format++) {
+        cout << "  exporter, " << setw(6) << NAMES[format] << "       " << setw(9) << exportMs[format] << " ms"
+             << endl;
+    }
+    delete trie;
+}
+
+/**
+ * Freeze a dictionary-like Trie (random stems, each with a few of a fixed set of
+ * endings, as in inflected words) and minimize it into a DAWG.
+ */
+void benchMinimize()
+{
+    const int NUM_STEMS = 50000;
+    const char *endings[] = { "", "s", "ed", "ing", "er", "ers", "ly", "ness" };
+    srand(44);
+    TrieNode<char> *root = new TrieNode<char>();
+    for (int i = 0; i < NUM_STEMS; i++) {
+        string stem;
+        for (int length = 3 + rand() % 6; length > 0; length--) {
+            stem += char('a' + rand() % 26);
+        }
+        for (int e = 0; e < 8; e++) {
+            if (e == 0 || rand() % 2 == 0) {
+                root->insert(stem + endings[e]);
+            }
+        }
+    }
+    FrozenTrie<char> *frozen = root->freeze();
+    uint64_t numNodes = frozen->size(), bytes = frozen->memoryUsage();
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    frozen->minimize();
+    double ms = elapsedMs(start);
+    cout << "minimize: " << root->getNumKeys() << " keys, " << numNodes << " -> " << frozen->size()
+         << " nodes, " << bytes / 1024 << " -> " << frozen->memoryUsage() / 1024 << " KiB, "
+         << ms << " ms" << endl;
+
+    delete frozen;
+    delete root;
+}
+
+/**
+ * Read/write mix (90% lookups, 10% inserts) on 1 to 8 threads, against a TrieNode
+ * behind one global mutex.
+ */
+void benchConcurrentMix()
+{
+    const int OPS_PER_THREAD = 200000;
+    srand(43);
+    vector<string> keys;
+    for (int i = 0; i < 100000; i++) {
+        stringstream key;
+        key << "/s" << rand() % 16 << "/p" << rand() % 1000 << "/i" << rand() % 100;
+        keys.push_back(key.str());
+    }
+    cout << "read/write mix: 90% lookups, 10% inserts, " << OPS_PER_THREAD << " ops per thread" << endl;
+
+    for (unsigned threads = 1; threads <= 8; threads *= 2) {
+        TrieNode<char> *locked = new TrieNode<char>();
+        ConcurrentTrieNode<char> *concurrent = new ConcurrentTrieNode<char>();
+        for (size_t i = 0; i < keys.size(); i += 2) {
+            locked->insert(keys[i]);
+            concurrent->insert(keys[i]);
+        }
+        mutex globalLock;
+        atomic<uint64_t> found(0);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.push_back(thread([&, t]() {
+                uint64_t hits = 0;
+                for (int i = 0; i < OPS_PER_THREAD; i++) {
+                    const string &key = keys[(i * 7919 + t * 104729) % keys.size()];
+                    lock_guard<mutex> guard(globalLock);
+                    if (i % 10 == 0) {
+                        locked->insert(key);
+                    }
+                    else if (locked->find(key) != NULL) {
+                        hits++;
+                    }
+                }
+                found += hits;
+            }));
+        }
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].join();
+        }
+        double lockedMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        workers.clear();
+        for (unsigned t = 0; t < threads; t++) {
+            workers.push_back(thread([&, t]() {
+                uint64_t hits = 0;
+                for (int i = 0; i < OPS_PER_THREAD; i++) {
+                    const string &key = keys[(i * 7919 + t * 104729) % keys.size()];
+                    if (i % 10 == 0) {
+                        concurrent->insert(key);
+                    }
+                    else if (concurrent->contains(key)) {
+                        hits++;
+                    }
+                }
+                found += hits;
+            }));
+        }
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].join();
+        }
+        double concurrentMs = elapsedMs(start);
+
+        double totalOps = (double) threads * OPS_PER_THREAD;
+        cout << "  " << threads << " thread(s)  global mutex " << setw(7) << totalOps / lockedMs / 1000
+             << " Mops/s, ConcurrentTrieNode " << setw(7) << totalOps / concurrentMs / 1000 << " Mops/s" << endl;
+        delete locked;
+        delete concurrent;
+    }
+}
+
+/**
+ * Fill one node with many children, one at a time, on one thread. A
+ * ConcurrentTrieNode appends to its child array in place until it is full (see
+ * src/concurrent/childArray.h).
+ */
+void benchConcurrentWideNode()
+{
+    cout << "wide node fill, one thread:" << endl;
+    for (int numChildren = 1000; numChildren <= 64000; numChildren *= 4) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        TrieNode<int> *plain = new TrieNode<int>();
+        for (int i = 0; i < numChildren; i++) {
+            *plain << i;
+        }
+        double plainMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        ConcurrentTrieNode<int> *concurrent = new ConcurrentTrieNode<int>();
+        for (int i = 0; i < numChildren; i++) {
+            *concurrent << i;
+        }
+        double concurrentMs = elapsedMs(start);
+
+        cout << "  " << setw(5) << numChildren << " children  TrieNode " << setw(8) << plainMs
+             << " ms, ConcurrentTrieNode " << setw(8) << concurrentMs << " ms" << endl;
+        delete plain;
+        delete concurrent;
+    }
+}
+
+/**
+ * Usage: bench.out [--suite] [--csv FILE]
+ *      --suite     only run the suite, not the feature benchmarks after it
+ *      --csv FILE  also write the suite's results to FILE, as CSV
+ */
+int main(int argc, char **argv)
+{
+    bool suiteOnly = false;
+    string csvPath;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--suite") {
+            suiteOnly = true;
+        }
+        else if (string(argv[i]) == "--csv" && i + 1 < argc) {
+            csvPath = argv[++i];
+        }
+    }
+
+    cout << "hardware threads: " << thread::hardware_concurrency() << endl;
+    benchSuite(csvPath);
+    if (suiteOnly) {
+        return 0;
+    }
+    benchParallelMerge();
+    benchBulkLoad();
+    benchMinimize();
+    benchStructuralHash();
+    benchTopK();
+    benchFuzzyFind();
+    benchTraversal();
+    benchStringTrie();
+    benchExport();
+    benchConcurrentMix();
+    benchConcurrentWideNode();
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * C++ Trie Framework
+ * Sairam Krishnan
+ **/
+
+#ifndef CONCURRENT_TRIE_NODE_H
+#define CONCURRENT_TRIE_NODE_H
+
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+#include "src/concurrent/childArray.h"
+#include "src/epoch.h"
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Thread-safe variant of TrieNode. Readers never take locks or wait for writers;
+ *      writers lock only the node whose children they change, so writes to different
+ *      parts of the Trie proceed in parallel.
+ *
+ * DETAILS:
+ *      A node's children live in an append-only ChildArray (see
+ *      src/concurrent/childArray.h). To add a child, a writer locks the node and
+ *      appends it in place, which readers searching the array at the same time see
+ *      either before or after; only a full array is replaced, by one twice as large,
+ *      published with a single atomic store. Removing a child with ">>" builds a new
+ *      array without it, so it costs O(fanout). Replaced arrays, and subtrees removed
+ *      with ">>", are retired to the process's EpochDomain and only freed once no
+ *      reader can still be looking at them.
+ *
+ *      Every operation enters an EpochDomain::Guard by itself. Node pointers returned by
+ *      an operation, however, stay valid only as long as the caller holds a Guard of
+ *      its own (ConcurrentTrieNode::ReadGuard) - another thread may remove the node.
+ *      Key removal (remove()) only unmarks the key; ">>" unlinks a whole subtree, and
+ *      a concurrent insert below that subtree is lost along with it. Destroying the
+ *      Trie itself must not overlap with any other operation on it.
+ *      There are no parent pointers, since removed nodes may still be in use.
+ */
+template<class T> class ConcurrentTrieNode
+{
+private:
+    typedef ConcurrentChildArray<ConcurrentTrieNode, T> ChildArray;
+
+    // instance variables
+    const T value;
+    std::atomic<ChildArray *> children;     // NULL while there are no children
+    std::atomic<bool> endOfKey;
+    std::mutex writeLock;                   // held while children are being added or replaced
+
+    // helper methods
+    ConcurrentTrieNode *findChild(const T &value);
+    ConcurrentTrieNode *findOrAddChild(const T &value);
+    void publish(ChildArray *oldChildren, ChildArray *newChildren);
+    void appendChild(ConcurrentTrieNode *child);
+    template<class Iter> ConcurrentTrieNode *descend(Iter &first, Iter last);
+
+    friend class ConcurrentChildArray<ConcurrentTrieNode, T>;
+
+    // No copying - nodes are shared between threads.
+    ConcurrentTrieNode(const ConcurrentTrieNode &);
+    ConcurrentTrieNode &operator=(const ConcurrentTrieNode &);
+
+public:
+    typedef EpochDomain::Guard ReadGuard;
+
+    // Constructors
+    ConcurrentTrieNode();
+    ConcurrentTrieNode(const T &val);
+
+    // Accessors
+    const T &getValue();
+    bool isEndOfKey();
+    void setEndOfKey(bool endOfKey);
+
+    // Size (walks the Trie; a snapshot only if no writer is active)
+    int getNumChildren();
+    bool hasChildren();
+    uint64_t size();
+
+    // Indexing
+    ConcurrentTrieNode *getChildAtIndex(int index);
+    ConcurrentTrieNode *operator[](const T &value);
+    bool hasChild(const T &value);
+
+    // Insertions
+    bool addChild(ConcurrentTrieNode *child);
+    ConcurrentTrieNode &operator<<(const T &value);
+
+    // Path operations (whole keys, relative to this ConcurrentTrieNode)
+    template<class Key> ConcurrentTrieNode *insert(const Key &key);
+    template<class Key> ConcurrentTrieNode *find(const Key &key);
+    template<class Key> bool contains(const Key &key);
+    template<class Key> bool isPrefix(const Key &key);
+    template<class Key> bool remove(const Key &key);
+    template<class Visitor> void forEachKey(Visitor visit);
+
+    // Deletions
+    bool operator>>(const T &value);
+
+    // Destructor
+    ~ConcurrentTrieNode();
+};
+
+/* Implementation */
+#include "src/concurrent/init.h"
+#include "src/concurrent/retrieve.h"
+#include "src/concurrent/insert.h"
+#include "src/concurrent/delete.h"
+#include "src/concurrent/cleanup.h"
+
+#endif // CONCURRENT_TRIE_NODE_H
@@ -0,0 +1,131 @@
+/**
+ * C++ Trie Framework
+ * Sairam Krishnan
+ **/
+
+#ifndef RADIX_TRIE_NODE_H
+#define RADIX_TRIE_NODE_H
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <iterator>
+#include <stdint.h>
+
+#include "src/childIndex.h"
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Path-compressed (radix/Patricia) variant of TrieNode. A run of single-child
+ *      TrieNodes is stored as one RadixTrieNode whose edge label holds all of their
+ *      values, so a lookup follows one pointer per branch instead of one per value.
+ *
+ * DETAILS:
+ *      A key is spelled by the labels of the nodes *below* a RadixTrieNode, as with
+ *      TrieNode's path operations; the root has an empty label. Except for the root,
+ *      every node either ends a key or has at least two children - insert splits a
+ *      label where a new key branches off, and ">>" folds a node back into its only
+ *      child once it no longer needs to exist on its own. Eg., after inserting "romane"
+ *      and "romulus", then "rom":
+ *            (root)
+ *          ==========
+ *             rom      -> isEndOfKey() == true
+ *          ==========
+ *           ane ulus
+ *      Children are found by the first value of their label, through the same
+ *      ChildIndex that TrieNode uses.
+ */
+template<class T> class RadixTrieNode
+{
+private:
+    // instance variables
+    T value;                    // first value of label (what ChildIndex looks children up by)
+    std::vector<T> label;       // values on the edge from the parent down to this node
+    RadixTrieNode *parent;
+    std::vector<RadixTrieNode *> children;
+    ChildIndex<T, RadixTrieNode> childIndex;
+    bool endOfKey;
+
+    // helper methods
+    template<class Iter> void setLabel(Iter first, Iter last);
+    void attachChild(RadixTrieNode *child);
+    void detachChild(RadixTrieNode *child);
+    void takeChildren(RadixTrieNode &from);
+    RadixTrieNode *findChild(const T &value);
+    template<class Iter> RadixTrieNode *descend(Iter &first, Iter last, size_t &matched);
+    void split(size_t length);
+    void absorbChild();
+    RadixTrieNode *copySubtree(size_t labelOffset);
+    bool equals(RadixTrieNode &other);
+    void merge(RadixTrieNode &other);
+
+    friend class ChildIndex<T, RadixTrieNode>;
+    template<class Node, class Children, bool COUNTING> friend class ByteChildIndex;
+
+    // No copying - use clone().
+    RadixTrieNode(const RadixTrieNode &);
+    RadixTrieNode &operator=(const RadixTrieNode &);
+
+public:
+    // Constructors
+    RadixTrieNode();
+    template<class Iter> RadixTrieNode(Iter first, Iter last);
+
+    // Accessors
+    RadixTrieNode *getParent();
+    const std::vector<T> &getLabel();
+    bool isEndOfKey();
+
+    // Size
+    int getNumChildren();
+    bool hasChildren();
+    bool hasParent();
+    uint64_t size();
+    uint64_t getNumKeys();
+
+    // Indexing
+    RadixTrieNode *getChildAtIndex(int index);
+    RadixTrieNode *operator[](const T &first);
+
+    // Cloning (deep-copy)
+    RadixTrieNode *clone();
+
+    // Path operations (whole keys, relative to this RadixTrieNode)
+    template<class Iter> RadixTrieNode *insert(Iter first, Iter last);
+    template<class Key> RadixTrieNode *insert(const Key &key);
+    template<class Key> RadixTrieNode *find(const Key &key);
+    template<class Key> bool isPrefix(const Key &key);
+
+    // Deletions
+    template<class Key> bool operator>>(const Key &key);
+
+    // Comparisons
+    bool operator==(RadixTrieNode &other);
+    bool operator!=(RadixTrieNode &other);
+
+    // Merging Tries
+    void operator+=(RadixTrieNode &other);
+
+    // Display methods
+    template<class NodeType> friend inline std::string displayNode(RadixTrieNode<NodeType> &rn);
+    template<class NodeType> friend inline void displayTrie(std::ostream &output, RadixTrieNode<NodeType> &rn);
+    template<class NodeType> friend inline std::ostream &operator<<(std::ostream &output, RadixTrieNode<NodeType> &rn);
+
+    // Destructor
+    void clear();
+    ~RadixTrieNode();
+};
+
+/* Implementation */
+#include "src/radix/init.h"
+#include "src/radix/size.h"
+#include "src/radix/retrieve.h"
+#include "src/radix/clone.h"
+#include "src/radix/insert.h"
+#include "src/radix/delete.h"
+#include "src/radix/compare.h"
+#include "src/radix/merge.h"
+#include "src/radix/display.h"
+#include "src/radix/cleanup.h"
+
+#endif // RADIX_TRIE_NODE_H
@@ -0,0 +1,148 @@
+#ifndef SRC_ALLOCATE_H
+#define SRC_ALLOCATE_H
+
+/**
+ * Allocate a TrieNode from the global heap. With Traits::USE_ARENAS, it goes through
+ * the allocator policy and is preceded by a small header (see src/arena.h); without
+ * it, it comes straight from ::operator new, with no header.
+ */
+template<class T, class Traits> void *TrieNode<T, Traits>::operator new(size_t size)
+{
+    if (!Traits::USE_ARENAS) {
+        return ::operator new(size);
+    }
+    return Arena::allocateNode(NULL);
+}
+
+/**
+ * Allocate a TrieNode from the given arena, or from the global heap if arena is NULL
+ * (as it always is without Traits::USE_ARENAS).
+ * Eg., new (arena) TrieNode<char>('a');
+ */
+template<class T, class Traits> void *TrieNode<T, Traits>::operator new(size_t size, Arena *arena)
+{
+    if (!Traits::USE_ARENAS) {
+        return ::operator new(size);
+    }
+    return Arena::allocateNode(arena);
+}
+
+/**
+ * Return a TrieNode's memory to the arena it was carved from (where it will be
+ * reused by the next allocation) or to the global heap.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::operator delete(void *ptr)
+{
+    if (!Traits::USE_ARENAS) {
+        ::operator delete(ptr);
+        return;
+    }
+    Arena::releaseNode(ptr);
+}
+
+/**
+ * Only called if a constructor throws during "new (arena) TrieNode".
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::operator delete(void *ptr, Arena *)
+{
+    TrieNode<T, Traits>::operator delete(ptr);
+}
+
+/**
+ * Helper method - create a new node with the given value, to become a child of this
+ * TrieNode. The node comes from the same arena as this TrieNode's children. An rvalue
+ * value is moved into the node rather than copied.
+ */
+template<class T, class Traits> template<class V> TrieNode<T, Traits> *TrieNode<T, Traits>::createNode(V &&value)
+{
+    TrieNode<T, Traits> *node = new (this->arenaLink()) TrieNode<T, Traits>(std::forward<V>(value));
+    node->linkArena(this->arenaLink());
+    return node;
+}
+
+/**
+ * Make this TrieNode the owner of an arena that all of its future descendants will be
+ * carved from, nodesPerBlock nodes at a time. Meant to be called on an empty root;
+ * return false (and do nothing) if this TrieNode already has children or an arena.
+ *
+ * Nodes carved from the arena live no longer than this TrieNode: when it is destroyed,
+ * so are they, including any that were removed with ">>" but not deleted yet. They are
+ * released block by block rather than by walking the Trie. Without Traits::USE_ARENAS,
+ * there is nowhere to keep the arena, and this always returns false.
+ */
+template<class T, class Traits> bool TrieNode<T, Traits>::useArena(size_t nodesPerBlock)
+{
+    if (!Traits::USE_ARENAS || this->arenaLink() != NULL || hasChildren()) {
+        return false;
+    }
+    this->linkArena(new Arena(this, nodesPerBlock));
+    return true;
+}
+
+/**
+ * Return the arena this TrieNode's children are carved from, or NULL if they come
+ * from the global heap.
+ */
+template<class T, class Traits> typename TrieNode<T, Traits>::Arena *TrieNode<T, Traits>::getArena()
+{
+    return this->arenaLink();
+}
+
+/**
+ * Helper method - if this TrieNode owns an arena, destroy every node carved from it
+ * and free its blocks. Nodes that came from elsewhere (eg. attached with "<<" after
+ * a plain "new") are left in place for clear() to delete.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::releaseArena()
+{
+    Arena *ownArena = this->arenaLink();
+    if (ownArena == NULL || ownArena->getRoot() != this) {
+        return;
+    }
+    std::vector<TrieNode<T, Traits> *> foreign;
+
+    // First pass: detach every arena node from its children, setting aside the ones
+    // that do not belong to the arena. No node is reached through the Trie itself.
+    struct Detach
+    {
+        Arena *arena;
+        std::vector<TrieNode<T, Traits> *> *foreign;
+        void operator()(TrieNode<T, Traits> *node)
+        {
+            for (int i = 0; i < node->getNumChildren(); i++) {
+                if (!arena->owns(node->children[i])) {
+                    foreign->push_back(node->children[i]);
+                }
+            }
+            node->children.clear();
+            node->childIndex.cleared();
+        }
+    } detach = { ownArena, &foreign };
+    ownArena->forEachNode(detach);
+
+    // This TrieNode keeps its foreign children; only the arena ones are dropped.
+    Children kept;
+    for (int i = 0; i < getNumChildren(); i++) {
+        if (!ownArena->owns(children[i])) {
+            kept.push_back(children[i]);
+        }
+    }
+    children.swap(kept);
+    childIndex.rebuild(children);
+    recount();
+
+    // Second pass: every arena node is now a leaf, so destroying it is trivial.
+    struct Destroy
+    {
+        void operator()(TrieNode<T, Traits> *node) { node->~TrieNode(); }
+    } destroy;
+    ownArena->forEachNode(destroy);
+
+    this->linkArena(NULL);
+    delete ownArena;
+    for (size_t i = 0; i < foreign.size(); i++) {
+        delete foreign[i];
+    }
+}
+
+#endif // SRC_ALLOCATE_H
@@ -0,0 +1,277 @@
+#ifndef SRC_ARENA_H
+#define SRC_ARENA_H
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define TRIE_NOINLINE __attribute__((noinline))
+#else
+#define TRIE_NOINLINE
+#endif
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Slab allocator for TrieNodes. Nodes are carved out of large contiguous blocks,
+ *      freed nodes go onto a free list to be handed out again, and dropping the arena
+ *      releases whole blocks at once.
+ *
+ * DETAILS:
+ *      Every TrieNode allocated through TrieNode's operator new - whether it came from
+ *      an arena or from the global heap - is preceded by a small header that records
+ *      the arena owning it (NULL for the heap). That is what lets a plain "delete node"
+ *      route the memory back to the right place. In a block, a slot whose header has
+ *      no owner is on the free list. TrieNodes without Traits::USE_ARENAS never come
+ *      through here, and have no header.
+ *
+ *      Headers are only read for nodes that TrieNode's operator new handed out. To
+ *      tell its own nodes from ones attached from elsewhere (which may have no
+ *      header at all), an arena checks the address against its blocks instead (see
+ *      owns()); they are kept sorted by address for that.
+ *
+ *          block: | header | node | header | node | header | (free) | ...
+ */
+template<class Node> class NodeArena
+{
+private:
+    struct Header
+    {
+        NodeArena *owner;
+    };
+
+    // Header size, rounded up so that the node behind it stays properly aligned.
+    static const size_t HEADER_SIZE = (alignof(Node) > sizeof(Header)) ? alignof(Node) : sizeof(Header);
+    static const size_t SLOT_SIZE = HEADER_SIZE +
+        (sizeof(Node) + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+
+    Node *root;
+    size_t nodesPerBlock;
+    std::vector<char *> blocks; // sorted by address
+    char *newest;           // the block that next and end point into
+    char *next;             // first never-used slot of the newest block
+    char *end;              // end of the newest block
+    Header *freeList;       // freed slots; the link is kept where the node used to be
+    size_t liveNodes;
+    bool shared;            // if true, allocations may come from several threads at once
+    std::mutex lock;
+
+    static Header *headerOf(void *node)
+    {
+        return reinterpret_cast<Header *>(static_cast<char *>(node) - HEADER_SIZE);
+    }
+
+    static void *nodeOf(Header *header)
+    {
+        return reinterpret_cast<char *>(header) + HEADER_SIZE;
+    }
+
+    static Header *&nextFree(Header *header)
+    {
+        return *static_cast<Header **>(nodeOf(header));
+    }
+
+    /**
+     * Kept out of line: once inlined into TrieNode's operator new, GCC sees memory from
+     * ::operator new reach TrieNode's operator delete and warns about a mismatched
+     * pair (-Wmismatched-new-delete), although the two do match.
+     */
+    TRIE_NOINLINE static void *allocateOnHeap()
+    {
+        Header *header = static_cast<Header *>(::operator new(HEADER_SIZE + sizeof(Node)));
+        header->owner = NULL;
+        return nodeOf(header);
+    }
+
+    // No copying - the arena owns its blocks.
+    NodeArena(const NodeArena &);
+    NodeArena &operator=(const NodeArena &);
+
+public:
+    NodeArena(Node *root, size_t nodesPerBlock)
+        : root(root), nodesPerBlock(nodesPerBlock > 0 ? nodesPerBlock : 1), newest(NULL), next(NULL),
+          end(NULL), freeList(NULL), liveNodes(0), shared(false) {}
+
+    ~NodeArena()
+    {
+        for (size_t i = 0; i < blocks.size(); i++) {
+            ::operator delete(blocks[i]);
+        }
+    }
+
+    /**
+     * Return the node that owns this arena.
+     */
+    Node *getRoot()
+    {
+        return root;
+    }
+
+    /**
+     * Hand this arena over to another node (eg. when its root is moved from).
+     */
+    void setRoot(Node *root)
+    {
+        this->root = root;
+    }
+
+    /**
+     * Return the number of nodes currently carved out of this arena.
+     */
+    size_t getNumNodes()
+    {
+        return liveNodes;
+    }
+
+    /**
+     * Allow (or stop allowing) nodes to be allocated and released from several threads
+     * at once. While shared, every allocation takes a lock.
+     */
+    void setShared(bool shared)
+    {
+        this->shared = shared;
+    }
+
+    /**
+     * Return memory for one node, preferring recycled slots over fresh ones.
+     */
+    void *allocate()
+    {
+        if (shared) {
+            std::lock_guard<std::mutex> guard(lock);
+            return allocateUnlocked();
+        }
+        return allocateUnlocked();
+    }
+
+    /**
+     * Put the slot of an already destroyed node back on the free list.
+     */
+    void release(void *node)
+    {
+        if (shared) {
+            std::lock_guard<std::mutex> guard(lock);
+            releaseUnlocked(node);
+            return;
+        }
+        releaseUnlocked(node);
+    }
+
+private:
+    void *allocateUnlocked()
+    {
+        Header *header = freeList;
+        if (header != NULL) {
+            freeList = nextFree(header);
+        }
+        else {
+            if (next == end) {
+                newest = static_cast<char *>(::operator new(SLOT_SIZE * nodesPerBlock));
+                next = newest;
+                end = newest + SLOT_SIZE * nodesPerBlock;
+                blocks.insert(std::upper_bound(blocks.begin(), blocks.end(), newest, std::less<char *>()), newest);
+            }
+            header = reinterpret_cast<Header *>(next);
+            next += SLOT_SIZE;
+        }
+        header->owner = this;
+        liveNodes++;
+        return nodeOf(header);
+    }
+
+    void releaseUnlocked(void *node)
+    {
+        Header *header = headerOf(node);
+        header->owner = NULL;
+        nextFree(header) = freeList;
+        freeList = header;
+        liveNodes--;
+    }
+
+public:
+    /**
+     * Call visit(node) on every node currently carved out of this arena, walking the
+     * blocks front to back rather than following the Trie's pointers.
+     */
+    template<class Visitor> void forEachNode(Visitor visit)
+    {
+        for (size_t i = 0; i < blocks.size(); i++) {
+            char *blockEnd = (blocks[i] == newest) ? next : blocks[i] + SLOT_SIZE * nodesPerBlock;
+            for (char *slot = blocks[i]; slot < blockEnd; slot += SLOT_SIZE) {
+                Header *header = reinterpret_cast<Header *>(slot);
+                if (header->owner == this) {
+                    visit(static_cast<Node *>(nodeOf(header)));
+                }
+            }
+        }
+    }
+
+    /**
+     * Return true if the given node was carved from this arena. Safe to call on any
+     * node, wherever it came from: only its address is looked at.
+     */
+    bool owns(const void *node) const
+    {
+        char *address = static_cast<char *>(const_cast<void *>(node));
+        std::vector<char *>::const_iterator it =
+            std::upper_bound(blocks.begin(), blocks.end(), address, std::less<char *>());
+        if (it == blocks.begin()) {
+            return false;
+        }
+        --it;
+        char *blockEnd = (*it == newest) ? next : *it + SLOT_SIZE * nodesPerBlock;
+        return std::less<char *>()(address, blockEnd);
+    }
+
+    /**
+     * Return the arena that the given node was carved from, or NULL if it came from
+     * the global heap. Only valid for nodes allocated through TrieNode's operator new.
+     */
+    static NodeArena *ownerOf(const void *node)
+    {
+        return headerOf(const_cast<void *>(node))->owner;
+    }
+
+    /**
+     * Return the memory a node takes up: one slot of the given arena, or its header
+     * and the node itself on the global heap if arena is NULL.
+     */
+    static size_t bytesPerNode(const NodeArena *arena)
+    {
+        return (arena != NULL) ? SLOT_SIZE : HEADER_SIZE + sizeof(Node);
+    }
+
+    /**
+     * Allocate memory for a node from the given arena, or from the global heap if
+     * arena is NULL.
+     */
+    static void *allocateNode(NodeArena *arena)
+    {
+        if (arena != NULL) {
+            return arena->allocate();
+        }
+        return allocateOnHeap();
+    }
+
+    /**
+     * Give the memory of a destroyed node back to wherever it came from.
+     */
+    static void releaseNode(void *node)
+    {
+        if (node == NULL) {
+            return;
+        }
+        NodeArena *owner = ownerOf(node);
+        if (owner != NULL) {
+            owner->release(node);
+        }
+        else {
+            ::operator delete(headerOf(node));
+        }
+    }
+};
+
+#endif // SRC_ARENA_H
@@ -0,0 +1,95 @@
+#ifndef SRC_BULK_LOAD_H
+#define SRC_BULK_LOAD_H
+
+/**
+ * Build this Trie from the keys in [firstKey, lastKey), which must be sorted (by "<"
+ * on T, value by value, shorter keys before longer keys they are a prefix of). Any
+ * input iterator over containers of T will do; each key is read once. Duplicates are
+ * allowed. The result is == to inserting the keys one at a time, in order.
+ *
+ * Since the input is sorted, the new key's place is always on the path of the previous
+ * one: the shared prefix is skipped, the nodes below it are finished (they will not
+ * get any more children), and the rest of the key is appended - no child is ever
+ * looked up. Children wait in per-depth buffers until their parent is finished, and
+ * are then copied into a vector of exactly the right size. New nodes come from this
+ * TrieNode's arena, if it has one (see useArena()).
+ *
+ * Meant to be called on a node without children; return false (and do nothing) if
+ * this TrieNode has children. Also return false if a key is out of order - the keys
+ * before it are kept, the rest are not inserted.
+ */
+template<class T, class Traits> template<class Iter> bool TrieNode<T, Traits>::insertSorted(Iter firstKey, Iter lastKey)
+{
+    if (hasChildren()) {
+        return false;
+    }
+    uint64_t oldKeys = this->countedKeys();
+
+    // path[d] is the node at depth d of the previous key; pendingChildren[d] holds its
+    // children so far. Buffers are reused from one key to the next.
+    std::vector<TrieNode<T, Traits> *> path(1, this);
+    std::vector<std::vector<TrieNode<T, Traits> *> > pendingChildren(1);
+
+    // Give node at depth d its children, exactly sized, now that they are all known.
+    auto finish = [&path, &pendingChildren](size_t d) {
+        TrieNode<T, Traits> *node = path[d];
+        node->children.assign(pendingChildren[d].begin(), pendingChildren[d].end());
+        pendingChildren[d].clear();
+        node->childIndex.rebuild(node->children);
+        node->recount();
+    };
+
+    bool sorted = true;
+    for (; firstKey != lastKey; ++firstKey) {
+        const auto &key = *firstKey;
+        auto value = std::begin(key), end = std::end(key);
+
+        // Skip the prefix shared with the previous key.
+        size_t depth = 0;
+        while (value != end && depth + 1 < path.size() && path[depth + 1]->value == *value) {
+            ++value;
+            depth++;
+        }
+        // The previous key goes on below the shared prefix; this one must come after it.
+        if (depth + 1 < path.size() && (value == end || *value < path[depth + 1]->value)) {
+            sorted = false;
+            break;
+        }
+        for (size_t d = path.size() - 1; d > depth; d--) {
+            finish(d);
+        }
+        path.resize(depth + 1);
+
+        for (; value != end; ++value) {
+            TrieNode<T, Traits> *node = path.back();
+            TrieNode<T, Traits> *child = node->createNode(*value);
+            child->linkParent(node);
+            pendingChildren[path.size() - 1].push_back(child);
+            path.push_back(child);
+            if (pendingChildren.size() < path.size()) {
+                pendingChildren.resize(path.size());
+            }
+        }
+        path.back()->endOfKey = true;
+    }
+
+    for (size_t d = path.size(); d-- > 0;) {
+        finish(d);
+    }
+    TrieNode<T, Traits> *parent = this->parentLink();
+    if (parent != NULL) {
+        parent->adjustCounts((int64_t) this->countedNodes() - 1, (int64_t) this->countedKeys() - (int64_t) oldKeys);
+        parent->raiseMaxWeight(this->bestWeight());
+    }
+    return sorted;
+}
+
+/**
+ * Build this Trie from a sorted container of keys (eg. a std::vector<std::string>).
+ */
+template<class T, class Traits> template<class Keys> bool TrieNode<T, Traits>::insertSorted(const Keys &keys)
+{
+    return insertSorted(std::begin(keys), std::end(keys));
+}
+
+#endif // SRC_BULK_LOAD_H
@@ -0,0 +1,468 @@
+#ifndef SRC_BYTE_CHILD_INDEX_H
+#define SRC_BYTE_CHILD_INDEX_H
+
+#include <cstring>
+#include <vector>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "byteChildList.h"
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Child index for byte-sized values (TrieNode<char> and friends), laid out like
+ *      the inner nodes of an adaptive radix tree. As in the generic ChildIndex, it
+ *      maps a value to a position in the node's children vector.
+ *
+ * DETAILS:
+ *      NODE4   - up to 4 keys, stored inline in the index itself (no allocation), in
+ *                the 8 bytes that hold the pointer to the layout in the others.
+ *      NODE16  - up to 16 keys, compared all at once with SSE2 where available.
+ *      NODE48  - a 256-entry key -> slot table in front of 48 slots.
+ *      NODE256 - a 256-entry key -> position table.
+ *      The index grows when a layout is full and shrinks once it is down to a
+ *      quarter of the next smaller layout's headroom, so alternating inserts and
+ *      removals at a boundary don't reallocate every time. A node never has more
+ *      than 256 children here, so positions fit in a byte below NODE256.
+ *
+ *      This index sits next to a separate list of children (a std::vector, as in
+ *      RadixTrieNode and PersistentTrie), at 16 bytes plus the NODE16/48/256 block of
+ *      the wider nodes. TrieNode keeps its children in a ByteChildList instead, which
+ *      indexes them itself (see the specialization at the end of this file).
+ */
+template<class Node, class Children = std::vector<Node *>, bool COUNTING = false> class ByteChildIndex
+{
+private:
+    enum Kind { NODE4, NODE16, NODE48, NODE256 };
+    static const uint16_t EMPTY = 0xFFFF;
+
+    struct Node4
+    {
+        uint8_t keys[4];
+        uint8_t positions[4];
+    };
+    struct Node16
+    {
+        uint8_t keys[16];
+        uint8_t positions[16];
+    };
+    struct Node48
+    {
+        uint8_t slotOf[256];    // 0 = no child, otherwise slot + 1
+        uint8_t keys[48];
+        uint8_t positions[48];
+    };
+    struct Node256
+    {
+        uint16_t positions[256];    // EMPTY = no child
+    };
+
+    union Storage
+    {
+        Node4 node4;        // NODE4
+        void *layout;       // the others
+    } storage;
+    uint8_t kind;
+    uint16_t count;
+
+    static uint8_t keyOf(const Node *child)
+    {
+        return static_cast<uint8_t>(child->value);
+    }
+
+    static int capacity(int kind)
+    {
+        static const int CAPACITY[] = { 4, 16, 48, 256 };
+        return CAPACITY[kind];
+    }
+
+    // Number of keys at or below which a layout shrinks to the next smaller one.
+    static int shrinkAt(int kind)
+    {
+        static const int SHRINK_AT[] = { -1, 3, 12, 40 };
+        return SHRINK_AT[kind];
+    }
+
+    void releaseLayout()
+    {
+        switch (kind) {
+            case NODE16:  delete static_cast<Node16 *>(storage.layout);  break;
+            case NODE48:  delete static_cast<Node48 *>(storage.layout);  break;
+            case NODE256: delete static_cast<Node256 *>(storage.layout); break;
+        }
+        storage.layout = NULL;
+        kind = NODE4;
+        count = 0;
+    }
+
+    /**
+     * Copy every (key, position) pair into the given arrays and return how many there are.
+     */
+    int collect(uint8_t *keys, uint16_t *positions) const
+    {
+        int n = 0;
+        switch (kind) {
+            case NODE4:
+                for (; n < count; n++) {
+                    keys[n] = storage.node4.keys[n];
+                    positions[n] = storage.node4.positions[n];
+                }
+                break;
+            case NODE16: {
+                const Node16 *n16 = static_cast<const Node16 *>(storage.layout);
+                for (; n < count; n++) {
+                    keys[n] = n16->keys[n];
+                    positions[n] = n16->positions[n];
+                }
+                break;
+            }
+            case NODE48: {
+                const Node48 *n48 = static_cast<const Node48 *>(storage.layout);
+                for (; n < count; n++) {
+                    keys[n] = n48->keys[n];
+                    positions[n] = n48->positions[n];
+                }
+                break;
+            }
+            case NODE256: {
+                const Node256 *n256 = static_cast<const Node256 *>(storage.layout);
+                for (int key = 0; key < 256; key++) {
+                    if (n256->positions[key] != EMPTY) {
+                        keys[n] = key;
+                        positions[n++] = n256->positions[key];
+                    }
+                }
+                break;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * Switch to the given layout, carrying all keys over.
+     */
+    void relayout(int newKind)
+    {
+        uint8_t keys[256];
+        uint16_t positions[256];
+        int n = collect(keys, positions);
+
+        releaseLayout();
+        kind = newKind;
+        switch (kind) {
+            case NODE16:
+                storage.layout = new Node16();
+                break;
+            case NODE48: {
+                Node48 *n48 = new Node48();
+                std::memset(n48->slotOf, 0, sizeof(n48->slotOf));
+                storage.layout = n48;
+                break;
+            }
+            case NODE256: {
+                Node256 *n256 = new Node256();
+                for (int key = 0; key < 256; key++) {
+                    n256->positions[key] = EMPTY;
+                }
+                storage.layout = n256;
+                break;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            insertKey(keys[i], positions[i]);
+        }
+    }
+
+    void insertKey(uint8_t key, int position)
+    {
+        if (count == capacity(kind)) {
+            relayout(kind + 1);
+        }
+        switch (kind) {
+            case NODE4:
+                storage.node4.keys[count] = key;
+                storage.node4.positions[count] = position;
+                break;
+            case NODE16: {
+                Node16 *n16 = static_cast<Node16 *>(storage.layout);
+                n16->keys[count] = key;
+                n16->positions[count] = position;
+                break;
+            }
+            case NODE48: {
+                Node48 *n48 = static_cast<Node48 *>(storage.layout);
+                n48->keys[count] = key;
+                n48->positions[count] = position;
+                n48->slotOf[key] = count + 1;
+                break;
+            }
+            case NODE256:
+                static_cast<Node256 *>(storage.layout)->positions[key] = position;
+                break;
+        }
+        count++;
+    }
+
+    void removeKey(uint8_t key)
+    {
+        // Below NODE256, slots are kept dense by moving the last one into the hole.
+        switch (kind) {
+            case NODE4:
+                for (int i = 0; i < count; i++) {
+                    if (storage.node4.keys[i] == key) {
+                        storage.node4.keys[i] = storage.node4.keys[count - 1];
+                        storage.node4.positions[i] = storage.node4.positions[count - 1];
+                        count--;
+                        break;
+                    }
+                }
+                break;
+            case NODE16: {
+                Node16 *n16 = static_cast<Node16 *>(storage.layout);
+                int slot = findSlot16(n16, key);
+                if (slot != -1) {
+                    n16->keys[slot] = n16->keys[count - 1];
+                    n16->positions[slot] = n16->positions[count - 1];
+                    count--;
+                }
+                break;
+            }
+            case NODE48: {
+                Node48 *n48 = static_cast<Node48 *>(storage.layout);
+                int slot = n48->slotOf[key] - 1;
+                if (slot != -1) {
+                    uint8_t lastKey = n48->keys[count - 1];
+                    n48->keys[slot] = lastKey;
+                    n48->positions[slot] = n48->positions[count - 1];
+                    n48->slotOf[lastKey] = slot + 1;
+                    n48->slotOf[key] = 0;
+                    count--;
+                }
+                break;
+            }
+            case NODE256: {
+                Node256 *n256 = static_cast<Node256 *>(storage.layout);
+                if (n256->positions[key] != EMPTY) {
+                    n256->positions[key] = EMPTY;
+                    count--;
+                }
+                break;
+            }
+        }
+        if (count <= shrinkAt(kind)) {
+            relayout(kind - 1);
+        }
+    }
+
+    /**
+     * Positions after an erased child move down by one, like the children themselves.
+     */
+    void shiftAfter(int erasedPosition)
+    {
+        uint8_t *positions = NULL;
+        switch (kind) {
+            case NODE4:  positions = storage.node4.positions; break;
+            case NODE16: positions = static_cast<Node16 *>(storage.layout)->positions; break;
+            case NODE48: positions = static_cast<Node48 *>(storage.layout)->positions; break;
+            case NODE256: {
+                Node256 *n256 = static_cast<Node256 *>(storage.layout);
+                for (int key = 0; key < 256; key++) {
+                    if (n256->positions[key] != EMPTY && n256->positions[key] > erasedPosition) {
+                        n256->positions[key]--;
+                    }
+                }
+                return;
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            if (positions[i] > erasedPosition) {
+                positions[i]--;
+            }
+        }
+    }
+
+    int findSlot16(const Node16 *n16, uint8_t key) const
+    {
+#ifdef __SSE2__
+        __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(n16->keys));
+        __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(key)), keys);
+        int mask = _mm_movemask_epi8(matches) & ((1 << count) - 1);
+        return (mask == 0) ? -1 : __builtin_ctz(mask);
+#else
+        for (int i = 0; i < count; i++) {
+            if (n16->keys[i] == key) {
+                return i;
+            }
+        }
+        return -1;
+#endif
+    }
+
+public:
+    ByteChildIndex() : kind(NODE4), count(0)
+    {
+        storage.layout = NULL;
+    }
+
+    ByteChildIndex(const ByteChildIndex &other) : kind(NODE4), count(0)
+    {
+        storage.layout = NULL;
+        *this = other;
+    }
+
+    ByteChildIndex &operator=(const ByteChildIndex &other)
+    {
+        if (this != &other) {
+            uint8_t keys[256];
+            uint16_t positions[256];
+            int n = other.collect(keys, positions);
+            releaseLayout();
+            for (int i = 0; i < n; i++) {
+                insertKey(keys[i], positions[i]);
+            }
+        }
+        return *this;
+    }
+
+    ~ByteChildIndex()
+    {
+        releaseLayout();
+    }
+
+    void swap(ByteChildIndex &other)
+    {
+        std::swap(storage, other.storage);
+        std::swap(kind, other.kind);
+        std::swap(count, other.count);
+    }
+
+    /**
+     * Return the position of the child with the given value, or -1 if there is none.
+     */
+    template<class T> int find(const Children &, const T &value) const
+    {
+        uint8_t key = static_cast<uint8_t>(value);
+        switch (kind) {
+            case NODE4:
+                for (int i = 0; i < count; i++) {
+                    if (storage.node4.keys[i] == key) {
+                        TRIE_COUNT(COUNTING, childScans, i + 1);
+                        return storage.node4.positions[i];
+                    }
+                }
+                TRIE_COUNT(COUNTING, childScans, count);
+                return -1;
+            case NODE16: {
+                const Node16 *n16 = static_cast<const Node16 *>(storage.layout);
+                int slot = findSlot16(n16, key);
+                return (slot == -1) ? -1 : n16->positions[slot];
+            }
+            case NODE48: {
+                const Node48 *n48 = static_cast<const Node48 *>(storage.layout);
+                int slot = n48->slotOf[key];
+                return (slot == 0) ? -1 : n48->positions[slot - 1];
+            }
+            default: {
+                uint16_t position = static_cast<const Node256 *>(storage.layout)->positions[key];
+                return (position == EMPTY) ? -1 : position;
+            }
+        }
+    }
+
+    /**
+     * Return the number of bytes this index allocated (see TrieStats).
+     */
+    size_t heapBytes() const
+    {
+        switch (kind) {
+            case NODE16:  return sizeof(Node16);
+            case NODE48:  return sizeof(Node48);
+            case NODE256: return sizeof(Node256);
+            default:      return 0;
+        }
+    }
+
+    /**
+     * See ChildIndex for when each of the following must be called.
+     */
+    void rebuild(const Children &children)
+    {
+        releaseLayout();
+        for (int i = 0; i < (int) children.size(); i++) {
+            added(children, i);
+        }
+    }
+
+    void pushed(const Children &children)
+    {
+        added(children, children.size() - 1);
+    }
+
+    template<class T> void erased(const Children &, int pos, const T &value)
+    {
+        removeKey(static_cast<uint8_t>(value));
+        shiftAfter(pos);
+    }
+
+    void removing(const Children &children, int pos)
+    {
+        if (children[pos] != NULL) {
+            removeKey(keyOf(children[pos]));
+        }
+    }
+
+    void added(const Children &children, int pos)
+    {
+        if (children[pos] != NULL) {
+            insertKey(keyOf(children[pos]), pos);
+        }
+    }
+
+    void cleared()
+    {
+        releaseLayout();
+    }
+};
+
+/**
+ * Children kept in a ByteChildList (the default for TrieNode<char> and friends, see
+ * src/trieNodeTraits.h) carry their own keys: the index has nothing to store, and
+ * only passes lookups and changes on to them.
+ */
+template<class Node, bool COUNTING> class ByteChildIndex<Node, ByteChildList<Node>, COUNTING>
+{
+public:
+    template<class T> int find(const ByteChildList<Node> &children, const T &value) const
+    {
+        int position = children.find(static_cast<uint8_t>(value));
+        if (children.scans()) {
+            TRIE_COUNT(COUNTING, childScans, (position == -1) ? children.size() : position + 1);
+        }
+        return position;
+    }
+
+    size_t heapBytes() const { return 0; }
+
+    void rebuild(ByteChildList<Node> &children) { children.reindexAll(); }
+    void pushed(ByteChildList<Node> &) {}
+    template<class T> void erased(ByteChildList<Node> &, int, const T &) {}
+    void removing(ByteChildList<Node> &, int) {}
+    void added(ByteChildList<Node> &children, int pos) { children.reindex(pos); }
+    void cleared() {}
+    void swap(ByteChildIndex &) {}
+};
+
+/**
+ * TrieNode<char>, TrieNode<unsigned char> and TrieNode<signed char> use the layout above.
+ */
+template<class Node, class Children, bool COUNTING> class ChildIndex<char, Node, Children, COUNTING> :
+    public ByteChildIndex<Node, Children, COUNTING> {};
+template<class Node, class Children, bool COUNTING> class ChildIndex<unsigned char, Node, Children, COUNTING> :
+    public ByteChildIndex<Node, Children, COUNTING> {};
+template<class Node, class Children, bool COUNTING> class ChildIndex<signed char, Node, Children, COUNTING> :
+    public ByteChildIndex<Node, Children, COUNTING> {};
+
+#endif // SRC_BYTE_CHILD_INDEX_H
@@ -0,0 +1,374 @@
+#ifndef SRC_BYTE_CHILD_LIST_H
+#define SRC_BYTE_CHILD_LIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "childList.h"
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      The children of a TrieNode with byte-sized values (char, signed char and
+ *      unsigned char) together with their index: one 16-byte object, where other
+ *      TrieNodes keep a ChildList and a ChildIndex next to it. Children stay in
+ *      insertion order, so getChildAtIndex keeps its meaning, and are looked up by
+ *      the key bytes stored next to them rather than through their own values.
+ *
+ * DETAILS:
+ *      Like ChildList, a single child is kept inline (and looked up by its value).
+ *      Past that, one heap block of capacity c holds
+ *          | c child pointers | c keys, padded to 16 bytes | key -> position table |
+ *      and the children are found by
+ *          up to SCAN_MAX children   - comparing the keys one by one
+ *          up to LINEAR_MAX children - comparing all of the keys at once (SSE2)
+ *          beyond                    - the table (256 16-bit positions), which only
+ *                                      blocks of more than LINEAR_MAX children have
+ *      A key is taken from a child when it is added. If a child is replaced through
+ *      operator[], or its value changes in place, it must be reindexed (see
+ *      reindex()). NULL children are allowed, and never found.
+ */
+template<class Node> class ByteChildList
+{
+public:
+    typedef Node *value_type;
+    typedef Node **iterator;
+    typedef Node *const *const_iterator;
+
+    static const uint32_t INLINE_SIZE = 1;
+    static const uint32_t SCAN_MAX = 4;
+    static const uint32_t LINEAR_MAX = 16;
+
+    ByteChildList() : count(0), capacityUsed(INLINE_SIZE)
+    {
+        items.inline_[0] = NULL;
+    }
+
+    ByteChildList(const ByteChildList &other) : count(0), capacityUsed(INLINE_SIZE)
+    {
+        items.inline_[0] = NULL;
+        assign(other.begin(), other.end());
+    }
+
+    ByteChildList(ByteChildList &&other) noexcept : count(0), capacityUsed(INLINE_SIZE)
+    {
+        items.inline_[0] = NULL;
+        swap(other);
+    }
+
+    ByteChildList &operator=(const ByteChildList &other)
+    {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    ByteChildList &operator=(ByteChildList &&other) noexcept
+    {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~ByteChildList()
+    {
+        release();
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return capacityUsed; }
+    bool empty() const { return count == 0; }
+    bool isInline() const { return capacityUsed == INLINE_SIZE; }
+
+    Node *&operator[](size_t i) { return data()[i]; }
+    Node *operator[](size_t i) const { return data()[i]; }
+    Node *&back() { return data()[count - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + count; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + count; }
+
+    void push_back(Node *child)
+    {
+        if (count == capacityUsed) {
+            reserve(2 * (size_t) capacityUsed);
+        }
+        data()[count] = child;
+        index(count);
+        count++;
+    }
+
+    iterator erase(iterator pos)
+    {
+        size_t erased = pos - begin();
+        if (!isInline()) {
+            unindex(erased);
+            std::copy(keys() + erased + 1, keys() + count, keys() + erased);
+        }
+        std::copy(pos + 1, end(), pos);
+        count--;
+        fillTable(erased);
+        return pos;
+    }
+
+    /**
+     * Make room for n children without reallocating. Never shrinks. Keys are carried
+     * over as they are, not taken from the children again.
+     */
+    void reserve(size_t n)
+    {
+        if (n <= capacityUsed) {
+            return;
+        }
+        char *block = new char[blockSize(n)];
+        Node **newChildren = reinterpret_cast<Node **>(block);
+        uint8_t *newKeys = reinterpret_cast<uint8_t *>(block + n * sizeof(Node *));
+        std::copy(begin(), end(), newChildren);
+        std::memset(newKeys, 0, keyBytes(n));
+        if (isInline()) {
+            if (count == 1 && items.inline_[0] != NULL) {
+                newKeys[0] = keyOf(items.inline_[0]);
+            }
+        }
+        else {
+            std::copy(keys(), keys() + count, newKeys);
+        }
+        release();
+        items.heap = block;
+        capacityUsed = n;
+        if (hasTable()) {
+            std::fill(table(), table() + 256, (uint16_t) EMPTY);
+            fillTable(0);
+        }
+    }
+
+    /**
+     * Replace the children with [first, last), in a block of exactly the right size.
+     */
+    template<class Iter> void assign(Iter first, Iter last)
+    {
+        size_t n = std::distance(first, last);
+        clear();
+        reserve(n);
+        std::copy(first, last, data());
+        count = n;
+        reindexAll();
+    }
+
+    /**
+     * Remove every child and give the block back: an empty list is inline again.
+     */
+    void clear()
+    {
+        release();
+        count = 0;
+        capacityUsed = INLINE_SIZE;
+    }
+
+    void swap(ByteChildList &other)
+    {
+        std::swap(items, other.items);
+        std::swap(count, other.count);
+        std::swap(capacityUsed, other.capacityUsed);
+    }
+
+    /**
+     * Return the position of the child with the given key, or -1 if there is none.
+     */
+    int find(uint8_t key) const
+    {
+        if (isInline()) {
+            return (count == 1 && items.inline_[0] != NULL && keyOf(items.inline_[0]) == key) ? 0 : -1;
+        }
+        if (hasTable()) {
+            uint16_t position = table()[key];
+            return (position == EMPTY) ? -1 : position;
+        }
+        const uint8_t *k = keys();
+        if (count <= SCAN_MAX) {
+            for (uint32_t i = 0; i < count; i++) {
+                if (k[i] == key && data()[i] != NULL) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+#ifdef __SSE2__
+        __m128i all = _mm_loadu_si128(reinterpret_cast<const __m128i *>(k));
+        __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(key)), all);
+        uint32_t mask = _mm_movemask_epi8(matches) & ((1u << count) - 1);
+        for (; mask != 0; mask &= mask - 1) {
+            int i = __builtin_ctz(mask);
+            if (data()[i] != NULL) {
+                return i;
+            }
+        }
+#else
+        for (uint32_t i = 0; i < count; i++) {
+            if (k[i] == key && data()[i] != NULL) {
+                return i;
+            }
+        }
+#endif
+        return -1;
+    }
+
+    /**
+     * Return true if find() compares keys one at a time (for TrieCounters::childScans).
+     */
+    bool scans() const
+    {
+        return !hasTable() && count <= SCAN_MAX;
+    }
+
+    /**
+     * Take the key of the child at position pos from it again, after it was replaced
+     * or its value changed.
+     */
+    void reindex(size_t pos)
+    {
+        if (isInline()) {
+            return;
+        }
+        unindex(pos);
+        index(pos);
+    }
+
+    /**
+     * Take every key from the children again.
+     */
+    void reindexAll()
+    {
+        if (isInline()) {
+            return;
+        }
+        if (hasTable()) {
+            std::fill(table(), table() + 256, (uint16_t) EMPTY);
+        }
+        for (size_t i = 0; i < count; i++) {
+            index(i);
+        }
+    }
+
+    /**
+     * Return the number of bytes the keys and the table take up (see TrieStats).
+     */
+    size_t indexBytes() const
+    {
+        return isInline() ? 0 : blockSize(capacityUsed) - capacityUsed * sizeof(Node *);
+    }
+
+private:
+    static const uint16_t EMPTY = 0xFFFF;
+
+    union Items
+    {
+        Node *inline_[INLINE_SIZE];
+        char *heap;
+    } items;
+    uint32_t count;
+    uint32_t capacityUsed;
+
+    static uint8_t keyOf(const Node *child)
+    {
+        return static_cast<uint8_t>(child->value);
+    }
+
+    static size_t keyBytes(size_t capacity)
+    {
+        return (capacity + 15) / 16 * 16;
+    }
+
+    static size_t blockSize(size_t capacity)
+    {
+        size_t size = capacity * sizeof(Node *) + keyBytes(capacity);
+        return (capacity > LINEAR_MAX) ? size + 256 * sizeof(uint16_t) : size;
+    }
+
+    bool hasTable() const { return capacityUsed > LINEAR_MAX; }
+
+    Node **data() { return isInline() ? items.inline_ : reinterpret_cast<Node **>(items.heap); }
+    Node *const *data() const { return isInline() ? items.inline_ : reinterpret_cast<Node *const *>(items.heap); }
+
+    uint8_t *keys() { return reinterpret_cast<uint8_t *>(items.heap + capacityUsed * sizeof(Node *)); }
+    const uint8_t *keys() const
+    {
+        return reinterpret_cast<const uint8_t *>(items.heap + capacityUsed * sizeof(Node *));
+    }
+
+    uint16_t *table()
+    {
+        return reinterpret_cast<uint16_t *>(items.heap + capacityUsed * sizeof(Node *) + keyBytes(capacityUsed));
+    }
+    const uint16_t *table() const
+    {
+        return reinterpret_cast<const uint16_t *>(items.heap + capacityUsed * sizeof(Node *) +
+            keyBytes(capacityUsed));
+    }
+
+    // Record the key of the child at pos (if there is one), in the keys and the table.
+    void index(size_t pos)
+    {
+        Node *child = data()[pos];
+        if (isInline() || child == NULL) {
+            return;
+        }
+        keys()[pos] = keyOf(child);
+        if (hasTable()) {
+            table()[keys()[pos]] = pos;
+        }
+    }
+
+    // Point the table at the children from position first on, by their stored keys.
+    void fillTable(size_t first)
+    {
+        if (!hasTable()) {
+            return;
+        }
+        for (size_t i = first; i < count; i++) {
+            if (data()[i] != NULL) {
+                table()[keys()[i]] = i;
+            }
+        }
+    }
+
+    // Drop the table entry of the child at pos, if it still points there.
+    void unindex(size_t pos)
+    {
+        if (hasTable() && table()[keys()[pos]] == pos) {
+            table()[keys()[pos]] = EMPTY;
+        }
+    }
+
+    void release()
+    {
+        if (!isInline()) {
+            delete[] items.heap;
+            capacityUsed = INLINE_SIZE;
+        }
+    }
+};
+
+/**
+ * See heapCapacityOf and indexBytesOf in src/childList.h.
+ */
+template<class Node> size_t heapCapacityOf(const ByteChildList<Node> &children)
+{
+    return children.isInline() ? 0 : children.capacity();
+}
+template<class Node> size_t indexBytesOf(const ByteChildList<Node> &children)
+{
+    return children.indexBytes();
+}
+
+#endif // SRC_BYTE_CHILD_LIST_H
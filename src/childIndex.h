@@ -0,0 +1,374 @@
+#ifndef SRC_CHILD_INDEX_H
+#define SRC_CHILD_INDEX_H
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "trieStats.h"
+
+/**
+ * Compile-time checks for what a child value type supports. The sorted tier below
+ * needs "<" and the hashed tier needs std::hash; types without them simply stay in
+ * the tiers they can use.
+ */
+template<class T, class = void> struct IsOrderedValue : std::false_type {};
+template<class T> struct IsOrderedValue<T,
+    decltype((void)(std::declval<const T &>() < std::declval<const T &>()))> : std::true_type {};
+
+template<class T, class = void> struct IsHashableValue : std::false_type {};
+template<class T> struct IsHashableValue<T,
+    decltype((void)(std::hash<T>()(std::declval<const T &>())))> : std::true_type {};
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Lookup structure over a TrieNode's children. The children themselves stay in
+ *      the node's vector, in insertion order, so getChildAtIndex/setChildAtIndex keep
+ *      their meaning; ChildIndex only maps a value to its position in that vector
+ *      (a std::vector by default; TrieNode keeps a ChildList, see src/childList.h).
+ *
+ * DETAILS:
+ *      The index changes form with the number of children:
+ *          LINEAR - up to LINEAR_MAX children: nothing is stored, the vector is scanned.
+ *          SORTED - up to SORTED_MAX children: positions sorted by value, binary search.
+ *          HASHED - beyond that: value -> position hash table.
+ *      Each tier shrinks back once the number of children drops to half of the
+ *      threshold that made it grow, so alternating inserts/removals don't thrash.
+ *      If COUNTING, the children compared in the linear tier are added to
+ *      TrieCounters::childScans.
+ */
+template<class T, class Node, class Children = std::vector<Node *>, bool COUNTING = false> class ChildIndex
+{
+private:
+    enum Tier { LINEAR, SORTED, HASHED };
+    static const int LINEAR_MAX = 8;
+    static const int SORTED_MAX = 64;
+
+    static const bool ORDERED = IsOrderedValue<T>::value;
+    static const bool HASHABLE = IsHashableValue<T>::value;
+
+    struct NoHashTable {};
+    typedef typename std::conditional<HASHABLE,
+        std::unordered_map<T, int>, NoHashTable>::type HashTable;
+
+    Tier tier;
+    std::vector<int> *sorted;
+    HashTable *hashed;
+
+    // Orderings of positions by the value of the child stored there. They are kept
+    // apart since T may itself be int.
+    struct PositionLess
+    {
+        const Children &children;
+        PositionLess(const Children &c) : children(c) {}
+        bool operator()(int a, int b) const { return children[a]->value < children[b]->value; }
+    };
+    struct PositionBefore
+    {
+        const Children &children;
+        PositionBefore(const Children &c) : children(c) {}
+        bool operator()(int pos, const T &value) const { return children[pos]->value < value; }
+    };
+    struct PositionAfter
+    {
+        const Children &children;
+        PositionAfter(const Children &c) : children(c) {}
+        bool operator()(const T &value, int pos) const { return value < children[pos]->value; }
+    };
+
+    Tier tierFor(int numChildren)
+    {
+        if (numChildren > SORTED_MAX && HASHABLE) {
+            return HASHED;
+        }
+        if (numChildren > LINEAR_MAX && ORDERED) {
+            return SORTED;
+        }
+        return LINEAR;
+    }
+
+    // Return true if the index should change form now that there are numChildren.
+    bool shouldRetier(int numChildren)
+    {
+        Tier wanted = tierFor(numChildren);
+        if (wanted > tier) {
+            return true;
+        }
+        if (wanted < tier) {
+            int threshold = (tier == HASHED) ? SORTED_MAX : LINEAR_MAX;
+            return numChildren <= threshold / 2;
+        }
+        return false;
+    }
+
+    void release()
+    {
+        delete sorted;
+        delete hashed;
+        sorted = NULL;
+        hashed = NULL;
+        tier = LINEAR;
+    }
+
+    int linearFind(const Children &children, const T &value) const
+    {
+        for (int i = 0; i < (int) children.size(); i++) {
+            if (children[i] != NULL && children[i]->value == value) {
+                TRIE_COUNT(COUNTING, childScans, i + 1);
+                return i;
+            }
+        }
+        TRIE_COUNT(COUNTING, childScans, children.size());
+        return -1;
+    }
+
+    /**
+     * Only ordered types ever reach the sorted tier (and only hashable ones the hashed
+     * tier); the std::false_type overloads keep "<" and std::hash from being
+     * instantiated for the others.
+     */
+    int sortedFind(const Children &children, const T &value, std::true_type) const
+    {
+        std::vector<int>::const_iterator it =
+            std::lower_bound(sorted->begin(), sorted->end(), value, PositionBefore(children));
+        if (it == sorted->end() || !(children[*it]->value == value)) {
+            return -1;
+        }
+        return *it;
+    }
+    int sortedFind(const Children &, const T &, std::false_type) const { return -1; }
+
+    void sortedAdd(const Children &children, int pos, std::true_type)
+    {
+        std::vector<int>::iterator it = std::upper_bound(sorted->begin(), sorted->end(),
+            children[pos]->value, PositionAfter(children));
+        sorted->insert(it, pos);
+    }
+    void sortedAdd(const Children &, int, std::false_type) {}
+
+    void sortedCreate(const Children &children, std::true_type)
+    {
+        sorted = new std::vector<int>();
+        sorted->reserve(children.size());
+        for (int i = 0; i < (int) children.size(); i++) {
+            if (children[i] != NULL) {
+                sorted->push_back(i);
+            }
+        }
+        std::sort(sorted->begin(), sorted->end(), PositionLess(children));
+    }
+    void sortedCreate(const Children &, std::false_type) {}
+
+    void sortedRemove(int pos)
+    {
+        sorted->erase(std::find(sorted->begin(), sorted->end(), pos));
+    }
+
+    int hashedFind(const T &value, std::true_type) const
+    {
+        typename HashTable::const_iterator it = hashed->find(value);
+        return (it == hashed->end()) ? -1 : it->second;
+    }
+    int hashedFind(const T &, std::false_type) const { return -1; }
+
+    void hashedAdd(const Children &children, int pos, std::true_type)
+    {
+        hashed->insert(std::make_pair(children[pos]->value, pos));
+    }
+    void hashedAdd(const Children &, int, std::false_type) {}
+
+    void hashedRemove(const T &value, std::true_type) { hashed->erase(value); }
+    void hashedRemove(const T &, std::false_type) {}
+
+    void hashedShift(int erasedPos, std::true_type)
+    {
+        for (typename HashTable::iterator it = hashed->begin(); it != hashed->end(); ++it) {
+            if (it->second > erasedPos) {
+                it->second--;
+            }
+        }
+    }
+    void hashedShift(int, std::false_type) {}
+
+    void hashedCreate(std::true_type) { hashed = new HashTable(); }
+    void hashedCreate(std::false_type) {}
+
+    // Buckets, plus one allocation per element: the pair, the link and the cached hash.
+    size_t hashedBytes(std::true_type) const
+    {
+        return sizeof(HashTable) + hashed->bucket_count() * sizeof(void *) +
+            hashed->size() * (sizeof(typename HashTable::value_type) + 2 * sizeof(void *));
+    }
+    size_t hashedBytes(std::false_type) const { return 0; }
+
+    void add(const Children &children, int pos)
+    {
+        if (children[pos] == NULL) {
+            return;
+        }
+        if (tier == SORTED) {
+            sortedAdd(children, pos, std::integral_constant<bool, ORDERED>());
+        }
+        else if (tier == HASHED) {
+            hashedAdd(children, pos, std::integral_constant<bool, HASHABLE>());
+        }
+    }
+
+public:
+    ChildIndex() : tier(LINEAR), sorted(NULL), hashed(NULL) {}
+
+    ChildIndex(const ChildIndex &other) : tier(other.tier), sorted(NULL), hashed(NULL)
+    {
+        if (other.sorted != NULL) {
+            sorted = new std::vector<int>(*other.sorted);
+        }
+        if (other.hashed != NULL) {
+            hashed = new HashTable(*other.hashed);
+        }
+    }
+
+    ChildIndex &operator=(const ChildIndex &other)
+    {
+        if (this != &other) {
+            ChildIndex copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    /**
+     * Exchange contents with other, along with the children the two index (see
+     * TrieNode::adoptChildren). Never allocates.
+     */
+    void swap(ChildIndex &other)
+    {
+        std::swap(tier, other.tier);
+        std::swap(sorted, other.sorted);
+        std::swap(hashed, other.hashed);
+    }
+
+    ~ChildIndex()
+    {
+        release();
+    }
+
+    /**
+     * Return the position of the child with the given value, or -1 if there is none.
+     */
+    int find(const Children &children, const T &value) const
+    {
+        switch (tier) {
+            case SORTED:
+                return sortedFind(children, value, std::integral_constant<bool, ORDERED>());
+            case HASHED:
+                return hashedFind(value, std::integral_constant<bool, HASHABLE>());
+            default:
+                return linearFind(children, value);
+        }
+    }
+
+    /**
+     * Return the number of bytes this index allocated (see TrieStats).
+     */
+    size_t heapBytes() const
+    {
+        size_t bytes = 0;
+        if (sorted != NULL) {
+            bytes += sizeof(std::vector<int>) + sorted->capacity() * sizeof(int);
+        }
+        if (hashed != NULL) {
+            bytes += hashedBytes(std::integral_constant<bool, HASHABLE>());
+        }
+        return bytes;
+    }
+
+    /**
+     * Rebuild the index from scratch for the current contents of children.
+     */
+    void rebuild(const Children &children)
+    {
+        release();
+        tier = tierFor(children.size());
+        if (tier == SORTED) {
+            sortedCreate(children, std::integral_constant<bool, ORDERED>());
+        }
+        else if (tier == HASHED) {
+            hashedCreate(std::integral_constant<bool, HASHABLE>());
+            for (int i = 0; i < (int) children.size(); i++) {
+                add(children, i);
+            }
+        }
+    }
+
+    /**
+     * Must be called after a child was appended to children.
+     */
+    void pushed(const Children &children)
+    {
+        if (shouldRetier(children.size())) {
+            rebuild(children);
+            return;
+        }
+        add(children, children.size() - 1);
+    }
+
+    /**
+     * Must be called after the child with the given value was erased from position pos.
+     */
+    void erased(const Children &children, int pos, const T &value)
+    {
+        if (shouldRetier(children.size())) {
+            rebuild(children);
+            return;
+        }
+        if (tier == SORTED) {
+            sortedRemove(pos);
+            for (int i = 0; i < (int) sorted->size(); i++) {
+                if ((*sorted)[i] > pos) {
+                    (*sorted)[i]--;
+                }
+            }
+        }
+        else if (tier == HASHED) {
+            hashedRemove(value, std::integral_constant<bool, HASHABLE>());
+            hashedShift(pos, std::integral_constant<bool, HASHABLE>());
+        }
+    }
+
+    /**
+     * Must be called before the child at position pos is replaced. Call added()
+     * once the replacement is in place.
+     */
+    void removing(const Children &children, int pos)
+    {
+        if (children[pos] == NULL) {
+            return;
+        }
+        if (tier == SORTED) {
+            sortedRemove(pos);
+        }
+        else if (tier == HASHED) {
+            hashedRemove(children[pos]->value, std::integral_constant<bool, HASHABLE>());
+        }
+    }
+
+    void added(const Children &children, int pos)
+    {
+        add(children, pos);
+    }
+
+    /**
+     * Must be called after children was emptied.
+     */
+    void cleared()
+    {
+        release();
+    }
+};
+
+#include "byteChildIndex.h"
+
+#endif // SRC_CHILD_INDEX_H
@@ -0,0 +1,187 @@
+#ifndef SRC_CHILD_LIST_H
+#define SRC_CHILD_LIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdint.h>
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      The children of a TrieNode: a vector of pointers that keeps up to INLINE_SIZE of
+ *      them in place of the pointer to its buffer. Most TrieNodes are leaves or have a
+ *      single child, and those never allocate anything; the others grow a buffer on
+ *      the heap like std::vector.
+ *
+ * DETAILS:
+ *      16 bytes (a std::vector is 24, plus its buffer): the inline child or the buffer
+ *      pointer, and 32-bit size and capacity. A capacity of INLINE_SIZE means the
+ *      children are inline. Only what TrieNode needs of std::vector is provided;
+ *      iterators are plain pointers, invalidated by anything that changes the size.
+ */
+template<class Node> class ChildList
+{
+public:
+    typedef Node *value_type;
+    typedef Node **iterator;
+    typedef Node *const *const_iterator;
+
+    static const uint32_t INLINE_SIZE = 1;
+
+    ChildList() : count(0), capacityUsed(INLINE_SIZE)
+    {
+        items.inline_[0] = NULL;
+    }
+
+    ChildList(const ChildList &other) : count(0), capacityUsed(INLINE_SIZE)
+    {
+        items.inline_[0] = NULL;
+        assign(other.begin(), other.end());
+    }
+
+    ChildList(ChildList &&other) noexcept : count(0), capacityUsed(INLINE_SIZE)
+    {
+        items.inline_[0] = NULL;
+        swap(other);
+    }
+
+    ChildList &operator=(const ChildList &other)
+    {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    ChildList &operator=(ChildList &&other) noexcept
+    {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~ChildList()
+    {
+        release();
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return capacityUsed; }
+    bool empty() const { return count == 0; }
+    bool isInline() const { return capacityUsed == INLINE_SIZE; }
+
+    Node *&operator[](size_t i) { return data()[i]; }
+    Node *operator[](size_t i) const { return data()[i]; }
+    Node *&back() { return data()[count - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + count; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + count; }
+
+    void push_back(Node *child)
+    {
+        if (count == capacityUsed) {
+            reserve(2 * (size_t) capacityUsed);
+        }
+        data()[count++] = child;
+    }
+
+    iterator erase(iterator pos)
+    {
+        std::copy(pos + 1, end(), pos);
+        count--;
+        return pos;
+    }
+
+    /**
+     * Make room for n children without reallocating. Never shrinks.
+     */
+    void reserve(size_t n)
+    {
+        if (n <= capacityUsed) {
+            return;
+        }
+        Node **buffer = new Node *[n];
+        std::copy(begin(), end(), buffer);
+        release();
+        items.heap = buffer;
+        capacityUsed = n;
+    }
+
+    /**
+     * Replace the children with [first, last), in a buffer of exactly the right size.
+     */
+    template<class Iter> void assign(Iter first, Iter last)
+    {
+        size_t n = std::distance(first, last);
+        clear();
+        reserve(n);
+        std::copy(first, last, data());
+        count = n;
+    }
+
+    /**
+     * Remove every child and give the buffer back: an empty list is inline again.
+     */
+    void clear()
+    {
+        release();
+        count = 0;
+        capacityUsed = INLINE_SIZE;
+    }
+
+    void swap(ChildList &other)
+    {
+        std::swap(items, other.items);
+        std::swap(count, other.count);
+        std::swap(capacityUsed, other.capacityUsed);
+    }
+
+private:
+    union Items
+    {
+        Node *inline_[INLINE_SIZE];
+        Node **heap;
+    } items;
+    uint32_t count;
+    uint32_t capacityUsed;
+
+    Node **data() { return isInline() ? items.inline_ : items.heap; }
+    Node *const *data() const { return isInline() ? items.inline_ : items.heap; }
+
+    void release()
+    {
+        if (!isInline()) {
+            delete[] items.heap;
+            capacityUsed = INLINE_SIZE;
+        }
+    }
+};
+
+/**
+ * Return the number of children that the given container has room for on the heap:
+ * its capacity, or none while a ChildList keeps its children inline. Used by
+ * TrieNode::stats().
+ */
+template<class Children> size_t heapCapacityOf(const Children &children)
+{
+    return children.capacity();
+}
+template<class Node> size_t heapCapacityOf(const ChildList<Node> &children)
+{
+    return children.isInline() ? 0 : children.capacity();
+}
+
+/**
+ * Return the number of bytes that the given container spends on indexing its children
+ * (see src/byteChildList.h); plain containers leave that to a ChildIndex.
+ */
+template<class Children> size_t indexBytesOf(const Children &)
+{
+    return 0;
+}
+
+#endif // SRC_CHILD_LIST_H
@@ -3,23 +3,42 @@
 
 /**
  * Remove all children from this Trie - this Trie shall become a leaf.
+ * Descendants are freed with an explicit stack rather than by recursing through their
+ * destructors, so arbitrarily deep Tries can be cleared.
  */
-template<class T> void TrieNode<T>::clear()
+template<class T, class Traits> void TrieNode<T, Traits>::clear()
 {
 	if (!this->hasChildren()) {
 		return;
 	}
-    for (int i = 0; i < children.size(); i++) {
-        delete children[i];
-    }
+    std::vector<TrieNode<T, Traits> *> pending(children.begin(), children.end());
     children.clear();
+    childIndex.cleared();
+    adjustCounts(1 - (int64_t) this->countedNodes(), (endOfKey ? 1 : 0) - (int64_t) this->countedKeys());
+    refreshMaxWeight();
+
+    while (!pending.empty()) {
+        TrieNode<T, Traits> *node = pending.back();
+        pending.pop_back();
+        // A node that owns an arena releases its own descendants.
+        if (node->arenaLink() == NULL || node->arenaLink()->getRoot() != node) {
+            pending.insert(pending.end(), node->children.begin(), node->children.end());
+            node->children.clear();
+            node->childIndex.cleared();
+        }
+        delete node;
+    }
 }
 
 /**
  * Invoked when this TrieNode is being deleted. At that time, free all of the children as well.
  */
-template<class T> TrieNode<T>::~TrieNode()
+template<class T, class Traits> TrieNode<T, Traits>::~TrieNode()
 {
+	// Whatever this TrieNode was attached to is not updated (see operator>> for
+	// detaching a child first).
+	this->linkParent(NULL);
+	releaseArena();
 	clear();
 }
 
@@ -2,19 +2,55 @@
 #define SRC_CLONE_H
 
 /**
- * Create a deep copy of this TrieNode.
+ * Helper method - create a deep copy of this TrieNode whose nodes are all carved
+ * from the given arena (or come from the global heap if arena is NULL).
+ * The copy is built with an explicit stack of (original, copy) pairs; since the
+ * original has no duplicate children, copies are appended without duplicate checks.
  */
-template<class T> TrieNode<T> *TrieNode<T>::clone()
+template<class T, class Traits>
+TrieNode<T, Traits> *TrieNode<T, Traits>::cloneInto(Arena *arena)
 {
-    TrieNode<T> *newNode = new TrieNode<T>(value);
-    if (!hasChildren()) {
-        return newNode;
-    }
+    TrieNode<T, Traits> *newRoot = new (arena) TrieNode<T, Traits>(value);
+    newRoot->linkArena(arena);
+    newRoot->endOfKey = endOfKey;
+    newRoot->setCounts(this->countedNodes(), this->countedKeys());
+    newRoot->cacheHash(this->cachedHash());
+    newRoot->setKeyWeight(this->keyWeight());
+    newRoot->setBestWeight(this->bestWeight());
+
+    std::vector<std::pair<TrieNode<T, Traits> *, TrieNode<T, Traits> *> > pending;
+    pending.push_back(std::make_pair(this, newRoot));
+    while (!pending.empty()) {
+        TrieNode<T, Traits> *original = pending.back().first;
+        TrieNode<T, Traits> *copy = pending.back().second;
+        pending.pop_back();
 
-    for (int i = 0; i < children.size(); i++) {
-        newNode->addChild(children[i]->clone());
+        copy->children.reserve(original->getNumChildren());
+        for (int i = 0; i < original->getNumChildren(); i++) {
+            TrieNode<T, Traits> *child = original->children[i];
+            TrieNode<T, Traits> *childCopy = new (arena) TrieNode<T, Traits>(child->value);
+            childCopy->linkArena(arena);
+            childCopy->endOfKey = child->endOfKey;
+            childCopy->setCounts(child->countedNodes(), child->countedKeys());
+            childCopy->cacheHash(child->cachedHash());
+            childCopy->setKeyWeight(child->keyWeight());
+            childCopy->setBestWeight(child->bestWeight());
+            childCopy->linkParent(copy);
+            copy->children.push_back(childCopy);
+            pending.push_back(std::make_pair(child, childCopy));
+        }
+        copy->childIndex.rebuild(copy->children);
     }
-    return newNode;
+    return newRoot;
+}
+
+/**
+ * Create a deep copy of this TrieNode. The copy is independent of this Trie, so it
+ * is allocated from the global heap even if this Trie uses an arena.
+ */
+template<class T, class Traits> TrieNode<T, Traits> *TrieNode<T, Traits>::clone()
+{
+    return cloneInto(NULL);
 }
 
 
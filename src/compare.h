@@ -2,36 +2,121 @@
 #define SRC_COMPARE_H
 
 /**
- * Helper method - used in "==" and "!=" to determine if this TrieNode
- * has the same value and children as other.
+ * Return a hash of this TrieNode's subtree: its value, whether it ends a key (and
+ * with what weight), and the hashes of its children, in order. Tries that are ==
+ * have equal hashes.
+ *
+ * Hashes are computed on demand and cached in the nodes. Any change to a subtree
+ * drops the cached hash of every node from the change up to the root (which happens
+ * along with the count updates - see adjustCounts), so only the nodes on changed
+ * paths are rehashed next time, in one post-order pass. Without Traits::CACHE_HASHES,
+ * nothing is cached, and every call hashes the whole subtree.
+ * Since this writes to the nodes, it counts as a modification when the same Trie is
+ * shared between threads.
  */
-template<class T> bool TrieNode<T>::equals(TrieNode<T> &other)
+template<class T, class Traits> uint64_t TrieNode<T, Traits>::getHash()
 {
-    // If the values don't match or the nodes have a different number of children, 
-    // then the two nodes aren't equal.
-    if (value != other.value || getNumChildren() != other.getNumChildren()) {
-        return false;
+    if (this->cachedHash() != 0) {
+        return this->cachedHash();
     }
-    // Values match, and the nodes are leaves, so we're done checking.
-    if (!hasChildren() && !other.hasChildren()) {
-        return true;
+    // One entry per node on the path being hashed: the node, its next child to fold
+    // in, and its hash so far. Children with a cached hash are folded in directly.
+    struct Pending
+    {
+        TrieNode<T, Traits> *node;
+        int nextChild;
+        uint64_t hash;
+
+        static Pending start(TrieNode<T, Traits> *node)
+        {
+            uint64_t h = StructuralHash::mix(StructuralHash::SEED, StructuralHash::ofValue(node->value));
+            h = StructuralHash::mix(h, node->endOfKey);
+            if (node->endOfKey) {
+                h = StructuralHash::mix(h, StructuralHash::ofValue(node->keyWeight()));
+            }
+            Pending entry = { node, 0, h };
+            return entry;
+        }
+    };
+    std::vector<Pending> pending(1, Pending::start(this));
+    while (true) {
+        Pending &top = pending.back();
+        if (top.nextChild < top.node->getNumChildren()) {
+            TrieNode<T, Traits> *child = top.node->children[top.nextChild++];
+            if (child->cachedHash() != 0) {
+                top.hash = StructuralHash::mix(top.hash, child->cachedHash());
+            }
+            else {
+                pending.push_back(Pending::start(child));
+            }
+            continue;
+        }
+        // 0 means "not computed".
+        uint64_t h = (top.hash == 0) ? 1 : top.hash;
+        top.node->cacheHash(h);
+        pending.pop_back();
+        if (pending.empty()) {
+            return h;
+        }
+        pending.back().hash = StructuralHash::mix(pending.back().hash, h);
     }
+}
 
-    // Values match + same number of children, so check both nodes' children.
-    for (int i = 0; i < children.size(); i++) {
-        TrieNode<T> *child = children[i];
-        TrieNode<T> *otherChild = other.children[i];
-        if (!child->equals(*otherChild)) {
+/**
+ * Helper method - drop the cached hash of this TrieNode and of its ancestors after a
+ * change that does not go through adjustCounts. A node without a cached hash has no
+ * ancestor with one, so the walk stops at the first such node.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::invalidateHash()
+{
+    for (TrieNode<T, Traits> *node = this; node != NULL && node->cachedHash() != 0; node = node->parentLink()) {
+        node->cacheHash(0);
+    }
+}
+
+/**
+ * Helper method - used in "==" and "!=" to determine if this TrieNode
+ * has the same value and children as other.
+ */
+template<class T, class Traits> bool TrieNode<T, Traits>::equals(TrieNode<T, Traits> &other)
+{
+    // Pairs of nodes (one from each Trie) that still have to be compared.
+    std::vector<std::pair<TrieNode<T, Traits> *, TrieNode<T, Traits> *> > pending;
+    pending.push_back(std::make_pair(this, &other));
+
+    while (!pending.empty()) {
+        TrieNode<T, Traits> *node = pending.back().first;
+        TrieNode<T, Traits> *otherNode = pending.back().second;
+        pending.pop_back();
+
+        if (node == otherNode) {
+            continue;
+        }
+        // If the values don't match, only one of the nodes ends a key (or both do, with
+        // different weights), the nodes have a different number of children, or both
+        // hashes are known and differ, then the two nodes aren't equal.
+        if (node->value != otherNode->value || node->endOfKey != otherNode->endOfKey ||
+            (node->endOfKey && node->keyWeight() != otherNode->keyWeight()) ||
+            node->getNumChildren() != otherNode->getNumChildren() ||
+            (node->cachedHash() != 0 && otherNode->cachedHash() != 0 && node->cachedHash() != otherNode->cachedHash())) {
             return false;
         }
+        // Values match + same number of children, so check both nodes' children.
+        for (int i = 0; i < node->getNumChildren(); i++) {
+            pending.push_back(std::make_pair(node->children[i], otherNode->children[i]));
+        }
     }
     return true;
 }
 
 /**
- * Return true if this TrieNode and other share the same value and children.
+ * Return true if this TrieNode and other share the same value and children (and the
+ * same keys have the same weights).
+ * Hashes are not computed here, since that would take two more walks than the
+ * comparison itself. Where both nodes of a pair already have one cached, though,
+ * different hashes tell them apart without walking their subtrees (see equals).
  */
-template<class T> bool TrieNode<T>::operator==(TrieNode<T> &other)
+template<class T, class Traits> bool TrieNode<T, Traits>::operator==(TrieNode<T, Traits> &other)
 {
     return equals(other);
 }
@@ -39,10 +124,9 @@ template<class T> bool TrieNode<T>::operator==(TrieNode<T> &other)
 /**
  * Return true if this TrieNode does not have the same values/children as other.
  */
-template<class T> bool TrieNode<T>::operator!=(TrieNode<T> &other)
+template<class T, class Traits> bool TrieNode<T, Traits>::operator!=(TrieNode<T, Traits> &other)
 {
-    return !equals(other);
+    return !(*this == other);
 }
 
 #endif // SRC_COMPARE_H
-
@@ -0,0 +1,161 @@
+#ifndef SRC_CONCURRENT_CHILD_ARRAY_H
+#define SRC_CONCURRENT_CHILD_ARRAY_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <stdint.h>
+
+#include "../childIndex.h"
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      The children of a ConcurrentTrieNode: a fixed-capacity, append-only array of
+ *      child pointers with a lookup table over it. Readers search it without locks
+ *      while a writer (holding the node's lock) appends to it; only when it is full
+ *      is it replaced by one twice as large, so adding n children one at a time
+ *      copies O(n) pointers in all.
+ *
+ * DETAILS:
+ *      A writer stores the child first, then its table entry, then the new size, each
+ *      with release semantics; a reader that sees the size (or the table entry) sees
+ *      the child as well. Children are never removed from a published array: removal
+ *      builds a new one (see ConcurrentTrieNode::operator>>).
+ *
+ *      Up to LINEAR_MAX children are scanned. Past that, values with std::hash get an
+ *      open-addressing table of positions, at least twice the capacity so that it is
+ *      never more than half full and a probe always ends at an empty entry. Values
+ *      without std::hash are always scanned.
+ */
+template<class Node, class T> class ConcurrentChildArray
+{
+private:
+    static const size_t LINEAR_MAX = 8;
+    static const int EMPTY = -1;
+
+    size_t capacityUsed;
+    std::atomic<size_t> count;
+    std::atomic<Node *> *slots;
+    std::atomic<int> *table;        // NULL if the children are scanned
+    size_t tableMask;
+
+    static size_t hashOf(const T &value, std::true_type)
+    {
+        // Fibonacci hashing spreads out values that only differ in their high bits.
+        return (size_t) ((uint64_t) std::hash<T>()(value) * 11400714819323198485ULL >> 32);
+    }
+    static size_t hashOf(const T &, std::false_type) { return 0; }
+
+    int scan(const T &value, size_t n) const
+    {
+        for (size_t i = 0; i < n; i++) {
+            if (slots[i].load(std::memory_order_relaxed)->value == value) {
+                return (int) i;
+            }
+        }
+        return -1;
+    }
+
+    int lookUp(const T &value) const
+    {
+        size_t entry = hashOf(value, std::integral_constant<bool, IsHashableValue<T>::value>()) & tableMask;
+        while (true) {
+            int position = table[entry].load(std::memory_order_acquire);
+            if (position == EMPTY || slots[position].load(std::memory_order_relaxed)->value == value) {
+                return position;
+            }
+            entry = (entry + 1) & tableMask;
+        }
+    }
+
+    void addToTable(int position)
+    {
+        const T &value = slots[position].load(std::memory_order_relaxed)->value;
+        size_t entry = hashOf(value, std::integral_constant<bool, IsHashableValue<T>::value>()) & tableMask;
+        while (table[entry].load(std::memory_order_relaxed) != EMPTY) {
+            entry = (entry + 1) & tableMask;
+        }
+        table[entry].store(position, std::memory_order_release);
+    }
+
+    // No copying - see copyOf().
+    ConcurrentChildArray(const ConcurrentChildArray &);
+    ConcurrentChildArray &operator=(const ConcurrentChildArray &);
+
+public:
+    explicit ConcurrentChildArray(size_t capacity)
+        : capacityUsed(capacity > 0 ? capacity : 1), count(0), table(NULL), tableMask(0)
+    {
+        slots = new std::atomic<Node *>[capacityUsed];
+        if (IsHashableValue<T>::value && capacityUsed > LINEAR_MAX) {
+            size_t tableSize = 1;
+            while (tableSize < 2 * capacityUsed) {
+                tableSize *= 2;
+            }
+            table = new std::atomic<int>[tableSize];
+            for (size_t i = 0; i < tableSize; i++) {
+                table[i].store(EMPTY, std::memory_order_relaxed);
+            }
+            tableMask = tableSize - 1;
+        }
+    }
+
+    /**
+     * Free the array itself; the children are not touched.
+     */
+    ~ConcurrentChildArray()
+    {
+        delete[] slots;
+        delete[] table;
+    }
+
+    /**
+     * Return a new array with the given capacity and the children of from, except the
+     * one at position skip (pass from.size() or more to keep them all).
+     */
+    static ConcurrentChildArray *copyOf(const ConcurrentChildArray &from, size_t capacity, size_t skip)
+    {
+        ConcurrentChildArray *copy = new ConcurrentChildArray(capacity);
+        for (size_t i = 0; i < from.size(); i++) {
+            if (i != skip) {
+                copy->append(from[i]);
+            }
+        }
+        return copy;
+    }
+
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    size_t capacity() const { return capacityUsed; }
+    bool full() const { return size() == capacityUsed; }
+
+    /**
+     * Return the child at position i, which must be below size().
+     */
+    Node *operator[](size_t i) const { return slots[i].load(std::memory_order_relaxed); }
+
+    /**
+     * Return the position of the child with the given value, or -1 if there is none.
+     * Safe to call while a writer appends.
+     */
+    int find(const T &value) const
+    {
+        return (table != NULL) ? lookUp(value) : scan(value, size());
+    }
+
+    /**
+     * Add child at the end; the array must not be full. Only one thread may append
+     * at a time.
+     */
+    void append(Node *child)
+    {
+        size_t position = count.load(std::memory_order_relaxed);
+        slots[position].store(child, std::memory_order_release);
+        if (table != NULL) {
+            addToTable((int) position);
+        }
+        count.store(position + 1, std::memory_order_release);
+    }
+};
+
+#endif // SRC_CONCURRENT_CHILD_ARRAY_H
@@ -0,0 +1,28 @@
+#ifndef SRC_CONCURRENT_CLEANUP_H
+#define SRC_CONCURRENT_CLEANUP_H
+
+/**
+ * Invoked when this ConcurrentTrieNode is being deleted (no other thread may be using
+ * it by then). Frees all descendants, with an explicit stack.
+ */
+template<class T> ConcurrentTrieNode<T>::~ConcurrentTrieNode()
+{
+    std::vector<ChildArray *> pending;
+    if (children.load() != NULL) {
+        pending.push_back(children.load());
+    }
+    while (!pending.empty()) {
+        ChildArray *current = pending.back();
+        pending.pop_back();
+        for (size_t i = 0; i < current->size(); i++) {
+            ChildArray *grandchildren = (*current)[i]->children.exchange(NULL);
+            if (grandchildren != NULL) {
+                pending.push_back(grandchildren);
+            }
+            delete (*current)[i];
+        }
+        delete current;
+    }
+}
+
+#endif // SRC_CONCURRENT_CLEANUP_H
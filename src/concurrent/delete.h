@@ -0,0 +1,48 @@
+#ifndef SRC_CONCURRENT_DELETE_H
+#define SRC_CONCURRENT_DELETE_H
+
+/**
+ * Remove the child with the given value, along with its whole subtree. The subtree is
+ * freed once no reader can still be in it. Return false if there was no such child.
+ */
+template<class T> bool ConcurrentTrieNode<T>::operator>>(const T &value)
+{
+    ReadGuard guard;
+    std::lock_guard<std::mutex> lock(writeLock);
+    ChildArray *oldChildren = children.load(std::memory_order_relaxed);
+    if (oldChildren == NULL) {
+        return false;
+    }
+    int index = oldChildren->find(value);
+    if (index == -1) {
+        return false;
+    }
+    ConcurrentTrieNode<T> *removed = (*oldChildren)[index];
+    // Readers may be searching oldChildren, so the rest are copied to a new array
+    // (half as large once it would be no more than a quarter full).
+    size_t remaining = oldChildren->size() - 1, capacity = oldChildren->capacity();
+    if (remaining <= capacity / 4) {
+        capacity /= 2;
+    }
+    publish(oldChildren, (remaining == 0) ? NULL : ChildArray::copyOf(*oldChildren, capacity, index));
+    EpochDomain::instance().retire(removed);
+    return true;
+}
+
+/**
+ * Remove the given key. Its nodes stay in place (as in TrieNode, where only the
+ * end-of-key mark is cleared), so no locking is needed. Return true if the key was
+ * stored.
+ */
+template<class T> template<class Key> bool ConcurrentTrieNode<T>::remove(const Key &key)
+{
+    ReadGuard guard;
+    auto first = std::begin(key);
+    ConcurrentTrieNode<T> *node = descend(first, std::end(key));
+    if (first != std::end(key)) {
+        return false;
+    }
+    return node->endOfKey.exchange(false, std::memory_order_acq_rel);
+}
+
+#endif // SRC_CONCURRENT_DELETE_H
@@ -0,0 +1,79 @@
+#ifndef SRC_CONCURRENT_INIT_H
+#define SRC_CONCURRENT_INIT_H
+
+/**
+ * Default constructor
+ */
+template<class T> ConcurrentTrieNode<T>::ConcurrentTrieNode() : value(), children(NULL), endOfKey(false) {}
+
+/**
+ * Initialize a ConcurrentTrieNode with the given value.
+ */
+template<class T> ConcurrentTrieNode<T>::ConcurrentTrieNode(const T &val) : value(val), children(NULL),
+    endOfKey(false) {}
+
+/**
+ * Return this ConcurrentTrieNode's value. Values never change once a node exists.
+ */
+template<class T> const T &ConcurrentTrieNode<T>::getValue()
+{
+    return value;
+}
+
+/**
+ * Return true if a key ends at this ConcurrentTrieNode, false otherwise.
+ */
+template<class T> bool ConcurrentTrieNode<T>::isEndOfKey()
+{
+    return endOfKey.load(std::memory_order_acquire);
+}
+
+/**
+ * Mark/unmark this ConcurrentTrieNode as the end of a key.
+ */
+template<class T> void ConcurrentTrieNode<T>::setEndOfKey(bool endOfKey)
+{
+    this->endOfKey.store(endOfKey, std::memory_order_release);
+}
+
+/**
+ * Return the number of children that this ConcurrentTrieNode has right now.
+ */
+template<class T> int ConcurrentTrieNode<T>::getNumChildren()
+{
+    ReadGuard guard;
+    ChildArray *current = children.load(std::memory_order_acquire);
+    return (current == NULL) ? 0 : current->size();
+}
+
+/**
+ * Return true if this ConcurrentTrieNode has children, false otherwise.
+ */
+template<class T> bool ConcurrentTrieNode<T>::hasChildren()
+{
+    return children.load(std::memory_order_acquire) != NULL;
+}
+
+/**
+ * Return the number of ConcurrentTrieNodes in this Trie, including this one. The Trie
+ * is walked without locking, so with writers active, the result reflects some mix of
+ * the states the Trie went through during the walk.
+ */
+template<class T> uint64_t ConcurrentTrieNode<T>::size()
+{
+    ReadGuard guard;
+    uint64_t numNodes = 0;
+    std::vector<ConcurrentTrieNode<T> *> pending(1, this);
+    while (!pending.empty()) {
+        ConcurrentTrieNode<T> *node = pending.back();
+        pending.pop_back();
+        numNodes++;
+        ChildArray *current = node->children.load(std::memory_order_acquire);
+        for (size_t i = 0; current != NULL && i < current->size(); i++) {
+            pending.push_back((*current)[i]);
+        }
+    }
+    return numNodes;
+}
+
+#endif // SRC_CONCURRENT_INIT_H
@@ -0,0 +1,97 @@
+#ifndef SRC_CONCURRENT_INSERT_H
+#define SRC_CONCURRENT_INSERT_H
+
+/**
+ * Helper method - make newChildren (NULL for none) this ConcurrentTrieNode's children,
+ * replacing (and retiring) oldChildren. Called with writeLock held.
+ */
+template<class T> void ConcurrentTrieNode<T>::publish(ChildArray *oldChildren, ChildArray *newChildren)
+{
+    children.store(newChildren, std::memory_order_release);
+    if (oldChildren != NULL) {
+        EpochDomain::instance().retire(oldChildren);
+    }
+}
+
+/**
+ * Helper method - append child to the current children, in place unless they are
+ * full; then a copy twice as large is published instead. Called with writeLock held.
+ */
+template<class T> void ConcurrentTrieNode<T>::appendChild(ConcurrentTrieNode<T> *child)
+{
+    ChildArray *oldChildren = children.load(std::memory_order_relaxed);
+    if (oldChildren != NULL && !oldChildren->full()) {
+        oldChildren->append(child);
+        return;
+    }
+    ChildArray *newChildren = (oldChildren == NULL) ? new ChildArray(1) :
+        ChildArray::copyOf(*oldChildren, 2 * oldChildren->capacity(), oldChildren->size());
+    newChildren->append(child);
+    publish(oldChildren, newChildren);
+}
+
+/**
+ * Add the given node as a child, unless there already is a child with the same value.
+ * Return true if the child was added; this Trie then owns it.
+ */
+template<class T> bool ConcurrentTrieNode<T>::addChild(ConcurrentTrieNode<T> *child)
+{
+    if (child == NULL) {
+        return false;
+    }
+    ReadGuard guard;
+    std::lock_guard<std::mutex> lock(writeLock);
+    if (findChild(child->value) != NULL) {
+        return false;
+    }
+    appendChild(child);
+    return true;
+}
+
+/**
+ * Helper method - return the child with the given value, adding it first if there is
+ * none. Lock-free if the child already exists. The caller holds a ReadGuard.
+ */
+template<class T> ConcurrentTrieNode<T> *ConcurrentTrieNode<T>::findOrAddChild(const T &value)
+{
+    ConcurrentTrieNode<T> *child = findChild(value);
+    if (child != NULL) {
+        return child;
+    }
+    std::lock_guard<std::mutex> lock(writeLock);
+    // Another writer may have added it in the meantime.
+    child = findChild(value);
+    if (child == NULL) {
+        child = new ConcurrentTrieNode<T>(value);
+        appendChild(child);
+    }
+    return child;
+}
+
+/**
+ * Add a child with the given value, unless there already is one.
+ */
+template<class T> ConcurrentTrieNode<T> &ConcurrentTrieNode<T>::operator<<(const T &value)
+{
+    ReadGuard guard;
+    findOrAddChild(value);
+    return *this;
+}
+
+/**
+ * Insert the given key below this ConcurrentTrieNode and mark its last node as the end
+ * of a key. Only the nodes that get a new child are locked, one at a time. Return the
+ * last node; call with a ReadGuard held for it to stay valid.
+ */
+template<class T> template<class Key> ConcurrentTrieNode<T> *ConcurrentTrieNode<T>::insert(const Key &key)
+{
+    ReadGuard guard;
+    ConcurrentTrieNode<T> *current = this;
+    for (auto value = std::begin(key); value != std::end(key); ++value) {
+        current = current->findOrAddChild(*value);
+    }
+    current->setEndOfKey(true);
+    return current;
+}
+
+#endif // SRC_CONCURRENT_INSERT_H
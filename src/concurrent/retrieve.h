@@ -0,0 +1,134 @@
+#ifndef SRC_CONCURRENT_RETRIEVE_H
+#define SRC_CONCURRENT_RETRIEVE_H
+
+/**
+ * Return the child at the specified index, or NULL if the index is out of bounds.
+ * Call with a ReadGuard held for the result to stay valid.
+ */
+template<class T> ConcurrentTrieNode<T> *ConcurrentTrieNode<T>::getChildAtIndex(int index)
+{
+    ReadGuard guard;
+    ChildArray *current = children.load(std::memory_order_acquire);
+    if (current == NULL || index < 0 || index >= (int) current->size()) {
+        return NULL;
+    }
+    return (*current)[index];
+}
+
+/**
+ * Helper method - return the child with the given value, or NULL if there is none.
+ * The caller holds a ReadGuard. Lock-free: the current ChildArray is searched as is.
+ */
+template<class T> ConcurrentTrieNode<T> *ConcurrentTrieNode<T>::findChild(const T &value)
+{
+    ChildArray *current = children.load(std::memory_order_acquire);
+    if (current == NULL) {
+        return NULL;
+    }
+    int index = current->find(value);
+    return (index == -1) ? NULL : (*current)[index];
+}
+
+/**
+ * Return the child with the given value, or NULL if there is none. Call with a
+ * ReadGuard held for the result to stay valid.
+ */
+template<class T> ConcurrentTrieNode<T> *ConcurrentTrieNode<T>::operator[](const T &value)
+{
+    ReadGuard guard;
+    return findChild(value);
+}
+
+/**
+ * Return true if this ConcurrentTrieNode has a child with the given value.
+ */
+template<class T> bool ConcurrentTrieNode<T>::hasChild(const T &value)
+{
+    ReadGuard guard;
+    return findChild(value) != NULL;
+}
+
+/**
+ * Helper method - follow [first, last) down from this node for as long as matching
+ * children exist; same contract as TrieNode::descend. The caller holds a ReadGuard.
+ */
+template<class T> template<class Iter>
+ConcurrentTrieNode<T> *ConcurrentTrieNode<T>::descend(Iter &first, Iter last)
+{
+    ConcurrentTrieNode<T> *current = this;
+    for (; first != last; ++first) {
+        ConcurrentTrieNode<T> *next = current->findChild(*first);
+        if (next == NULL) {
+            break;
+        }
+        current = next;
+    }
+    return current;
+}
+
+/**
+ * Return the node at which the given key ends, or NULL if the key is not stored. Call
+ * with a ReadGuard held for the result to stay valid.
+ */
+template<class T> template<class Key> ConcurrentTrieNode<T> *ConcurrentTrieNode<T>::find(const Key &key)
+{
+    ReadGuard guard;
+    auto first = std::begin(key);
+    ConcurrentTrieNode<T> *node = descend(first, std::end(key));
+    if (first != std::end(key) || !node->isEndOfKey()) {
+        return NULL;
+    }
+    return node;
+}
+
+/**
+ * Return true if the given key is stored.
+ */
+template<class T> template<class Key> bool ConcurrentTrieNode<T>::contains(const Key &key)
+{
+    return find(key) != NULL;
+}
+
+/**
+ * Return true if the given key is a path in this Trie (a stored key or a prefix of one).
+ */
+template<class T> template<class Key> bool ConcurrentTrieNode<T>::isPrefix(const Key &key)
+{
+    ReadGuard guard;
+    auto first = std::begin(key);
+    descend(first, std::end(key));
+    return first == std::end(key);
+}
+
+/**
+ * Call visit(key) with every stored key, in pre-order, without locking. See
+ * FrozenTrie::forEachKey(). Keys inserted or removed during the walk may or may not
+ * be visited.
+ */
+template<class T> template<class Visitor> void ConcurrentTrieNode<T>::forEachKey(Visitor visit)
+{
+    ReadGuard guard;
+    std::vector<T> key;
+    std::vector<std::pair<ConcurrentTrieNode<T> *, size_t> > pending(1, std::make_pair(this, size_t(0)));
+    while (!pending.empty()) {
+        ConcurrentTrieNode<T> *node = pending.back().first;
+        size_t depth = pending.back().second;
+        pending.pop_back();
+        key.resize(depth);
+        if (node != this) {
+            key.push_back(node->value);
+        }
+        if (node->isEndOfKey()) {
+            visit(static_cast<const std::vector<T> &>(key));
+        }
+        ChildArray *current = node->children.load(std::memory_order_acquire);
+        if (current == NULL) {
+            continue;
+        }
+        for (size_t i = current->size(); i-- > 0;) {
+            pending.push_back(std::make_pair((*current)[i], key.size()));
+        }
+    }
+}
+
+#endif // SRC_CONCURRENT_RETRIEVE_H
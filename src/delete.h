@@ -4,24 +4,29 @@
 /**
  * Remove the child with the given value from this Trie, and return a
  * reference to it. If there is no such child, then return NULL.
+ * The removed child becomes the root of its own Trie (it has no parent).
  */
-template<class T> TrieNode<T> *TrieNode<T>::removeChild(T value)
+template<class T, class Traits> TrieNode<T, Traits> *TrieNode<T, Traits>::removeChild(const T &value)
 {
-	int childIndex = this->getIndexOfChild(value);
-	if (childIndex == -1) {
+	int index = this->indexOfChild(value);
+	if (index == -1) {
 		return NULL;
 	}
-	TrieNode<T> *childToDelete = children[childIndex];
-	children.erase(children.begin() + childIndex);
+	TrieNode<T, Traits> *childToDelete = children[index];
+	children.erase(children.begin() + index);
+	childIndex.erased(children, index, childToDelete->value);
+	childToDelete->linkParent(NULL);
+	adjustCounts(-(int64_t) childToDelete->countedNodes(), -(int64_t) childToDelete->countedKeys());
+	refreshMaxWeight();
 	return childToDelete;
 }
 
-template<class T> TrieNode<T> *TrieNode<T>::operator>>(TrieNode<T> &child)
+template<class T, class Traits> TrieNode<T, Traits> *TrieNode<T, Traits>::operator>>(TrieNode<T, Traits> &child)
 {
 	return this->removeChild(child.getValue());
 }
 
-template<class T> TrieNode<T> *TrieNode<T>::operator>>(T value)
+template<class T, class Traits> TrieNode<T, Traits> *TrieNode<T, Traits>::operator>>(const T &value)
 {
 	return this->removeChild(value);
 }
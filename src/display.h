@@ -8,7 +8,7 @@
  * =======
  * 2 3 4 5
  */
-template<class T> std::string displayNode(TrieNode<T> &tn)
+template<class T, class Traits> std::string displayNode(TrieNode<T, Traits> &tn)
 {
     std::stringstream strStream;
     const int NUM_CHILDREN = tn.getNumChildren();
@@ -23,33 +23,27 @@ template<class T> std::string displayNode(TrieNode<T> &tn)
 
     // Print children's values, separated by a space.
     for (int i = 0; i < tn.getNumChildren(); i++) {
-        TrieNode<T> *child = tn.getChildAtIndex(i);
+        TrieNode<T, Traits> *child = tn.getChildAtIndex(i);
         strStream << child->getValue() << " ";
     }
     return strStream.str();
 }
 
 /**
- * Recursive function that writes the current Trie and all sub-Tries to output.
+ * Writes the current Trie and all sub-Tries to output, in pre-order: displayNode for
+ * every node that has children, followed by a blank line. The text is streamed
+ * through a TrieExporter (see src/exporter.h) rather than built node by node.
  */
-template<class T> void displayTrie(std::ostream &output, TrieNode<T> &tn)
+template<class T, class Traits> void displayTrie(std::ostream &output, TrieNode<T, Traits> &tn)
 {
-    // Stop if the node is a leaf.
-    if (!tn.hasChildren()) {
-        return;
-    }
-    // Otherwise, display the current node + its children.
-    output << displayNode(tn) << std::endl << std::endl;
-    // Then, repeat for each child node.
-    for (int i = 0; i < tn.getNumChildren(); i++) {
-        displayTrie(output, *(tn.getChildAtIndex(i)));
-    }
+    TrieExporter<T, Traits> exporter(output);
+    exporter.write(tn, TRIE_EXPORT_PRETTY);
 }
 
 /**
  * Writes the provided Trie (parent node + all descendants) to the given output stream.
  */
-template<class T> std::ostream &operator<<(std::ostream &output, TrieNode<T> &tn)
+template<class T, class Traits> std::ostream &operator<<(std::ostream &output, TrieNode<T, Traits> &tn)
 {
     if (!tn.hasChildren()) {
         output << tn.getValue() << std::endl;
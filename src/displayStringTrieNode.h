@@ -16,12 +16,12 @@
  *      lengths since there is 1 whitespace after each child. But we subtract 1
  *      since the last child's value will not be followed by a whitespace.
  */
-static size_t getNumSeparators(TrieNode<std::string> &tn)
+template<class Traits> static size_t getNumSeparators(TrieNode<std::string, Traits> &tn)
 {
     size_t numSeparators = 0;
 
     for (int i = 0; i < tn.getNumChildren(); i++) {
-        TrieNode<std::string> *child = tn.getChildAtIndex(i);
+        TrieNode<std::string, Traits> *child = tn.getChildAtIndex(i);
         std::string val = child->getValue();
         numSeparators += val.size() + 1;
     }
@@ -36,7 +36,7 @@ static size_t getNumSeparators(TrieNode<std::string> &tn)
  *     hello
  *  =========== -> Used to separate current node from children
  */
-static void handleCurrentNode(TrieNode<std::string> &tn, std::stringstream &strStream)
+template<class Traits> static void handleCurrentNode(TrieNode<std::string, Traits> &tn, std::stringstream &strStream)
 {
     const char SEPARATOR = '=';
     size_t parentNodeLen = tn.getValue().size();    
@@ -61,7 +61,7 @@ static void handleCurrentNode(TrieNode<std::string> &tn, std::stringstream &strS
  * Template specialization / overloaded version of displayNode in trieNode.h
  * Specifies how a single TrieNode<string> should be displayed.
  */
-inline std::string displayNode(TrieNode<std::string> &tn)
+template<class Traits> inline std::string displayNode(TrieNode<std::string, Traits> &tn)
 {
     std::stringstream strStream;
     size_t parentLen = tn.getValue().size();
@@ -71,14 +71,14 @@ inline std::string displayNode(TrieNode<std::string> &tn)
     handleCurrentNode(tn, strStream);
 
     // child nodes
-    TrieNode<std::string> *firstChild = tn.getChildAtIndex(0);
+    TrieNode<std::string, Traits> *firstChild = tn.getChildAtIndex(0);
     if (firstChild != NULL && numSeparators < parentLen) {
         strStream << std::string(parentLen / 2 - 2, ' ');
     }
 
     int nc = tn.getNumChildren();
     for (int i = 0; i < nc; i++) {
-        TrieNode<std::string> *child = tn.getChildAtIndex(i);
+        TrieNode<std::string, Traits> *child = tn.getChildAtIndex(i);
         strStream << child->getValue(); 
         if (i != nc-1) {
             strStream << "|";
@@ -88,5 +88,42 @@ inline std::string displayNode(TrieNode<std::string> &tn)
     return strStream.str();
 }
 
+/**
+ * The pretty block that displayNode above gives for a TrieNode<std::string>, for
+ * TrieExporter (see src/exporter.h): the value centered over a line of '=' as wide
+ * as the children, which are separated by '|'. Indents that would be negative are
+ * left out.
+ */
+template<class T, class Traits> void TrieExporter<T, Traits>::writePrettyNode(Node &node, std::true_type)
+{
+    const size_t NUM_CHILDREN = node.children.size();
+    size_t parentLen = node.value.size();
+    size_t childrenLen = NUM_CHILDREN - 1;
+    for (size_t i = 0; i < NUM_CHILDREN; i++) {
+        childrenLen += node.children[i]->value.size();
+    }
+
+    // Center the parent over the children if they are wider; otherwise indent the
+    // children below it.
+    size_t numSeparators = std::max(childrenLen, parentLen);
+    if (childrenLen > parentLen && childrenLen / 2 > 2) {
+        buffer.fill(' ', childrenLen / 2 - 2);
+    }
+    buffer.append(node.value.data(), parentLen);
+    buffer.append('\n');
+    buffer.fill('=', numSeparators);
+    buffer.append('\n');
+    if (childrenLen < parentLen && parentLen / 2 > 2) {
+        buffer.fill(' ', parentLen / 2 - 2);
+    }
+
+    for (size_t i = 0; i < NUM_CHILDREN; i++) {
+        buffer.append(node.children[i]->value.data(), node.children[i]->value.size());
+        if (i != NUM_CHILDREN - 1) {
+            buffer.append('|');
+        }
+    }
+}
+
 #endif // SRC_DISPLAY_STRING_TRIE_NODE_H
 
@@ -0,0 +1,252 @@
+#ifndef SRC_EPOCH_H
+#define SRC_EPOCH_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Epoch-based memory reclamation, for structures whose readers take no locks
+ *      (see ConcurrentTrieNode). Readers announce that they are inside the structure
+ *      with a Guard; memory that writers unlink is retired rather than freed, and only
+ *      freed once no thread can still be looking at it.
+ *
+ * DETAILS:
+ *      There is a global epoch counter. A thread entering a Guard records the current
+ *      epoch; memory retired during epoch e is tagged with e. The global epoch only
+ *      moves from e to e + 1 once every thread inside a Guard has recorded e, so by
+ *      the time it reaches e + 2, every thread that might have seen memory retired in
+ *      epoch e has left its Guard, and that memory is freed.
+ *
+ *      Each thread gets a record (reused after the thread exits) holding its epoch and
+ *      its own list of retired memory, so neither entering a Guard nor retiring takes a
+ *      lock. Retired memory left behind by exiting threads is adopted by the domain.
+ *      There is a single domain per process; see instance().
+ */
+class EpochDomain
+{
+private:
+    static const size_t COLLECT_EVERY = 64;     // retirements between attempts to free
+
+    struct Retired
+    {
+        void *pointer;
+        void (*destroy)(void *);
+        uint64_t epoch;
+    };
+
+    struct Record
+    {
+        std::atomic<uint64_t> epoch;
+        std::atomic<bool> active;
+        std::atomic<bool> inUse;
+        unsigned depth;                 // nested Guards; only touched by the owning thread
+        std::vector<Retired> retired;
+        Record *next;
+
+        Record() : epoch(0), active(false), inUse(true), depth(0), next(NULL) {}
+    };
+
+    // Releases the calling thread's record when the thread exits.
+    struct RecordHolder
+    {
+        EpochDomain *domain;
+        Record *record;
+
+        RecordHolder() : domain(NULL), record(NULL) {}
+        ~RecordHolder()
+        {
+            if (record != NULL) {
+                domain->releaseRecord(record);
+            }
+        }
+    };
+
+    std::atomic<uint64_t> globalEpoch;
+    std::atomic<Record *> records;      // never shrinks; records are reused instead
+    std::mutex orphanLock;
+    std::vector<Retired> orphans;       // retired by threads that have exited since
+
+    template<class X> static void destroyObject(void *pointer)
+    {
+        delete static_cast<X *>(pointer);
+    }
+
+    static void destroyAll(std::vector<Retired> &list)
+    {
+        for (size_t i = 0; i < list.size(); i++) {
+            list[i].destroy(list[i].pointer);
+        }
+        list.clear();
+    }
+
+    // Free the entries of list that no thread can reach any more.
+    static void destroyBefore(std::vector<Retired> &list, uint64_t safeEpoch)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < list.size(); i++) {
+            if (list[i].epoch + 2 <= safeEpoch) {
+                list[i].destroy(list[i].pointer);
+            }
+            else {
+                list[kept++] = list[i];
+            }
+        }
+        list.resize(kept);
+    }
+
+    Record *localRecord()
+    {
+        static thread_local RecordHolder holder;
+        if (holder.record != NULL) {
+            return holder.record;
+        }
+        holder.domain = this;
+        // Reuse the record of a thread that has exited, if there is one.
+        for (Record *record = records.load(); record != NULL; record = record->next) {
+            bool expected = false;
+            if (!record->inUse.load() && record->inUse.compare_exchange_strong(expected, true)) {
+                holder.record = record;
+                return record;
+            }
+        }
+        Record *record = new Record();
+        record->next = records.load();
+        while (!records.compare_exchange_weak(record->next, record)) {}
+        holder.record = record;
+        return record;
+    }
+
+    void releaseRecord(Record *record)
+    {
+        {
+            std::lock_guard<std::mutex> guard(orphanLock);
+            orphans.insert(orphans.end(), record->retired.begin(), record->retired.end());
+        }
+        record->retired.clear();
+        record->inUse.store(false);
+    }
+
+    /**
+     * Move the global epoch on by one if every thread inside a Guard has caught up with
+     * it. Return the global epoch afterwards.
+     */
+    uint64_t tryAdvance()
+    {
+        uint64_t epoch = globalEpoch.load();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (Record *record = records.load(); record != NULL; record = record->next) {
+            if (record->active.load() && record->epoch.load() != epoch) {
+                return epoch;
+            }
+        }
+        globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+        return globalEpoch.load();
+    }
+
+    void collect(Record *record)
+    {
+        uint64_t epoch = tryAdvance();
+        destroyBefore(record->retired, epoch);
+        std::unique_lock<std::mutex> guard(orphanLock, std::try_to_lock);
+        if (guard.owns_lock()) {
+            destroyBefore(orphans, epoch);
+        }
+    }
+
+    EpochDomain() : globalEpoch(2), records(NULL) {}
+
+    // No copying - there is only one domain.
+    EpochDomain(const EpochDomain &);
+    EpochDomain &operator=(const EpochDomain &);
+
+public:
+    /**
+     * Return the domain shared by every structure in this process.
+     */
+    static EpochDomain &instance()
+    {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    /**
+     * At exit, no thread is left inside a Guard, so everything still retired is freed.
+     */
+    ~EpochDomain()
+    {
+        destroyAll(orphans);
+        Record *record = records.load();
+        while (record != NULL) {
+            Record *next = record->next;
+            destroyAll(record->retired);
+            delete record;
+            record = next;
+        }
+    }
+
+    /**
+     * While a Guard exists, memory the calling thread can reach is not freed, even if
+     * other threads retire it. Guards nest; entering and leaving one takes no lock.
+     */
+    class Guard
+    {
+    private:
+        Record *record;
+
+        Guard(const Guard &);
+        Guard &operator=(const Guard &);
+
+    public:
+        Guard() : record(EpochDomain::instance().localRecord())
+        {
+            if (record->depth++ == 0) {
+                record->epoch.store(EpochDomain::instance().globalEpoch.load());
+                record->active.store(true);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        ~Guard()
+        {
+            if (--record->depth == 0) {
+                record->active.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    /**
+     * Free pointer (with delete) once no thread can still reach it. It must already be
+     * unreachable for threads entering a Guard from now on.
+     */
+    template<class X> void retire(X *pointer)
+    {
+        Record *record = localRecord();
+        Retired retired = { pointer, &destroyObject<X>, globalEpoch.load() };
+        record->retired.push_back(retired);
+        if (record->retired.size() % COLLECT_EVERY == 0) {
+            collect(record);
+        }
+    }
+
+    /**
+     * Free whatever the calling thread has retired, waiting for other threads to leave
+     * their Guards as needed. Must not be called from inside a Guard.
+     */
+    void synchronize()
+    {
+        Record *record = localRecord();
+        uint64_t target = globalEpoch.load() + 2;
+        while (tryAdvance() < target) {
+            std::this_thread::yield();
+        }
+        destroyBefore(record->retired, globalEpoch.load());
+        std::lock_guard<std::mutex> guard(orphanLock);
+        destroyBefore(orphans, globalEpoch.load());
+    }
+};
+
+#endif // SRC_EPOCH_H
@@ -0,0 +1,368 @@
+#ifndef SRC_EXPORTER_H
+#define SRC_EXPORTER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+#include "trieNodeTraits.h"
+
+template<class T, class Traits> struct TrieWalk;
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Write a Trie out as text, in one of three formats:
+ *          TRIE_EXPORT_PRETTY - what operator<< / displayTrie print (see src/display.h)
+ *          TRIE_EXPORT_DOT    - a Graphviz digraph; keys end at double circles
+ *          TRIE_EXPORT_JSON   - nested {"value", "endOfKey", "children"} objects
+ *      Huge Tries can be sampled: setMaxDepth leaves out everything deeper than the
+ *      given depth (the root is at depth 0), and setMaxNodes stops after the given
+ *      number of nodes. In DOT and JSON, nodes whose children were (partly) left out
+ *      are marked - dashed, or "truncated": true.
+ *
+ * DETAILS:
+ *      Everything is written into one ExportBuffer, which grows to the largest chunk
+ *      ever needed and is handed to the output stream whenever it holds bufferSize
+ *      characters, between two nodes. Values go through operator<< on an ostream
+ *      writing into that buffer, so any T that can be displayed can be exported, and
+ *      nothing is allocated per node. The Trie is walked with parent pointers (see
+ *      src/iterator.h), without recursion or a stack - or, in Tries without them, with
+ *      a stack of the TrieNodes above the current one.
+ *
+ *      An exporter can be reused for several Tries; the buffer is kept.
+ */
+enum TrieExportFormat
+{
+    TRIE_EXPORT_PRETTY,
+    TRIE_EXPORT_DOT,
+    TRIE_EXPORT_JSON
+};
+
+/**
+ * A streambuf appending to a string that is kept (and only grows) across flushes.
+ */
+class ExportBuffer : public std::streambuf
+{
+public:
+    explicit ExportBuffer(size_t capacity) { text.reserve(capacity); }
+
+    size_t size() const { return text.size(); }
+    void append(char c) { text.push_back(c); }
+    void append(const char *s, size_t n) { text.append(s, n); }
+    void fill(char c, size_t n) { text.append(n, c); }
+
+    /**
+     * Escape text[from, size()) in place for a JSON or DOT string. Returns quickly if
+     * nothing needs escaping, which is the usual case.
+     */
+    void escape(size_t from, TrieExportFormat format)
+    {
+        size_t i = from;
+        while (i < text.size() && !needsEscape(text[i])) {
+            i++;
+        }
+        if (i == text.size()) {
+            return;
+        }
+        scratch.assign(text, i, std::string::npos);
+        text.resize(i);
+        for (size_t j = 0; j < scratch.size(); j++) {
+            unsigned char c = scratch[j];
+            if (!needsEscape(c)) {
+                text.push_back(c);
+            }
+            else if (c == '"' || c == '\\') {
+                text.push_back('\\');
+                text.push_back(c);
+            }
+            else {
+                // Control characters: \u00XX in JSON, shown as \xXX in a DOT label.
+                const char *HEX = "0123456789abcdef";
+                text.append(format == TRIE_EXPORT_JSON ? "\\u00" : "\\\\x");
+                text.push_back(HEX[c >> 4]);
+                text.push_back(HEX[c & 15]);
+            }
+        }
+    }
+
+    /**
+     * Hand everything buffered to output. Return whether output is still good.
+     */
+    bool flushTo(std::ostream &output)
+    {
+        output.write(text.data(), text.size());
+        text.clear();
+        return output.good();
+    }
+
+protected:
+    int_type overflow(int_type c)
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            text.push_back(traits_type::to_char_type(c));
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n)
+    {
+        text.append(s, n);
+        return n;
+    }
+
+private:
+    std::string text;
+    std::string scratch;        // the tail being escaped
+
+    static bool needsEscape(unsigned char c) { return c < 0x20 || c == '"' || c == '\\'; }
+};
+
+template<class T, class Traits = TrieNodeTraits> class TrieExporter
+{
+public:
+    static const size_t NO_LIMIT = size_t(-1);
+
+    /**
+     * Export to output, in chunks of (about) bufferSize characters.
+     */
+    explicit TrieExporter(std::ostream &output, size_t bufferSize = 64 * 1024) :
+        output(output), buffer(bufferSize + 1024), valueStream(&buffer), bufferSize(bufferSize),
+        maxDepth(NO_LIMIT), maxNodes(NO_LIMIT), numNodes(0), truncated(false), needComma(false) {}
+
+    ~TrieExporter() { buffer.flushTo(output); }
+
+    /**
+     * Leave out the TrieNodes more than maxDepth levels below the root.
+     */
+    void setMaxDepth(size_t maxDepth) { this->maxDepth = maxDepth; }
+
+    /**
+     * Stop after maxNodes TrieNodes (at least the root is always written).
+     */
+    void setMaxNodes(size_t maxNodes) { this->maxNodes = maxNodes; }
+
+    /**
+     * Return the number of TrieNodes written by the last call to write().
+     */
+    uint64_t getNumNodes() const { return numNodes; }
+
+    /**
+     * Return whether the limits left anything out in the last call to write().
+     */
+    bool isTruncated() const { return truncated; }
+
+    bool write(TrieNode<T, Traits> &root, TrieExportFormat format);
+
+private:
+    typedef TrieNode<T, Traits> Node;
+    typedef TrieWalk<T, Traits> Walk;
+
+    std::ostream &output;
+    ExportBuffer buffer;
+    std::ostream valueStream;   // formats values into buffer
+    size_t bufferSize;
+    size_t maxDepth;
+    size_t maxNodes;
+    uint64_t numNodes;
+    bool truncated;
+    bool needComma;             // JSON: the next object follows a sibling
+    std::vector<uint64_t> ids;  // DOT: ids of the TrieNodes on the current path
+    TrieAncestors<Node, Traits::KEEP_PARENT> ancestors;
+
+    void enter(Node &node, size_t depth, TrieExportFormat format);
+    void leave(size_t depth, bool cut, TrieExportFormat format);
+    void writeValue(const T &value, TrieExportFormat format);
+    void writeNumber(uint64_t n);
+    void writePrettyNode(Node &node, std::false_type);
+    void writePrettyNode(Node &node, std::true_type);
+};
+
+/**
+ * Write the Trie rooted at root (all of it, or as much as the limits allow) to the
+ * output, in the given format. Return false if the output stream failed.
+ */
+template<class T, class Traits> bool TrieExporter<T, Traits>::write(Node &root, TrieExportFormat format)
+{
+    numNodes = 0;
+    truncated = false;
+    needComma = false;
+    if (format == TRIE_EXPORT_DOT) {
+        buffer.append("digraph trie {\n", 15);
+    }
+
+    Node *node = &root;
+    size_t depth = 0;
+    enter(*node, depth, format);
+    while (true) {
+        // Go down while the limits allow.
+        Node *child = Walk::firstChild(node);
+        if (child != NULL && depth < maxDepth && numNodes < maxNodes) {
+            node = Walk::descend(node, ancestors);
+            enter(*node, ++depth, format);
+            continue;
+        }
+
+        // Otherwise, close node and its ancestors until one has a next child to visit.
+        bool cut = (child != NULL);
+        while (true) {
+            leave(depth, cut, format);
+            truncated = truncated || cut;
+            if (node == &root) {
+                if (format != TRIE_EXPORT_PRETTY) {
+                    buffer.append(format == TRIE_EXPORT_DOT ? "}\n" : "\n", format == TRIE_EXPORT_DOT ? 2 : 1);
+                }
+                return buffer.flushTo(output);
+            }
+            Node *parent = ancestors.parentOf(node);
+            Node *sibling = Walk::nextSibling(parent, ancestors);
+            if (sibling != NULL && numNodes < maxNodes) {
+                node = sibling;
+                enter(*node, depth, format);
+                break;
+            }
+            cut = (sibling != NULL);
+            ancestors.ascended();
+            node = parent;
+            depth--;
+        }
+    }
+}
+
+/**
+ * Helper method - write whatever comes before node's children.
+ */
+template<class T, class Traits> void TrieExporter<T, Traits>::enter(Node &node, size_t depth, TrieExportFormat format)
+{
+    uint64_t id = numNodes++;
+    if (format == TRIE_EXPORT_PRETTY) {
+        // Every TrieNode with children (shown) gets a block, as in displayTrie.
+        if (node.hasChildren() && depth < maxDepth) {
+            writePrettyNode(node, std::is_same<T, std::string>());
+            buffer.append("\n\n", 2);
+        }
+    }
+    else if (format == TRIE_EXPORT_DOT) {
+        buffer.append("  n", 3);
+        writeNumber(id);
+        buffer.append(" [label=", 8);
+        writeValue(node.value, format);
+        if (node.endOfKey) {
+            buffer.append(", shape=doublecircle", 20);
+        }
+        buffer.append("];\n", 3);
+        if (depth > 0) {
+            buffer.append("  n", 3);
+            writeNumber(ids[depth - 1]);
+            buffer.append(" -> n", 5);
+            writeNumber(id);
+            buffer.append(";\n", 2);
+        }
+        if (ids.size() <= depth) {
+            ids.resize(depth + 1);
+        }
+        ids[depth] = id;
+    }
+    else {
+        if (needComma) {
+            buffer.append(',');
+        }
+        buffer.append("{\"value\":", 9);
+        writeValue(node.value, format);
+        buffer.append(node.endOfKey ? ",\"endOfKey\":true,\"children\":[" : ",\"endOfKey\":false,\"children\":[",
+            node.endOfKey ? 29 : 30);
+        needComma = false;
+    }
+
+    if (buffer.size() >= bufferSize) {
+        buffer.flushTo(output);
+    }
+}
+
+/**
+ * Helper method - write whatever comes after the children of the TrieNode at the
+ * given depth; cut says whether some of them were left out.
+ */
+template<class T, class Traits> void TrieExporter<T, Traits>::leave(size_t depth, bool cut, TrieExportFormat format)
+{
+    if (format == TRIE_EXPORT_DOT && cut) {
+        buffer.append("  n", 3);
+        writeNumber(ids[depth]);
+        buffer.append(" [style=dashed];\n", 17);
+    }
+    else if (format == TRIE_EXPORT_JSON) {
+        if (cut) {
+            buffer.append("],\"truncated\":true}", 19);
+        }
+        else {
+            buffer.append("]}", 2);
+        }
+        needComma = true;
+    }
+}
+
+/**
+ * Helper method - write a value: as operator<< shows it in the pretty format, and as
+ * a quoted, escaped string in DOT and JSON (except for integers in JSON, which are
+ * written as numbers).
+ */
+template<class T, class Traits> void TrieExporter<T, Traits>::writeValue(const T &value, TrieExportFormat format)
+{
+    const bool IS_NUMBER = std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+        !std::is_same<T, char>::value && !std::is_same<T, signed char>::value &&
+        !std::is_same<T, unsigned char>::value;
+    if (format == TRIE_EXPORT_PRETTY || (format == TRIE_EXPORT_JSON && IS_NUMBER)) {
+        valueStream << value;
+        return;
+    }
+    buffer.append('"');
+    size_t from = buffer.size();
+    valueStream << value;
+    buffer.escape(from, format);
+    buffer.append('"');
+}
+
+/**
+ * Helper method - write n in decimal.
+ */
+template<class T, class Traits> void TrieExporter<T, Traits>::writeNumber(uint64_t n)
+{
+    char digits[20];
+    int numDigits = 0;
+    do {
+        digits[numDigits++] = '0' + n % 10;
+        n /= 10;
+    } while (n > 0);
+    while (numDigits > 0) {
+        buffer.append(digits[--numDigits]);
+    }
+}
+
+/**
+ * Helper method - the pretty block for a TrieNode with children (see displayNode in
+ * src/display.h):
+ *    1
+ * =======
+ * 2 3 4 5
+ * TrieNode<std::string> has a layout of its own (the std::true_type overload, in
+ * src/displayStringTrieNode.h).
+ */
+template<class T, class Traits> void TrieExporter<T, Traits>::writePrettyNode(Node &node, std::false_type)
+{
+    const size_t NUM_CHILDREN = node.children.size();
+    buffer.fill(' ', NUM_CHILDREN);
+    valueStream << node.value;
+    buffer.append('\n');
+    buffer.fill('=', 2 * NUM_CHILDREN - 1);
+    buffer.append('\n');
+    for (size_t i = 0; i < NUM_CHILDREN; i++) {
+        valueStream << node.children[i]->value;
+        buffer.append(' ');
+    }
+}
+
+#endif // SRC_EXPORTER_H
@@ -0,0 +1,14 @@
+#ifndef SRC_FREEZE_H
+#define SRC_FREEZE_H
+
+/**
+ * Create a flat, read-only copy of this Trie, with this TrieNode as its root. The
+ * copy supports the same lookups (child, path, size, iteration over keys) from a few
+ * contiguous arrays; FrozenTrie::thaw() turns it back into TrieNodes.
+ */
+template<class T, class Traits> FrozenTrie<T> *TrieNode<T, Traits>::freeze()
+{
+    return new FrozenTrie<T>(*this);
+}
+
+#endif // SRC_FREEZE_H
@@ -0,0 +1,490 @@
+#ifndef SRC_FROZEN_TRIE_H
+#define SRC_FROZEN_TRIE_H
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include "childIndex.h"
+#include "structuralHash.h"
+#include "trieNodeTraits.h"
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Immutable, flat copy of a Trie (see TrieNode::freeze()). There are no node
+ *      objects and no pointers: nodes are numbered in breadth-first order, and
+ *      everything about them lives in a few contiguous arrays.
+ *
+ * DETAILS:
+ *      Breadth-first numbering puts the children of every node next to each other,
+ *      so one offset per node is enough to find them - the children of node i are
+ *      nodes childBegin[i] to childBegin[i + 1] - 1, in the order the TrieNode had
+ *      them. The root is node 0.
+ *
+ *          node:        0    1    2    3    4
+ *          value:       r    a    o    t    d      (keys "at", "od", "o")
+ *          childBegin:  1    3    4    5    5    5
+ *          endOfKey:    0    0    1    1    1
+ *
+ *      A node costs sizeof(T) + 4 bytes + 1 bit, plus 4 more bytes if T has "<" and
+ *      some node has more than LINEAR_MAX children: the children of such nodes are
+ *      additionally listed in sorted order, for binary search. Nodes are numbered
+ *      with 32 bits, so a FrozenTrie holds at most 2^32 - 1 nodes.
+ *
+ *      minimize() merges identical subtrees, turning the Trie into a directed acyclic
+ *      word graph (DAWG). Children are then no longer contiguous, so childBegin
+ *      indexes an explicit edge array instead (4 more bytes per edge), and a node
+ *      may have several parents. Children still always have larger numbers than
+ *      their parents.
+ */
+template<class T> class FrozenTrie
+{
+public:
+    typedef uint32_t Node;
+    static const Node NO_NODE = UINT32_MAX;
+
+private:
+    static const uint32_t LINEAR_MAX = 8;
+    static const bool ORDERED = IsOrderedValue<T>::value;
+
+    std::vector<T> values;
+    std::vector<uint32_t> childBegin;       // one more entry than there are nodes
+    std::vector<bool> endOfKey;
+    std::vector<uint32_t> sortedChildren;   // empty, unless some node is wide (see above)
+    std::vector<Node> edges;                // empty, unless minimized (see above)
+    uint64_t numKeys;
+
+    struct ValueLess
+    {
+        const std::vector<T> &values;
+        ValueLess(const std::vector<T> &v) : values(v) {}
+        bool operator()(uint32_t a, uint32_t b) const { return values[a] < values[b]; }
+    };
+    struct ValueBefore
+    {
+        const std::vector<T> &values;
+        ValueBefore(const std::vector<T> &v) : values(v) {}
+        bool operator()(uint32_t node, const T &value) const { return values[node] < value; }
+    };
+
+    // Return the child stored at position pos of the child lists.
+    Node childAt(uint32_t pos) const
+    {
+        return edges.empty() ? pos : edges[pos];
+    }
+
+    void sortWideNodes(std::true_type)
+    {
+        std::vector<uint32_t>().swap(sortedChildren);
+        for (Node node = 0; node < size(); node++) {
+            if (getNumChildren(node) <= LINEAR_MAX) {
+                continue;
+            }
+            if (sortedChildren.empty()) {
+                sortedChildren.resize(childBegin.back());
+            }
+            for (uint32_t i = childBegin[node]; i < childBegin[node + 1]; i++) {
+                sortedChildren[i] = childAt(i);
+            }
+            std::sort(sortedChildren.begin() + childBegin[node], sortedChildren.begin() + childBegin[node + 1],
+                ValueLess(values));
+        }
+    }
+    void sortWideNodes(std::false_type) {}
+
+    Node sortedFind(Node node, const T &value, std::true_type) const
+    {
+        std::vector<uint32_t>::const_iterator first = sortedChildren.begin() + childBegin[node];
+        std::vector<uint32_t>::const_iterator last = sortedChildren.begin() + childBegin[node + 1];
+        std::vector<uint32_t>::const_iterator it = std::lower_bound(first, last, value, ValueBefore(values));
+        return (it == last || !(values[*it] == value)) ? NO_NODE : *it;
+    }
+    Node sortedFind(Node, const T &, std::false_type) const { return NO_NODE; }
+
+
+    FrozenTrie() : numKeys(0) {}
+
+    // Follow [first, last) down from the root for as long as it matches; same
+    // contract as TrieNode::descend.
+    template<class Iter> Node descend(Iter &first, Iter last) const
+    {
+        Node current = 0;
+        for (; first != last; ++first) {
+            Node next = getChild(current, *first);
+            if (next == NO_NODE) {
+                break;
+            }
+            current = next;
+        }
+        return current;
+    }
+
+public:
+    /**
+     * Flatten the given Trie. The Trie itself is not modified.
+     */
+    template<class Traits> explicit FrozenTrie(TrieNode<T, Traits> &root) : numKeys(0)
+    {
+        // The breadth-first order itself serves as the queue.
+        std::vector<TrieNode<T, Traits> *> order(1, &root);
+        order.reserve(root.size());
+        values.reserve(order.capacity());
+        childBegin.reserve(order.capacity() + 1);
+        endOfKey.reserve(order.capacity());
+
+        for (size_t i = 0; i < order.size(); i++) {
+            TrieNode<T, Traits> *node = order[i];
+            values.push_back(node->value);
+            endOfKey.push_back(node->endOfKey);
+            childBegin.push_back(order.size());
+            order.insert(order.end(), node->children.begin(), node->children.end());
+            if (node->endOfKey) {
+                numKeys++;
+            }
+        }
+        childBegin.push_back(order.size());
+        sortWideNodes(std::integral_constant<bool, ORDERED>());
+    }
+
+    /**
+     * Build a FrozenTrie straight from sorted keys (see TrieNode::insertSorted() for
+     * the order expected), with rootValue at its root, without creating any TrieNodes.
+     * Return NULL if a key is out of order.
+     *
+     * Breadth-first numbering lists the nodes of each depth in the order that sorted
+     * input creates them, so nodes are appended to one array per depth as keys come
+     * in, along with their number of children; concatenating the depths at the end
+     * gives the final arrays, and child offsets follow from the counts.
+     */
+    template<class Iter> static FrozenTrie *fromSorted(const T &rootValue, Iter firstKey, Iter lastKey)
+    {
+        std::vector<std::vector<T> > levelValues(1, std::vector<T>(1, rootValue));
+        std::vector<std::vector<bool> > levelEndOfKey(1, std::vector<bool>(1, false));
+        std::vector<std::vector<uint32_t> > levelNumChildren(1, std::vector<uint32_t>(1, 0));
+        // The previous key is read back from the ends of the depth arrays.
+        size_t previousLength = 0;
+
+        for (; firstKey != lastKey; ++firstKey) {
+            const auto &key = *firstKey;
+            auto value = std::begin(key), end = std::end(key);
+
+            size_t depth = 0;
+            while (value != end && depth < previousLength && levelValues[depth + 1].back() == *value) {
+                ++value;
+                depth++;
+            }
+            if (depth < previousLength && (value == end || *value < levelValues[depth + 1].back())) {
+                return NULL;
+            }
+            for (; value != end; ++value) {
+                levelNumChildren[depth].back()++;
+                depth++;
+                if (levelValues.size() <= depth) {
+                    levelValues.resize(depth + 1);
+                    levelEndOfKey.resize(depth + 1);
+                    levelNumChildren.resize(depth + 1);
+                }
+                levelValues[depth].push_back(*value);
+                levelEndOfKey[depth].push_back(false);
+                levelNumChildren[depth].push_back(0);
+            }
+            levelEndOfKey[depth].back() = true;
+            previousLength = depth;
+        }
+
+        FrozenTrie *frozen = new FrozenTrie();
+        size_t numNodes = 0;
+        for (size_t d = 0; d < levelValues.size(); d++) {
+            numNodes += levelValues[d].size();
+        }
+        frozen->values.reserve(numNodes);
+        frozen->endOfKey.reserve(numNodes);
+        frozen->childBegin.reserve(numNodes + 1);
+        uint32_t nextChild = 1;
+        for (size_t d = 0; d < levelValues.size(); d++) {
+            frozen->values.insert(frozen->values.end(), levelValues[d].begin(), levelValues[d].end());
+            frozen->endOfKey.insert(frozen->endOfKey.end(), levelEndOfKey[d].begin(), levelEndOfKey[d].end());
+            for (size_t i = 0; i < levelNumChildren[d].size(); i++) {
+                frozen->childBegin.push_back(nextChild);
+                nextChild += levelNumChildren[d][i];
+                frozen->numKeys += levelEndOfKey[d][i] ? 1 : 0;
+            }
+            // Free each depth as soon as it has been copied.
+            std::vector<T>().swap(levelValues[d]);
+            std::vector<bool>().swap(levelEndOfKey[d]);
+            std::vector<uint32_t>().swap(levelNumChildren[d]);
+        }
+        frozen->childBegin.push_back(nextChild);
+        frozen->sortWideNodes(std::integral_constant<bool, ORDERED>());
+        return frozen;
+    }
+
+    /**
+     * Build a FrozenTrie from a sorted container of keys.
+     */
+    template<class Keys> static FrozenTrie *fromSorted(const T &rootValue, const Keys &keys)
+    {
+        return fromSorted(rootValue, std::begin(keys), std::end(keys));
+    }
+
+    /**
+     * Rebuild a TrieNode Trie from this FrozenTrie; the result is == to the Trie that
+     * was frozen. The TrieNodes are created breadth-first, one per path from the root
+     * (so a node shared after minimize() is copied for every path that reaches it),
+     * and their counts filled in by a second pass in reverse, with no lookups.
+     */
+    TrieNode<T> *thaw() const
+    {
+        std::vector<TrieNode<T> *> nodes(1, new TrieNode<T>(values[0]));
+        std::vector<Node> frozenNodes(1, Node(0));
+        for (size_t i = 0; i < nodes.size(); i++) {
+            TrieNode<T> *tn = nodes[i];
+            Node node = frozenNodes[i];
+            tn->endOfKey = endOfKey[node];
+            tn->children.reserve(getNumChildren(node));
+            for (uint32_t pos = childBegin[node]; pos < childBegin[node + 1]; pos++) {
+                TrieNode<T> *child = new TrieNode<T>(values[childAt(pos)]);
+                child->linkParent(tn);
+                tn->children.push_back(child);
+                nodes.push_back(child);
+                frozenNodes.push_back(childAt(pos));
+            }
+            tn->childIndex.rebuild(tn->children);
+        }
+        for (size_t i = nodes.size(); i-- > 0;) {
+            nodes[i]->recount();
+        }
+        return nodes[0];
+    }
+
+    /**
+     * Merge identical subtrees, so that each distinct subtree is stored once. Two
+     * subtrees are identical if they are == as TrieNodes: same value and end-of-key
+     * flag at the top, and identical children in the same order. Lookups, key
+     * iteration and thaw() give the same results as before; size() drops to the
+     * number of distinct subtrees.
+     *
+     * Children are numbered after their parents, so visiting the nodes from the last
+     * to the first sees every child before its parent. By then the children have
+     * been replaced with their canonical copies, so a node is identical to an
+     * earlier-kept one exactly if the two have the same value, flag and list of
+     * canonical children - one hash table lookup, with no recursive comparison.
+     * Calling minimize() again changes nothing.
+     */
+    void minimize()
+    {
+        Node numNodes = size();
+        std::vector<Node> canonical(numNodes);
+        // The kept nodes, in the order they were kept (children before parents).
+        std::vector<Node> kept;
+        std::vector<uint32_t> keptBegin(1, 0);
+        std::vector<Node> keptEdges;
+        std::unordered_multimap<uint64_t, Node> table;
+
+        for (Node node = numNodes; node-- > 0;) {
+            uint64_t hash = StructuralHash::mix(StructuralHash::SEED, StructuralHash::ofValue(values[node]));
+            hash = StructuralHash::mix(hash, endOfKey[node]);
+            for (uint32_t pos = childBegin[node]; pos < childBegin[node + 1]; pos++) {
+                hash = StructuralHash::mix(hash, canonical[childAt(pos)]);
+            }
+            Node match = NO_NODE;
+            auto range = table.equal_range(hash);
+            for (auto it = range.first; it != range.second && match == NO_NODE; ++it) {
+                Node k = it->second;
+                Node candidate = kept[k];
+                if (!(values[candidate] == values[node]) || endOfKey[candidate] != endOfKey[node] ||
+                    keptBegin[k + 1] - keptBegin[k] != getNumChildren(node)) {
+                    continue;
+                }
+                bool same = true;
+                for (uint32_t i = 0; same && i < getNumChildren(node); i++) {
+                    same = keptEdges[keptBegin[k] + i] == canonical[childAt(childBegin[node] + i)];
+                }
+                match = same ? k : NO_NODE;
+            }
+            if (match == NO_NODE) {
+                match = kept.size();
+                kept.push_back(node);
+                for (uint32_t pos = childBegin[node]; pos < childBegin[node + 1]; pos++) {
+                    keptEdges.push_back(canonical[childAt(pos)]);
+                }
+                keptBegin.push_back(keptEdges.size());
+                table.insert(std::make_pair(hash, match));
+            }
+            canonical[node] = match;
+        }
+
+        // The root was kept last; number the kept nodes in reverse so it becomes 0
+        // again and parents keep coming before their children.
+        Node numKept = kept.size();
+        std::vector<T> newValues;
+        std::vector<bool> newEndOfKey;
+        std::vector<uint32_t> newChildBegin;
+        std::vector<Node> newEdges;
+        newValues.reserve(numKept);
+        newEndOfKey.reserve(numKept);
+        newChildBegin.reserve(numKept + 1);
+        newEdges.reserve(keptEdges.size());
+        for (Node k = numKept; k-- > 0;) {
+            newValues.push_back(values[kept[k]]);
+            newEndOfKey.push_back(endOfKey[kept[k]]);
+            newChildBegin.push_back(newEdges.size());
+            for (uint32_t i = keptBegin[k]; i < keptBegin[k + 1]; i++) {
+                newEdges.push_back(numKept - 1 - keptEdges[i]);
+            }
+        }
+        newChildBegin.push_back(newEdges.size());
+
+        values.swap(newValues);
+        endOfKey.swap(newEndOfKey);
+        childBegin.swap(newChildBegin);
+        edges.swap(newEdges);
+        sortWideNodes(std::integral_constant<bool, ORDERED>());
+    }
+
+    /**
+     * Return the number of nodes, including the root (after minimize(), the number of
+     * distinct subtrees).
+     */
+    uint64_t size() const
+    {
+        return values.size();
+    }
+
+    /**
+     * Return the number of stored keys.
+     */
+    uint64_t getNumKeys() const
+    {
+        return numKeys;
+    }
+
+    /**
+     * Return the number of bytes taken up by the arrays of this FrozenTrie.
+     */
+    uint64_t memoryUsage() const
+    {
+        return sizeof(*this) + values.capacity() * sizeof(T) + childBegin.capacity() * sizeof(uint32_t) +
+            (endOfKey.capacity() + 7) / 8 + sortedChildren.capacity() * sizeof(uint32_t) +
+            edges.capacity() * sizeof(Node);
+    }
+
+    /**
+     * Return the root node.
+     */
+    Node getRoot() const
+    {
+        return 0;
+    }
+
+    /**
+     * Return the parent of the given node, or NO_NODE for the root. Parents are not
+     * stored; they are found by binary search over the child offsets. After
+     * minimize(), a node may have several parents; the lowest-numbered one is found
+     * by scanning the edges.
+     */
+    Node getParent(Node node) const
+    {
+        if (node == 0) {
+            return NO_NODE;
+        }
+        uint32_t pos = node;
+        if (!edges.empty()) {
+            pos = std::find(edges.begin(), edges.end(), node) - edges.begin();
+        }
+        return std::upper_bound(childBegin.begin(), childBegin.end(), pos) - childBegin.begin() - 1;
+    }
+
+    const T &getValue(Node node) const
+    {
+        return values[node];
+    }
+
+    bool isEndOfKey(Node node) const
+    {
+        return endOfKey[node];
+    }
+
+    uint32_t getNumChildren(Node node) const
+    {
+        return childBegin[node + 1] - childBegin[node];
+    }
+
+    /**
+     * Return the child at the specified index, or NO_NODE if the index is out of bounds.
+     */
+    Node getChildAtIndex(Node node, uint32_t index) const
+    {
+        return (index < getNumChildren(node)) ? childAt(childBegin[node] + index) : NO_NODE;
+    }
+
+    /**
+     * Return the child of node with the given value, or NO_NODE if there is none.
+     */
+    Node getChild(Node node, const T &value) const
+    {
+        if (getNumChildren(node) > LINEAR_MAX && !sortedChildren.empty()) {
+            return sortedFind(node, value, std::integral_constant<bool, ORDERED>());
+        }
+        for (uint32_t i = childBegin[node]; i < childBegin[node + 1]; i++) {
+            if (values[childAt(i)] == value) {
+                return childAt(i);
+            }
+        }
+        return NO_NODE;
+    }
+
+    /**
+     * Return the node at which the given key ends, or NO_NODE if the key was never
+     * inserted. Keys are relative to the root, as in TrieNode::find.
+     */
+    template<class Key> Node find(const Key &key) const
+    {
+        auto first = std::begin(key);
+        Node node = descend(first, std::end(key));
+        return (first != std::end(key) || !endOfKey[node]) ? NO_NODE : node;
+    }
+
+    /**
+     * Return true if the given key is a stored key or a prefix of one.
+     */
+    template<class Key> bool isPrefix(const Key &key) const
+    {
+        auto first = std::begin(key);
+        descend(first, std::end(key));
+        return first == std::end(key);
+    }
+
+    /**
+     * Call visit(key) with every stored key, in pre-order (the order in which
+     * TrieNode's display lists them). key holds the values below the root and is
+     * only valid during the call; it is one buffer, grown and shrunk as the walk
+     * goes down and up.
+     */
+    template<class Visitor> void forEachKey(Visitor visit) const
+    {
+        std::vector<T> key;
+        // (node, depth of node) pairs still to be visited.
+        std::vector<std::pair<Node, size_t> > pending(1, std::make_pair(Node(0), size_t(0)));
+        while (!pending.empty()) {
+            Node node = pending.back().first;
+            size_t depth = pending.back().second;
+            pending.pop_back();
+            key.resize(depth);
+            if (node != 0) {
+                key.push_back(values[node]);
+            }
+            if (endOfKey[node]) {
+                visit(static_cast<const std::vector<T> &>(key));
+            }
+            for (uint32_t i = childBegin[node + 1]; i-- > childBegin[node];) {
+                pending.push_back(std::make_pair(childAt(i), key.size()));
+            }
+        }
+    }
+};
+
+template<class T> const typename FrozenTrie<T>::Node FrozenTrie<T>::NO_NODE;
+
+#endif // SRC_FROZEN_TRIE_H
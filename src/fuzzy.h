@@ -0,0 +1,86 @@
+#ifndef SRC_FUZZY_H
+#define SRC_FUZZY_H
+
+/**
+ * Return every stored key within edit (Levenshtein) distance maxDistance of query,
+ * with its distance, in pre-order. An edit inserts, deletes or replaces one value;
+ * values are only compared with ==, so this works for any T (characters, int tokens,
+ * whole words...). Keys are relative to this TrieNode.
+ *
+ * The Trie is walked once, depth-first. Every node on the way gets one row of the
+ * usual edit distance table: entry j is the distance between the key spelled so far
+ * and the first j values of query, computed from its parent's row. Keys sharing a
+ * prefix share its rows. Entries never shrink going down, so once a row has nothing
+ * within maxDistance, the whole subtree below it is skipped. At depth i, entries
+ * further than maxDistance from column i are out of reach anyway, so only that band
+ * (2 * maxDistance + 1 entries) is computed, whatever the length of query.
+ */
+template<class T, class Traits> template<class Key>
+std::vector<std::pair<std::vector<T>, size_t> > TrieNode<T, Traits>::fuzzyFind(const Key &query, size_t maxDistance)
+{
+    std::vector<std::pair<std::vector<T>, size_t> > results;
+    const std::vector<T> target(std::begin(query), std::end(query));
+    const size_t width = target.size() + 1;
+    // Anything beyond maxDistance is stored as maxDistance + 1.
+    const size_t tooFar = maxDistance + 1;
+
+    // rows holds one row per depth on the current path, back to back (and only ever
+    // grows); key holds the values on the path.
+    std::vector<size_t> rows(width);
+    for (size_t j = 0; j < width; j++) {
+        rows[j] = std::min(j, tooFar);
+    }
+    std::vector<T> key;
+    if (endOfKey && rows[width - 1] <= maxDistance) {
+        results.push_back(std::make_pair(key, rows[width - 1]));
+    }
+
+    // (node, depth of node) pairs still to be visited.
+    std::vector<std::pair<TrieNode<T, Traits> *, size_t> > pending;
+    for (int i = getNumChildren(); i-- > 0;) {
+        pending.push_back(std::make_pair(children[i], size_t(1)));
+    }
+    while (!pending.empty()) {
+        TrieNode<T, Traits> *node = pending.back().first;
+        size_t depth = pending.back().second;
+        pending.pop_back();
+        key.resize(depth - 1);
+        key.push_back(node->value);
+        if (rows.size() < (depth + 1) * width) {
+            rows.resize((depth + 1) * width);
+        }
+
+        // Compute the band [low, high]; the entries just outside it are set to tooFar,
+        // since the next row reads them.
+        const size_t *previous = &rows[(depth - 1) * width];
+        size_t *row = &rows[depth * width];
+        size_t low = (depth > maxDistance) ? depth - maxDistance : 1;
+        size_t high = std::min(target.size(), depth + maxDistance);
+        row[0] = std::min(depth, tooFar);
+        if (low > 1 && low - 1 < width) {
+            row[low - 1] = tooFar;
+        }
+        if (high + 1 < width) {
+            row[high + 1] = tooFar;
+        }
+        size_t best = row[0];
+        for (size_t j = low; j <= high; j++) {
+            size_t replace = previous[j - 1] + (target[j - 1] == node->value ? 0 : 1);
+            row[j] = std::min(std::min(std::min(previous[j], row[j - 1]) + 1, replace), tooFar);
+            best = std::min(best, row[j]);
+        }
+        if (best > maxDistance) {
+            continue;
+        }
+        // The last entry is only in the band if the lengths are close enough.
+        if (node->endOfKey && high == target.size() && row[high] <= maxDistance) {
+            results.push_back(std::make_pair(key, row[high]));
+        }
+        for (int i = node->getNumChildren(); i-- > 0;) {
+            pending.push_back(std::make_pair(node->children[i], depth + 1));
+        }
+    }
+    return results;
+}
+
+#endif // SRC_FUZZY_H
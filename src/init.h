@@ -4,53 +4,138 @@
 /**
  * Default constructor
  */
-template<class T> TrieNode<T>::TrieNode() : parent(NULL) {}
+template<class T, class Traits> TrieNode<T, Traits>::TrieNode() : value(), endOfKey(false) {}
 
 /**
  * Initialize a TrieNode with the given value.
  */
-template<class T> TrieNode<T>::TrieNode(T val) : value(val), parent(NULL) {}
+template<class T, class Traits> TrieNode<T, Traits>::TrieNode(const T &val) : value(val), endOfKey(false) {}
+
+/**
+ * Same as above, except val is moved into this TrieNode rather than copied.
+ */
+template<class T, class Traits> TrieNode<T, Traits>::TrieNode(T &&val) : value(std::move(val)), endOfKey(false) {}
 
 /**
  * Initialize a TrieNode with the given value, and add this TrieNode as a child
  * to the given parent TrieNode reference.
  */
-template<class T> TrieNode<T>::TrieNode(TrieNode<T> *parentRef, T val) : value(val)
+template<class T, class Traits>
+TrieNode<T, Traits>::TrieNode(TrieNode<T, Traits> *parentRef, const T &val) : value(val), endOfKey(false)
 {
     // This TrieNode will be one of parentRef's children.
     parentRef->addChild(this);
 }
 
 /**
- * Return a reference to this TrieNode's parent.
+ * Same as above, except val is moved into this TrieNode rather than copied.
  */
-template<class T> TrieNode<T> * TrieNode<T>::getParent()
+template<class T, class Traits>
+TrieNode<T, Traits>::TrieNode(TrieNode<T, Traits> *parentRef, T &&val) : value(std::move(val)), endOfKey(false)
 {
-    return parent;
+    parentRef->addChild(this);
+}
+
+/**
+ * Return a reference to this TrieNode's parent. Only TrieNodes that keep one (see
+ * src/trieNodeTraits.h) have this method.
+ */
+template<class T, class Traits> TrieNode<T, Traits> * TrieNode<T, Traits>::getParent()
+{
+    static_assert(Traits::KEEP_PARENT, "getParent() needs Traits::KEEP_PARENT");
+    return this->parentLink();
 }
 
 /**
  * Set the parent of this TrieNode.
  */
-template<class T> void TrieNode<T>::setParent(TrieNode<T> *parent)
+template<class T, class Traits> void TrieNode<T, Traits>::setParent(TrieNode<T, Traits> *parent)
 {
-    this->parent = parent;
+    static_assert(Traits::KEEP_PARENT, "setParent() needs Traits::KEEP_PARENT");
+    this->linkParent(parent);
 }
 
 /**
- * Return this TrieNode's value.
+ * Return this TrieNode's value. The reference stays valid as long as this TrieNode
+ * does, but changes with setValue.
  */
-template<class T> T TrieNode<T>::getValue()
+template<class T, class Traits> const T &TrieNode<T, Traits>::getValue() const
 {
     return value;
 }
 
 /**
- * Set this TrieNode's value to the specified value.
+ * Set this TrieNode's value to the specified value, and re-index this TrieNode under
+ * it in its parent. Return false (and keep the old value) if the parent already has
+ * another child with the new value.
+ */
+template<class T, class Traits> bool TrieNode<T, Traits>::setValue(const T &value)
+{
+    return changeValue(value);
+}
+
+/**
+ * Same as above, except value is moved into this TrieNode rather than copied.
+ */
+template<class T, class Traits> bool TrieNode<T, Traits>::setValue(T &&value)
+{
+    return changeValue(std::move(value));
+}
+
+/**
+ * Helper method - used by setValue and assignment. The parent's child index maps
+ * values to positions (see src/childIndex.h), so this TrieNode is taken out of it
+ * under the old value and put back under the new one.
+ */
+template<class T, class Traits> template<class V> bool TrieNode<T, Traits>::changeValue(V &&value)
+{
+    TrieNode<T, Traits> *parent = this->parentLink();
+    int position = -1;
+    if (parent != NULL) {
+        TrieNode<T, Traits> *sibling = parent->findChild(value);
+        if (sibling != NULL && sibling != this) {
+            return false;
+        }
+        position = std::find(parent->children.begin(), parent->children.end(), this) - parent->children.begin();
+        if (position == parent->getNumChildren()) {
+            position = -1;
+        }
+    }
+    if (position != -1) {
+        parent->childIndex.removing(parent->children, position);
+    }
+    this->value = std::forward<V>(value);
+    if (position != -1) {
+        parent->childIndex.added(parent->children, position);
+    }
+    invalidateHash();
+    return true;
+}
+
+/**
+ * Return true if a key ends at this TrieNode (as opposed to this TrieNode only
+ * being a prefix of longer keys), false otherwise.
+ */
+template<class T, class Traits> bool TrieNode<T, Traits>::isEndOfKey()
+{
+    return endOfKey;
+}
+
+/**
+ * Mark/unmark this TrieNode as the end of a key.
  */
-template<class T> void TrieNode<T>::setValue(T value)
+template<class T, class Traits> void TrieNode<T, Traits>::setEndOfKey(bool endOfKey)
 {
-    this->value = value;
+    if (this->endOfKey != endOfKey) {
+        this->endOfKey = endOfKey;
+        adjustCounts(0, endOfKey ? 1 : -1);
+        if (endOfKey) {
+            raiseMaxWeight(this->keyWeight());
+        }
+        else {
+            refreshMaxWeight();
+        }
+    }
 }
 
 #endif // SRC_INIT_H
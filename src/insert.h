@@ -6,22 +6,51 @@
  * Save this TrieNode as the child's parent.But do nothing if the child value 
  * already exists.
  */
-template<class T> bool TrieNode<T>::addChild(TrieNode<T> *child)
+template<class T, class Traits> bool TrieNode<T, Traits>::addChild(TrieNode<T, Traits> *child)
 {
     // Duplicate children not allowed
-    if (child == NULL || hasChild(child)) {
+    if (child == NULL || findChild(child->value) != NULL) {
         return false;
     }
-    child->setParent(this);
-    children.push_back(child);
+    attachChild(child);
+    adjustCounts(child->countedNodes(), child->countedKeys());
+    raiseMaxWeight(child->bestWeight());
     return true;
 }
 
+/**
+ * Helper method - append child to this TrieNode's children without checking for
+ * duplicates or updating any counts; callers take care of both.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::attachChild(TrieNode<T, Traits> *child)
+{
+    child->linkParent(this);
+    children.push_back(child);
+    childIndex.pushed(children);
+}
+
+/**
+ * Helper method - move all of from's children to this TrieNode, which must not have
+ * any children yet. Both TrieNodes' own counts are updated, but not their ancestors'.
+ * The children and their index are swapped over as they are, so nothing is allocated.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::adoptChildren(TrieNode<T, Traits> &from)
+{
+    children.swap(from.children);
+    childIndex.swap(from.childIndex);
+    from.childIndex.cleared();
+    for (int i = 0; i < getNumChildren(); i++) {
+        children[i]->linkParent(this);
+    }
+    recount();
+    from.recount();
+}
+
 /**
  * Add the given Trie as a child to this Trie. Return a reference to 
  * the modified Trie.
  */
-template<class T> TrieNode<T> &TrieNode<T>::operator<<(TrieNode &child)
+template<class T, class Traits> TrieNode<T, Traits> &TrieNode<T, Traits>::operator<<(TrieNode &child)
 {
 	this->addChild(&child);
 	return *this;
@@ -30,14 +59,42 @@ template<class T> TrieNode<T> &TrieNode<T>::operator<<(TrieNode &child)
 /**
  * Same as operator<<, except value is wrapped into a new TrieNode first.
  */
-template<class T> TrieNode<T> &TrieNode<T>::operator<<(T value)
+template<class T, class Traits> TrieNode<T, Traits> &TrieNode<T, Traits>::operator<<(const T &value)
 {
-	TrieNode<T> *newChild = new TrieNode<T>(value);
-	// If insertion failed, delete newChild. 
-	if (!this->addChild(newChild)) {
-		delete newChild;
+	// Only allocate a node if the value is not a duplicate.
+	if (this->findChild(value) == NULL) {
+		this->addChild(this->createNode(value));
 	}
 	return *this;
 }
 
+/**
+ * Same as above, except value is moved into the new TrieNode rather than copied.
+ */
+template<class T, class Traits> TrieNode<T, Traits> &TrieNode<T, Traits>::operator<<(T &&value)
+{
+	if (this->findChild(value) == NULL) {
+		this->addChild(this->createNode(std::move(value)));
+	}
+	return *this;
+}
+
+/**
+ * Add a child whose value is constructed from args, and return it. The value is built
+ * once and moved into the new TrieNode. If there already is a child with that value,
+ * then nothing is added and that child is returned instead.
+ * Eg., words->emplaceChild(buffer, length);
+ */
+template<class T, class Traits> template<class... Args>
+TrieNode<T, Traits> *TrieNode<T, Traits>::emplaceChild(Args &&... args)
+{
+	T value(std::forward<Args>(args)...);
+	TrieNode<T, Traits> *child = this->findChild(value);
+	if (child == NULL) {
+		child = this->createNode(std::move(value));
+		this->addChild(child);
+	}
+	return child;
+}
+
 #endif // SRC_INSERT_H
@@ -0,0 +1,369 @@
+#ifndef SRC_ITERATOR_H
+#define SRC_ITERATOR_H
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <vector>
+
+#include "trieNodeTraits.h"
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Forward iterators over the TrieNodes of a subtree (pre-order, post-order and
+ *      level-order), and an input iterator over the keys stored in it, for range-for
+ *      loops and <algorithm>. See TrieNode::preOrder() and friends for the ranges.
+ *
+ * DETAILS:
+ *      The pre-order, post-order and key iterators find their way back up with the
+ *      parent pointers, and keep the position of every TrieNode on the current path
+ *      among its siblings, so moving on to the next sibling is one step, whatever
+ *      the children's values (even duplicates, see setChildAtIndex). Stepping only
+ *      allocates when the walk goes deeper than it has been before. Tries without
+ *      parent pointers (see src/trieNodeTraits.h) keep the path from the root as
+ *      well. Both live in the iterators' TrieAncestors.
+ *
+ *      The key iterator keeps the current key in one buffer, pushing a value when
+ *      the walk goes down and popping one when it goes up, so keys are never rebuilt
+ *      from scratch. Level order cannot be followed with parent pointers alone in
+ *      linear time, so that iterator keeps a queue of the nodes still to be visited.
+ *
+ *      The Trie must not be modified while it is being iterated over.
+ */
+template<class T, class Traits> struct TrieWalk
+{
+    typedef TrieNode<T, Traits> Node;
+    typedef TrieAncestors<Node, Traits::KEEP_PARENT> Ancestors;
+
+    /**
+     * Return the position of the first child of node at or after position, or the
+     * number of children if there is none.
+     */
+    static size_t childFrom(Node *node, size_t position)
+    {
+        while (position < node->children.size() && node->children[position] == NULL) {
+            position++;
+        }
+        return position;
+    }
+
+    /**
+     * Return node's first child, or NULL if it is a leaf.
+     */
+    static Node *firstChild(Node *node)
+    {
+        size_t position = childFrom(node, 0);
+        return (position < node->children.size()) ? node->children[position] : NULL;
+    }
+
+    /**
+     * Go down to node's first child and return it, or return NULL if it is a leaf.
+     */
+    static Node *descend(Node *node, Ancestors &ancestors)
+    {
+        size_t position = childFrom(node, 0);
+        if (position == node->children.size()) {
+            return NULL;
+        }
+        ancestors.descended(node, position);
+        return node->children[position];
+    }
+
+    /**
+     * Move on to the child that comes after the current node among parent's children
+     * and return it, or return NULL if the current node is the last one.
+     */
+    static Node *nextSibling(Node *parent, Ancestors &ancestors)
+    {
+        size_t position = childFrom(parent, ancestors.position() + 1);
+        if (position == parent->children.size()) {
+            return NULL;
+        }
+        ancestors.movedTo(position);
+        return parent->children[position];
+    }
+
+    /**
+     * Return the node after node in a pre-order walk of root's subtree, or NULL.
+     */
+    static Node *nextPreOrder(Node *root, Node *node, Ancestors &ancestors)
+    {
+        Node *child = descend(node, ancestors);
+        if (child != NULL) {
+            return child;
+        }
+        while (node != root) {
+            Node *parent = ancestors.parentOf(node);
+            Node *sibling = nextSibling(parent, ancestors);
+            if (sibling != NULL) {
+                return sibling;
+            }
+            ancestors.ascended();
+            node = parent;
+        }
+        return NULL;
+    }
+
+    /**
+     * Return the first node of a post-order walk of node's subtree.
+     */
+    static Node *firstPostOrder(Node *node, Ancestors &ancestors)
+    {
+        for (Node *child = descend(node, ancestors); child != NULL; child = descend(node, ancestors)) {
+            node = child;
+        }
+        return node;
+    }
+
+    /**
+     * Return the node after node in a post-order walk of root's subtree, or NULL.
+     */
+    static Node *nextPostOrder(Node *root, Node *node, Ancestors &ancestors)
+    {
+        if (node == root) {
+            return NULL;
+        }
+        Node *parent = ancestors.parentOf(node);
+        Node *sibling = nextSibling(parent, ancestors);
+        if (sibling != NULL) {
+            return firstPostOrder(sibling, ancestors);
+        }
+        ancestors.ascended();
+        return parent;
+    }
+};
+
+/**
+ * Pre-order: every TrieNode before its children, children in order.
+ */
+template<class T, class Traits = TrieNodeTraits> class TriePreOrderIterator :
+    private TrieWalk<T, Traits>::Ancestors
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef TrieNode<T, Traits> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef TrieNode<T, Traits> *pointer;
+    typedef TrieNode<T, Traits> &reference;
+
+    TriePreOrderIterator() : root(NULL), node(NULL) {}
+    TriePreOrderIterator(TrieNode<T, Traits> *root, TrieNode<T, Traits> *node) : root(root), node(node) {}
+
+    reference operator*() const { return *node; }
+    pointer operator->() const { return node; }
+
+    TriePreOrderIterator &operator++()
+    {
+        node = TrieWalk<T, Traits>::nextPreOrder(root, node, *this);
+        return *this;
+    }
+    TriePreOrderIterator operator++(int)
+    {
+        TriePreOrderIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const TriePreOrderIterator &other) const { return node == other.node; }
+    bool operator!=(const TriePreOrderIterator &other) const { return node != other.node; }
+
+private:
+    TrieNode<T, Traits> *root;
+    TrieNode<T, Traits> *node;      // NULL at the end
+};
+
+/**
+ * Post-order: every TrieNode after its children, children in order; the subtree's
+ * root comes last.
+ */
+template<class T, class Traits = TrieNodeTraits> class TriePostOrderIterator :
+    private TrieWalk<T, Traits>::Ancestors
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef TrieNode<T, Traits> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef TrieNode<T, Traits> *pointer;
+    typedef TrieNode<T, Traits> &reference;
+
+    TriePostOrderIterator() : root(NULL), node(NULL) {}
+    TriePostOrderIterator(TrieNode<T, Traits> *root, TrieNode<T, Traits> *node) : root(root), node(node) {}
+
+    /**
+     * Start at the first node of root's subtree.
+     */
+    explicit TriePostOrderIterator(TrieNode<T, Traits> *root) : root(root)
+    {
+        node = TrieWalk<T, Traits>::firstPostOrder(root, *this);
+    }
+
+    reference operator*() const { return *node; }
+    pointer operator->() const { return node; }
+
+    TriePostOrderIterator &operator++()
+    {
+        node = TrieWalk<T, Traits>::nextPostOrder(root, node, *this);
+        return *this;
+    }
+    TriePostOrderIterator operator++(int)
+    {
+        TriePostOrderIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const TriePostOrderIterator &other) const { return node == other.node; }
+    bool operator!=(const TriePostOrderIterator &other) const { return node != other.node; }
+
+private:
+    TrieNode<T, Traits> *root;
+    TrieNode<T, Traits> *node;      // NULL at the end
+};
+
+/**
+ * Level order: the subtree's root, then all TrieNodes one level below it, and so on;
+ * each level in pre-order. Copying the iterator copies its queue.
+ */
+template<class T, class Traits = TrieNodeTraits> class TrieLevelOrderIterator
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef TrieNode<T, Traits> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef TrieNode<T, Traits> *pointer;
+    typedef TrieNode<T, Traits> &reference;
+
+    TrieLevelOrderIterator() {}
+    explicit TrieLevelOrderIterator(TrieNode<T, Traits> *root) : pending(1, root) {}
+
+    reference operator*() const { return *pending.front(); }
+    pointer operator->() const { return pending.front(); }
+
+    TrieLevelOrderIterator &operator++()
+    {
+        TrieNode<T, Traits> *node = pending.front();
+        pending.pop_front();
+        for (size_t i = 0; i < node->children.size(); i++) {
+            if (node->children[i] != NULL) {
+                pending.push_back(node->children[i]);
+            }
+        }
+        return *this;
+    }
+    TrieLevelOrderIterator operator++(int)
+    {
+        TrieLevelOrderIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const TrieLevelOrderIterator &other) const { return current() == other.current(); }
+    bool operator!=(const TrieLevelOrderIterator &other) const { return current() != other.current(); }
+
+private:
+    std::deque<TrieNode<T, Traits> *> pending;      // the current node first; empty at the end
+
+    TrieNode<T, Traits> *current() const { return pending.empty() ? NULL : pending.front(); }
+};
+
+/**
+ * The keys stored in a subtree, in pre-order. Dereferencing gives the current key (a
+ * buffer owned by the iterator, valid until it moves on); getNode() gives the
+ * TrieNode at which it ends. Since the key lives in the iterator, this is only an
+ * input iterator: algorithms that hold on to a key (eg. std::max_element) must copy
+ * it first.
+ */
+template<class T, class Traits = TrieNodeTraits> class TrieKeyIterator :
+    private TrieWalk<T, Traits>::Ancestors
+{
+public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef std::vector<T> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const std::vector<T> *pointer;
+    typedef const std::vector<T> &reference;
+
+    TrieKeyIterator() : root(NULL), node(NULL) {}
+
+    /**
+     * Start at root, whose key is prefix; if root does not end a key itself, move on
+     * to the first one that does.
+     */
+    template<class Iter> TrieKeyIterator(TrieNode<T, Traits> *root, Iter firstPrefix, Iter lastPrefix) :
+        root(root), node(root), key(firstPrefix, lastPrefix)
+    {
+        if (node != NULL && !node->endOfKey) {
+            ++*this;
+        }
+    }
+
+    reference operator*() const { return key; }
+    pointer operator->() const { return &key; }
+    TrieNode<T, Traits> *getNode() const { return node; }
+
+    TrieKeyIterator &operator++()
+    {
+        do {
+            step();
+        } while (node != NULL && !node->endOfKey);
+        return *this;
+    }
+    TrieKeyIterator operator++(int)
+    {
+        TrieKeyIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const TrieKeyIterator &other) const { return node == other.node; }
+    bool operator!=(const TrieKeyIterator &other) const { return node != other.node; }
+
+private:
+    typedef TrieWalk<T, Traits> Walk;
+
+    TrieNode<T, Traits> *root;
+    TrieNode<T, Traits> *node;      // NULL at the end
+    std::vector<T> key;
+
+    // One pre-order step, keeping key in line with node.
+    void step()
+    {
+        TrieNode<T, Traits> *child = Walk::descend(node, *this);
+        if (child != NULL) {
+            key.push_back(child->value);
+            node = child;
+            return;
+        }
+        while (node != root) {
+            key.pop_back();
+            TrieNode<T, Traits> *parent = this->parentOf(node);
+            TrieNode<T, Traits> *sibling = Walk::nextSibling(parent, *this);
+            if (sibling != NULL) {
+                key.push_back(sibling->value);
+                node = sibling;
+                return;
+            }
+            this->ascended();
+            node = parent;
+        }
+        node = NULL;
+    }
+};
+
+/**
+ * A [begin, end) pair of iterators, for range-for.
+ */
+template<class Iter> class TrieRange
+{
+public:
+    TrieRange(Iter first, Iter last) : first(first), last(last) {}
+
+    Iter begin() const { return first; }
+    Iter end() const { return last; }
+
+private:
+    Iter first;
+    Iter last;
+};
+
+#endif // SRC_ITERATOR_H
@@ -0,0 +1,306 @@
+#ifndef SRC_MAPPED_TRIE_H
+#define SRC_MAPPED_TRIE_H
+
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trieFile.h"
+#include "trieNodeTraits.h"
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Read-only view of a Trie file written by TrieNode::serialize(). The file is
+ *      mapped into memory and searched in place - nothing is decoded or copied on
+ *      load, and pages are only read from disk as lookups touch them. Offers the same
+ *      read operations as FrozenTrie, with nodes numbered the same way.
+ *
+ * DETAILS:
+ *      open() checks the header against this build (format version, byte order and
+ *      the sizes of T and of a record). By default it also verifies the checksum and
+ *      that every child offset is in range, which reads the whole file once; pass
+ *      verify = false to skip that when the file is trusted. Children are found by a
+ *      linear scan over their (contiguous) records.
+ */
+template<class T> class MappedTrie
+{
+public:
+    typedef uint32_t Node;
+    static const Node NO_NODE = UINT32_MAX;
+
+private:
+    typedef TrieFileRecord<T> Record;
+
+    void *mapping;
+    size_t mappingSize;
+    const TrieFileHeader *header;
+    const Record *records;
+    uint32_t numNodes;
+
+    // No copying - the mapping is owned.
+    MappedTrie(const MappedTrie &);
+    MappedTrie &operator=(const MappedTrie &);
+
+    uint32_t childBegin(Node node) const
+    {
+        if (node == numNodes) {
+            return numNodes;
+        }
+        return records[node].childBegin & ~Record::END_OF_KEY;
+    }
+
+    bool headerIsValid(uint64_t fileSize) const
+    {
+        if (fileSize < TrieFileHeader::DATA_OFFSET ||
+            memcmp(header->magic, TrieFileHeader::expectedMagic(), sizeof(header->magic)) != 0) {
+            return false;
+        }
+        return header->version == TrieFileHeader::VERSION &&
+            header->byteOrder == TrieFileHeader::BYTE_ORDER_MARK &&
+            header->valueSize == sizeof(T) && header->recordSize == sizeof(Record) &&
+            header->numNodes >= 1 && header->numNodes < Record::END_OF_KEY &&
+            fileSize == TrieFileHeader::fileSize(header->numNodes, sizeof(Record));
+    }
+
+    bool contentsAreValid() const
+    {
+        TrieFileChecksum checksum;
+        size_t checkedSize = mappingSize - sizeof(uint64_t);
+        checksum.update(mapping, checkedSize);
+        uint64_t expected;
+        memcpy(&expected, static_cast<const char *>(mapping) + checkedSize, sizeof(expected));
+        if (checksum.value() != expected) {
+            return false;
+        }
+        // Breadth-first numbering: first children only ever move forwards, and every
+        // node but the root is somebody's child.
+        uint32_t previous = 1;
+        for (Node node = 0; node < numNodes; node++) {
+            uint32_t begin = childBegin(node);
+            if (begin < previous || begin > numNodes || begin <= node) {
+                return false;
+            }
+            previous = begin;
+        }
+        return true;
+    }
+
+    template<class Iter> Node descend(Iter &first, Iter last) const
+    {
+        Node current = 0;
+        for (; first != last; ++first) {
+            Node next = getChild(current, *first);
+            if (next == NO_NODE) {
+                break;
+            }
+            current = next;
+        }
+        return current;
+    }
+
+public:
+    MappedTrie() : mapping(NULL), mappingSize(0), header(NULL), records(NULL), numNodes(0)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be mapped");
+    }
+
+    ~MappedTrie()
+    {
+        close();
+    }
+
+    /**
+     * Map the Trie file at path. Return false (leaving this MappedTrie closed) if the
+     * file cannot be mapped, was not written for this T on this kind of machine, or -
+     * if verify is true - is corrupt.
+     */
+    bool open(const char *path, bool verify = true)
+    {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd == -1) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void *address = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        // The mapping stays valid once the descriptor is closed.
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            return false;
+        }
+        mapping = address;
+        mappingSize = info.st_size;
+        header = static_cast<const TrieFileHeader *>(mapping);
+        records = reinterpret_cast<const Record *>(static_cast<const char *>(mapping) + TrieFileHeader::DATA_OFFSET);
+
+        if (!headerIsValid(info.st_size)) {
+            close();
+            return false;
+        }
+        numNodes = header->numNodes;
+        if (verify && !contentsAreValid()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Unmap the file, if one is open.
+     */
+    void close()
+    {
+        if (mapping != NULL) {
+            munmap(mapping, mappingSize);
+        }
+        mapping = NULL;
+        mappingSize = 0;
+        header = NULL;
+        records = NULL;
+        numNodes = 0;
+    }
+
+    bool isOpen() const
+    {
+        return mapping != NULL;
+    }
+
+    /**
+     * Rebuild a TrieNode Trie from the mapped file; the result is == to the Trie that
+     * was serialized. See FrozenTrie::thaw().
+     */
+    TrieNode<T> *thaw() const
+    {
+        std::vector<TrieNode<T> *> nodes(numNodes);
+        for (Node node = 0; node < numNodes; node++) {
+            nodes[node] = new TrieNode<T>(records[node].value);
+            nodes[node]->endOfKey = isEndOfKey(node);
+        }
+        for (Node node = 0; node < numNodes; node++) {
+            TrieNode<T> *tn = nodes[node];
+            tn->children.assign(nodes.begin() + childBegin(node), nodes.begin() + childBegin(node + 1));
+            for (int i = 0; i < tn->getNumChildren(); i++) {
+                tn->children[i]->linkParent(tn);
+            }
+            tn->childIndex.rebuild(tn->children);
+        }
+        for (Node node = numNodes; node-- > 0;) {
+            nodes[node]->recount();
+        }
+        return nodes[0];
+    }
+
+    /**
+     * Return the number of nodes, including the root (0 if no file is open).
+     */
+    uint64_t size() const
+    {
+        return numNodes;
+    }
+
+    /**
+     * Return the number of stored keys.
+     */
+    uint64_t getNumKeys() const
+    {
+        return (header != NULL) ? header->numKeys : 0;
+    }
+
+    Node getRoot() const
+    {
+        return 0;
+    }
+
+    const T &getValue(Node node) const
+    {
+        return records[node].value;
+    }
+
+    bool isEndOfKey(Node node) const
+    {
+        return (records[node].childBegin & Record::END_OF_KEY) != 0;
+    }
+
+    uint32_t getNumChildren(Node node) const
+    {
+        return childBegin(node + 1) - childBegin(node);
+    }
+
+    /**
+     * Return the child at the specified index, or NO_NODE if the index is out of bounds.
+     */
+    Node getChildAtIndex(Node node, uint32_t index) const
+    {
+        return (index < getNumChildren(node)) ? childBegin(node) + index : NO_NODE;
+    }
+
+    /**
+     * Return the child of node with the given value, or NO_NODE if there is none.
+     */
+    Node getChild(Node node, const T &value) const
+    {
+        for (uint32_t i = childBegin(node), end = childBegin(node + 1); i < end; i++) {
+            if (records[i].value == value) {
+                return i;
+            }
+        }
+        return NO_NODE;
+    }
+
+    /**
+     * Return the node at which the given key ends, or NO_NODE if the key was never
+     * inserted.
+     */
+    template<class Key> Node find(const Key &key) const
+    {
+        auto first = std::begin(key);
+        Node node = descend(first, std::end(key));
+        return (first != std::end(key) || !isEndOfKey(node)) ? NO_NODE : node;
+    }
+
+    /**
+     * Return true if the given key is a stored key or a prefix of one.
+     */
+    template<class Key> bool isPrefix(const Key &key) const
+    {
+        auto first = std::begin(key);
+        descend(first, std::end(key));
+        return first == std::end(key);
+    }
+
+    /**
+     * Call visit(key) with every stored key, in pre-order. See FrozenTrie::forEachKey().
+     */
+    template<class Visitor> void forEachKey(Visitor visit) const
+    {
+        std::vector<T> key;
+        std::vector<std::pair<Node, size_t> > pending(1, std::make_pair(Node(0), size_t(0)));
+        while (!pending.empty()) {
+            Node node = pending.back().first;
+            size_t depth = pending.back().second;
+            pending.pop_back();
+            key.resize(depth);
+            if (node != 0) {
+                key.push_back(records[node].value);
+            }
+            if (isEndOfKey(node)) {
+                visit(static_cast<const std::vector<T> &>(key));
+            }
+            for (uint32_t i = childBegin(node + 1); i-- > childBegin(node);) {
+                pending.push_back(std::make_pair(Node(i), key.size()));
+            }
+        }
+    }
+};
+
+template<class T> const typename MappedTrie<T>::Node MappedTrie<T>::NO_NODE;
+
+#endif // SRC_MAPPED_TRIE_H
@@ -14,46 +14,178 @@
  *    Tmerged: { | [a, e]} -> a and e are united under a common parent.
  *             {a | [b, c, d]} {e | [f, g, h]}
  */
-template<class T> void TrieNode<T>::merge(TrieNode<T> &other)
+template<class T, class Traits> void TrieNode<T, Traits>::merge(TrieNode<T, Traits> &other)
 {
     // If this Trie and other have different root values, then
     if (this->getValue() != other.getValue()) {
         // Clone this TrieNode. Then, clear its list of children, and add
         // both the clone and other as children.
-        TrieNode<T> *clone = this->clone();
+        TrieNode<T, Traits> *clone = this->cloneInto(this->arenaLink());
         this->clear();
         this->addChild(clone);
-        this->addChild(other.clone()); // other.clone() since other itself should not be modified
+        this->addChild(other.cloneInto(this->arenaLink())); // clone since other itself should not be modified
         return;
     }
-    // If this Trie and other are equal, then do nothing.
-    if (this->equals(other)) {
+    mergeShared(other, false);
+}
+
+/**
+ * Same as merge, except that other's nodes are moved into this Trie rather than
+ * copied: subtrees of other that this Trie does not have are spliced in by pointer,
+ * and the rest of other is freed. other is left as a leaf.
+ *
+ * Nodes carved from an arena other than this Trie's cannot outlive that arena's
+ * root, so if other uses a different arena, its subtrees are copied instead.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::mergeMove(TrieNode<T, Traits> &other)
+{
+    if (&other == this) {
+        return;
+    }
+    bool splice = (other.arenaLink() == NULL || other.arenaLink() == this->arenaLink());
+
+    // Different root values: same result as in merge, but this TrieNode's children
+    // (and other's, if possible) are handed to the two new nodes instead of copied.
+    if (this->getValue() != other.getValue()) {
+        uint64_t oldSize = this->countedNodes(), oldKeys = this->countedKeys();
+        TrieNode<T, Traits> *thisCopy = createNode(value);
+        thisCopy->endOfKey = endOfKey;
+        thisCopy->adoptChildren(*this);
+
+        TrieNode<T, Traits> *otherCopy;
+        if (splice) {
+            uint64_t otherSize = other.countedNodes(), otherKeys = other.countedKeys();
+            otherCopy = createNode(other.value);
+            otherCopy->endOfKey = other.endOfKey;
+            otherCopy->adoptChildren(other);
+            if (other.parentLink() != NULL) {
+                other.parentLink()->adjustCounts((int64_t) other.countedNodes() - (int64_t) otherSize,
+                    (int64_t) other.countedKeys() - (int64_t) otherKeys);
+                other.parentLink()->refreshMaxWeight();
+            }
+        }
+        else {
+            otherCopy = other.cloneInto(this->arenaLink());
+            other.clear();
+        }
+        attachChild(thisCopy);
+        attachChild(otherCopy);
+        recount();
+        TrieNode<T, Traits> *parent = this->parentLink();
+        if (parent != NULL) {
+            parent->adjustCounts((int64_t) this->countedNodes() - (int64_t) oldSize,
+                (int64_t) this->countedKeys() - (int64_t) oldKeys);
+            parent->raiseMaxWeight(this->bestWeight());
+        }
         return;
     }
+    mergeShared(other, splice);
+}
+
+/**
+ * Helper method - merge other into this Trie, given that both roots have the same value.
+ * Pairs of nodes with the same value (one from each Trie) are walked with an explicit
+ * stack; only shared children are descended into, and everything else in other is
+ * either copied (splice == false) or moved by pointer (splice == true) in one step.
+ * Each node of both Tries is visited at most once, so this is linear in their sizes.
+ *
+ * Shared children whose subtrees are identical are left alone: if both already have
+ * a cached hash (see getHash) and the hashes match, the subtrees are compared with
+ * equals(), and if they are equal they are neither merged nor recounted. A hash match
+ * alone is never trusted, since different subtrees can collide. This is only tried
+ * where the hashes cover the values (T has std::hash) and are kept up to date by
+ * parent pointers (see src/trieNodeTraits.h). Comparing walks both subtrees, but
+ * reads them without allocating or recounting anything. Hashes are not computed
+ * here, as that would cost more than the merge saves when the Tries are mostly
+ * different.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::mergeShared(TrieNode<T, Traits> &other, bool splice)
+{
+    static const bool CHECK_HASHES = Traits::KEEP_PARENT && IsHashableValue<T>::value;
+    uint64_t oldSize = this->countedNodes(), oldKeys = this->countedKeys();
+    std::vector<std::pair<TrieNode<T, Traits> *, TrieNode<T, Traits> *> > pending;
+    std::vector<TrieNode<T, Traits> *> merged;      // nodes of this Trie that got merged into, parents first
+    std::vector<TrieNode<T, Traits> *> consumed;    // nodes of other left behind by splicing
+
+    pending.push_back(std::make_pair(this, &other));
+    while (!pending.empty()) {
+        TrieNode<T, Traits> *node = pending.back().first;
+        TrieNode<T, Traits> *otherNode = pending.back().second;
+        pending.pop_back();
+        merged.push_back(node);
 
-    // At this point, this->getValue() == other.getValue().
-    // So, iterate through other's children, and repeat merge for shared children.
-    // If a child is not shared, then do not invoke merge, but simply add it to this Trie.
-    for (int i = 0; i < other.getNumChildren(); i++) {
-        TrieNode<T> *otherChild = other.getChildAtIndex(i);
-        TrieNode<T> *otherChildClone = otherChild->clone();
-        // New child - add, don't merge
-        if (this->addChild(otherChildClone)) {
-            continue;
+        // A key that ends at otherNode also ends here after the merge.
+        node->mergeEndOfKey(*otherNode);
+
+        // Iterate through otherNode's children, and repeat merge for shared children.
+        // If a child is not shared, then do not merge, but simply add it to node.
+        for (int i = 0; i < otherNode->getNumChildren(); i++) {
+            TrieNode<T, Traits> *otherChild = otherNode->children[i];
+            TrieNode<T, Traits> *child = node->findChild(otherChild->value);
+            if (child == NULL) {
+                node->attachChild(splice ? otherChild : otherChild->cloneInto(node->arenaLink()));
+                continue;
+            }
+            if (CHECK_HASHES && child->cachedHash() != 0 && child->cachedHash() == otherChild->cachedHash() &&
+                child->equals(*otherChild)) {
+                // Nothing to add; a spliced-from subtree is simply freed.
+                if (splice) {
+                    otherChild->linkParent(NULL);
+                    delete otherChild;
+                }
+                continue;
+            }
+            pending.push_back(std::make_pair(child, otherChild));
+        }
+        if (splice && otherNode != &other) {
+            consumed.push_back(otherNode);
         }
-        delete otherChildClone;
-        // Shared child, so merge
-        (*this)[otherChild->getValue()]->merge(*otherChild);
     }
+
+    // Children were attached without updating counts along the way; fix them up
+    // children-first, then pass the overall change on to this TrieNode's ancestors.
+    for (size_t i = merged.size(); i-- > 0;) {
+        merged[i]->recount();
+    }
+    TrieNode<T, Traits> *parent = this->parentLink();
+    if (parent != NULL) {
+        parent->adjustCounts((int64_t) this->countedNodes() - (int64_t) oldSize,
+            (int64_t) this->countedKeys() - (int64_t) oldKeys);
+        parent->raiseMaxWeight(this->bestWeight());
+    }
+
+    if (!splice) {
+        return;
+    }
+    // Every child of the consumed nodes now either belongs to this Trie or is itself
+    // consumed, so they are freed on their own.
+    for (size_t i = 0; i < consumed.size(); i++) {
+        consumed[i]->children.clear();
+        consumed[i]->childIndex.cleared();
+        delete consumed[i];
+    }
+    other.children.clear();
+    other.childIndex.cleared();
+    other.adjustCounts(1 - (int64_t) other.countedNodes(),
+        (other.endOfKey ? 1 : 0) - (int64_t) other.countedKeys());
+    other.refreshMaxWeight();
 }
 
 /**
  * Merge this Trie with the given Trie.
  */
-template<class T> void TrieNode<T>::operator+=(TrieNode<T> &other)
+template<class T, class Traits> void TrieNode<T, Traits>::operator+=(TrieNode<T, Traits> &other)
 {
 	this->merge(other);
 }
 
-#endif // SRC_MERGE_H
+/**
+ * Merge the given Trie into this Trie, reusing its nodes. other is left as a leaf.
+ * Eg., *trie += std::move(*other);
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::operator+=(TrieNode<T, Traits> &&other)
+{
+	this->mergeMove(other);
+}
 
+#endif // SRC_MERGE_H
@@ -0,0 +1,168 @@
+#ifndef SRC_MOVE_H
+#define SRC_MOVE_H
+
+/**
+ * Copying and moving whole TrieNodes.
+ *
+ * A copy is a deep copy of the subtree: the new TrieNode has the same value, keys and
+ * weights, and its descendants come from the global heap. A move hands other's
+ * descendants over by pointer, the same way "+= std::move(other)" does, and moves
+ * other's value too unless other still sits in a parent (see takeValue): other keeps
+ * its end-of-key mark but is left as a leaf. Either way, the TrieNode being
+ * constructed or assigned to keeps its own place in the Trie (its parent, if any),
+ * and the two never share nodes.
+ *
+ * Moves steal other's children and their index rather than rebuilding them. They only
+ * copy where they have to - the value of a TrieNode that stays in its parent, and nodes
+ * carved from another TrieNode's arena - so they are noexcept whenever copying T cannot
+ * throw and there are no arenas (see NOTHROW_MOVE).
+ */
+
+/**
+ * Deep copy of other. The copy has no parent.
+ */
+template<class T, class Traits> TrieNode<T, Traits>::TrieNode(const TrieNode<T, Traits> &other)
+    : TrieParentLink<TrieNode<T, Traits>, Traits::KEEP_PARENT>(), TrieCountCache<Traits::CACHE_COUNTS>(),
+      TrieHashCache<Traits::CACHE_HASHES>(), TrieWeights<Traits::KEEP_WEIGHTS>(), TrieArenaLink<Arena, Traits::USE_ARENAS>(),
+      value(other.value), endOfKey(other.endOfKey)
+{
+    this->setKeyWeight(other.keyWeight());
+    copyChildren(other);
+    this->cacheHash(other.cachedHash());    // same structure, so the cached hash still holds
+}
+
+/**
+ * Take other's value, end-of-key mark, weight and descendants. other is left as a leaf.
+ * The new TrieNode has no parent.
+ */
+template<class T, class Traits> TrieNode<T, Traits>::TrieNode(TrieNode<T, Traits> &&other) noexcept(NOTHROW_MOVE)
+    : TrieParentLink<TrieNode<T, Traits>, Traits::KEEP_PARENT>(), TrieCountCache<Traits::CACHE_COUNTS>(),
+      TrieHashCache<Traits::CACHE_HASHES>(), TrieWeights<Traits::KEEP_WEIGHTS>(), TrieArenaLink<Arena, Traits::USE_ARENAS>(),
+      value(takeValue(other)), endOfKey(other.endOfKey)
+{
+    this->setKeyWeight(other.keyWeight());
+    takeSubtree(other);
+}
+
+/**
+ * Replace this TrieNode's value, end-of-key mark, weight and descendants with a deep
+ * copy of other's. Ancestors' counts are updated, and this TrieNode is re-indexed in
+ * its parent under its new value - unless the parent already has another child with
+ * that value, in which case this TrieNode keeps its own (as with setValue).
+ */
+template<class T, class Traits>
+TrieNode<T, Traits> &TrieNode<T, Traits>::operator=(const TrieNode<T, Traits> &other)
+{
+    if (&other != this) {
+        // Copy first: other may be one of this TrieNode's descendants.
+        TrieNode<T, Traits> copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+/**
+ * Same as above, except other's descendants are moved rather than copied, and other
+ * is left as a leaf (see the move constructor). other must not be one of this
+ * TrieNode's descendants or ancestors. If the parent already has another child with
+ * other's value, this TrieNode keeps its own value and other keeps its.
+ */
+template<class T, class Traits>
+TrieNode<T, Traits> &TrieNode<T, Traits>::operator=(TrieNode<T, Traits> &&other) noexcept(NOTHROW_MOVE)
+{
+    if (&other == this) {
+        return *this;
+    }
+    // Only move other's value out once it is certain to be taken (see changeValue).
+    TrieNode<T, Traits> *parent = this->parentLink();
+    TrieNode<T, Traits> *sibling = (parent == NULL) ? NULL : parent->findChild(other.value);
+    if (sibling == NULL || sibling == this) {
+        changeValue(takeValue(other));
+    }
+    uint64_t oldSize = this->countedNodes(), oldKeys = this->countedKeys();
+    endOfKey = other.endOfKey;
+    this->setKeyWeight(other.keyWeight());
+
+    // Set the old descendants aside, take other's, and only then free the old ones.
+    Children old;
+    old.swap(children);
+    childIndex.cleared();
+    takeSubtree(other);
+    for (size_t i = 0; i < old.size(); i++) {
+        delete old[i];
+    }
+
+    if (parent != NULL) {
+        parent->adjustCounts((int64_t) this->countedNodes() - (int64_t) oldSize,
+            (int64_t) this->countedKeys() - (int64_t) oldKeys);
+        parent->refreshMaxWeight();
+    }
+    return *this;
+}
+
+/**
+ * Helper method - return other's value, for a TrieNode that takes other's place. It is
+ * moved out of other if other has no parent, and copied otherwise: a parent finds its
+ * children by value (see src/childIndex.h), so other must keep its own. Without parent
+ * pointers there is no telling, so the value is always copied.
+ */
+template<class T, class Traits> T TrieNode<T, Traits>::takeValue(TrieNode<T, Traits> &other)
+{
+    if (Traits::KEEP_PARENT && other.parentLink() == NULL) {
+        return std::move(other.value);
+    }
+    return other.value;
+}
+
+/**
+ * Helper method - give this TrieNode, which must not have any children yet, a deep
+ * copy of from's descendants. Only this TrieNode's own counts are updated.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::copyChildren(const TrieNode<T, Traits> &from)
+{
+    children.reserve(from.children.size());
+    for (size_t i = 0; i < from.children.size(); i++) {
+        TrieNode<T, Traits> *childCopy = from.children[i]->cloneInto(this->arenaLink());
+        childCopy->linkParent(this);
+        children.push_back(childCopy);
+    }
+    childIndex.rebuild(children);
+    recount();
+}
+
+/**
+ * Helper method - move from's descendants to this TrieNode, which must not have any
+ * children yet. from's ancestors are updated, but not this TrieNode's.
+ *
+ * Like mergeMove, nodes are only spliced in by pointer if they will not outlive the
+ * arena they were carved from. If from owns its arena and this TrieNode has none, the
+ * arena is handed over along with the nodes. Otherwise, if the nodes come from an
+ * arena other than this TrieNode's, they are copied and from is cleared.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::takeSubtree(TrieNode<T, Traits> &from)
+{
+    uint64_t fromSize = from.countedNodes(), fromKeys = from.countedKeys();
+    Arena *fromArena = from.arenaLink();
+    if (fromArena != NULL && fromArena->getRoot() == &from && this->arenaLink() == NULL) {
+        this->linkArena(fromArena);
+        fromArena->setRoot(this);
+        from.linkArena(NULL);
+        adoptChildren(from);
+    }
+    else if (fromArena == NULL || fromArena == this->arenaLink()) {
+        adoptChildren(from);
+    }
+    else {
+        copyChildren(from);
+        from.clear();
+        return;
+    }
+    // Unlike clear(), adoptChildren leaves from's ancestors alone.
+    if (from.parentLink() != NULL) {
+        from.parentLink()->adjustCounts((int64_t) from.countedNodes() - (int64_t) fromSize,
+            (int64_t) from.countedKeys() - (int64_t) fromKeys);
+        from.parentLink()->refreshMaxWeight();
+    }
+}
+
+#endif // SRC_MOVE_H
@@ -0,0 +1,189 @@
+#ifndef SRC_PARALLEL_MERGE_H
+#define SRC_PARALLEL_MERGE_H
+
+#include <algorithm>
+
+/**
+ * State shared by all tasks of one mergeAll: the pool they run on, and - per worker,
+ * so no locking is needed - the nodes whose children changed, with their depth.
+ */
+template<class Node> struct ParallelMergeState
+{
+    // Groups covering fewer nodes than this are merged by the task that found them
+    // instead of being handed to the pool.
+    static const uint64_t SPAWN_THRESHOLD = 2048;
+
+    WorkStealingPool &pool;
+    std::vector<std::vector<std::pair<size_t, Node *> > > touched;
+
+    ParallelMergeState(WorkStealingPool &p) : pool(p), touched(p.size()) {}
+};
+
+/**
+ * Merge every Trie in others into this Trie, using numThreads threads (one per hardware
+ * thread if 0). others are left untouched. The result is identical (==) to merging
+ * them one at a time, in order, with "+=".
+ *
+ * All Tries with the same root value as this one are merged in a single pass: at each
+ * level, the children of every Trie are grouped by value, and groups are merged into
+ * the corresponding child of this Trie independently - on a work-stealing pool, since
+ * distinct children never share any nodes. Tries with a different root value are
+ * merged in sequence, as "+=" would.
+ */
+template<class T, class Traits>
+void TrieNode<T, Traits>::mergeAll(const std::vector<TrieNode<T, Traits> *> &others, unsigned numThreads)
+{
+    std::vector<TrieNode<T, Traits> *> batch;
+    for (size_t i = 0; i <= others.size(); i++) {
+        if (i < others.size() && others[i]->value == value) {
+            // Merging a Trie into itself changes nothing.
+            if (others[i] != this) {
+                batch.push_back(others[i]);
+            }
+            continue;
+        }
+        if (!batch.empty()) {
+            parallelMerge(batch, numThreads);
+            batch.clear();
+        }
+        if (i < others.size()) {
+            merge(*others[i]);
+        }
+    }
+}
+
+/**
+ * Helper method - merge sources (whose roots all have this TrieNode's value) into this
+ * Trie on a new pool of numThreads workers.
+ */
+template<class T, class Traits>
+void TrieNode<T, Traits>::parallelMerge(const std::vector<TrieNode<T, Traits> *> &sources, unsigned numThreads)
+{
+    uint64_t oldSize = this->countedNodes(), oldKeys = this->countedKeys();
+    WorkStealingPool pool(numThreads);
+    ParallelMergeState<TrieNode<T, Traits> > state(pool);
+
+    // New nodes may now be carved from this Trie's arena by several workers at once.
+    if (this->arenaLink() != NULL) {
+        this->arenaLink()->setShared(true);
+    }
+    TrieNode<T, Traits> *root = this;
+    pool.submit([root, &state, &sources](unsigned worker) {
+        root->mergeGroup(state, sources, 0, worker);
+    });
+    pool.wait();
+    if (this->arenaLink() != NULL) {
+        this->arenaLink()->setShared(false);
+    }
+
+    // Children were attached without updating counts; fix them up deepest-first, so
+    // that every node is recounted after all of its children.
+    std::vector<std::pair<size_t, TrieNode<T, Traits> *> > touched;
+    for (size_t i = 0; i < state.touched.size(); i++) {
+        touched.insert(touched.end(), state.touched[i].begin(), state.touched[i].end());
+    }
+    std::sort(touched.begin(), touched.end());
+    for (size_t i = touched.size(); i-- > 0;) {
+        touched[i].second->recount();
+    }
+    TrieNode<T, Traits> *parent = this->parentLink();
+    if (parent != NULL) {
+        parent->adjustCounts((int64_t) this->countedNodes() - (int64_t) oldSize,
+            (int64_t) this->countedKeys() - (int64_t) oldKeys);
+        parent->raiseMaxWeight(this->bestWeight());
+    }
+}
+
+/**
+ * Helper method - merge sources (nodes of other Tries, all with this TrieNode's value)
+ * into this TrieNode. Runs as one task on the pool; only this task ever touches this
+ * TrieNode and the nodes it creates below it. Large groups of shared children become
+ * new tasks, small ones are merged right here, with an explicit stack.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::mergeGroup(ParallelMergeState<TrieNode<T, Traits> > &state,
+    const std::vector<TrieNode<T, Traits> *> &sources, size_t depth, unsigned worker)
+{
+    struct Group
+    {
+        TrieNode<T, Traits> *node;
+        std::vector<TrieNode<T, Traits> *> sources;
+        size_t depth;
+    };
+    std::vector<Group> pending(1);
+    pending[0].node = this;
+    pending[0].sources = sources;
+    pending[0].depth = depth;
+
+    while (!pending.empty()) {
+        Group group;
+        std::swap(group, pending.back());
+        pending.pop_back();
+        TrieNode<T, Traits> *node = group.node;
+        state.touched[worker].push_back(std::make_pair(group.depth, node));
+
+        // A key that ends at any of the sources also ends here after the merge.
+        for (size_t i = 0; i < group.sources.size(); i++) {
+            node->mergeEndOfKey(*group.sources[i]);
+        }
+
+        // Nothing to merge with: just copy the source's children.
+        if (!node->hasChildren() && group.sources.size() == 1) {
+            TrieNode<T, Traits> *source = group.sources[0];
+            for (int i = 0; i < source->getNumChildren(); i++) {
+                node->attachChild(source->children[i]->cloneInto(node->arenaLink()));
+            }
+            continue;
+        }
+
+        // Group the sources' children by value. A value this TrieNode does not have yet
+        // gets a new (empty) child, in the order in which the values are first seen -
+        // the same order in which merging the sources one by one would add them.
+        std::vector<std::vector<TrieNode<T, Traits> *> > groups(node->getNumChildren());
+        for (size_t i = 0; i < group.sources.size(); i++) {
+            TrieNode<T, Traits> *source = group.sources[i];
+            for (int j = 0; j < source->getNumChildren(); j++) {
+                TrieNode<T, Traits> *sourceChild = source->children[j];
+                int position = node->indexOfChild(sourceChild->value);
+                if (position == -1) {
+                    node->attachChild(node->createNode(sourceChild->value));
+                    position = node->getNumChildren() - 1;
+                    groups.push_back(std::vector<TrieNode<T, Traits> *>());
+                }
+                groups[position].push_back(sourceChild);
+            }
+        }
+
+        for (size_t i = 0; i < groups.size(); i++) {
+            if (groups[i].empty()) {
+                continue;
+            }
+            // Without cached counts, the size of the work is unknown; only the
+            // children of the root are handed out then.
+            TrieNode<T, Traits> *child = node->children[i];
+            const uint64_t SPAWN_THRESHOLD = ParallelMergeState<TrieNode<T, Traits> >::SPAWN_THRESHOLD;
+            uint64_t work = child->countedNodes();
+            for (size_t j = 0; j < groups[i].size(); j++) {
+                work += groups[i][j]->countedNodes();
+            }
+            if (!Traits::CACHE_COUNTS && group.depth == 0) {
+                work = SPAWN_THRESHOLD;
+            }
+            if (work >= SPAWN_THRESHOLD) {
+                std::vector<TrieNode<T, Traits> *> childSources;
+                childSources.swap(groups[i]);
+                size_t childDepth = group.depth + 1;
+                ParallelMergeState<TrieNode<T, Traits> > *sharedState = &state;
+                state.pool.submit([child, sharedState, childSources, childDepth](unsigned w) {
+                    child->mergeGroup(*sharedState, childSources, childDepth, w);
+                });
+                continue;
+            }
+            pending.push_back(Group());
+            pending.back().node = child;
+            pending.back().sources.swap(groups[i]);
+            pending.back().depth = group.depth + 1;
+        }
+    }
+}
+
+#endif // SRC_PARALLEL_MERGE_H
@@ -0,0 +1,164 @@
+#ifndef SRC_PATH_H
+#define SRC_PATH_H
+
+/**
+ * Path operations work on whole keys - sequences of values - instead of one level
+ * at a time. A key is spelled by the values of the nodes *below* this TrieNode, so
+ * this TrieNode stands for the empty key. Eg., after root.insert(std::string("ab")):
+ *     root
+ *    ======
+ *      a
+ *    ======
+ *      b   -> isEndOfKey() == true
+ *
+ * Every operation is a single iterative walk down the Trie; no temporary nodes are
+ * created and values are compared in place.
+ */
+
+/**
+ * Helper method - follow [first, last) down from this TrieNode for as long as
+ * matching children exist. Return the deepest node reached; first is left pointing
+ * at the first value that could not be matched (or at last if all of them were).
+ */
+template<class T, class Traits> template<class Iter>
+TrieNode<T, Traits> *TrieNode<T, Traits>::descend(Iter &first, Iter last)
+{
+    TrieNode<T, Traits> *current = this;
+    for (; first != last; ++first) {
+        TrieNode<T, Traits> *next = current->findChild(*first);
+        if (next == NULL) {
+            break;
+        }
+        current = next;
+    }
+    return current;
+}
+
+/**
+ * Insert the key [first, last) below this TrieNode, creating only the nodes that
+ * do not exist yet, and mark its last node as the end of a key. Return that node.
+ * A new key weighs whatever was set on that node with setWeight (0 if nothing was).
+ */
+template<class T, class Traits> template<class Iter>
+TrieNode<T, Traits> *TrieNode<T, Traits>::insert(Iter first, Iter last)
+{
+    TRIE_COUNT(Traits::COUNT_OPERATIONS, inserts, 1);
+    Iter path = first;
+    TrieNode<T, Traits> *current = descend(first, last);
+    TrieNode<T, Traits> *attachedTo = current;
+
+    // Whatever is left of the key is new, so there is no need to check for duplicates.
+    int64_t numCreated = 0;
+    for (; first != last; ++first) {
+        TrieNode<T, Traits> *newChild = current->createNode(*first);
+        newChild->linkParent(current);
+        current->children.push_back(newChild);
+        current->childIndex.pushed(current->children);
+        current = newChild;
+        numCreated++;
+    }
+    int64_t keyAdded = current->endOfKey ? 0 : 1;
+    current->endOfKey = true;
+
+    // The new nodes form a chain (each one the last child of the one above), so
+    // their counts are known.
+    TrieNode<T, Traits> *node = attachedTo;
+    for (int64_t i = numCreated; i >= 1; i--) {
+        node = node->children.back();
+        node->setCounts(i, keyAdded);
+        node->setBestWeight(current->keyWeight());
+    }
+
+    // Everything from the node the chain hangs off upwards is adjusted in one pass.
+    // Without parent pointers, that pass stops at each node, so the path from this
+    // TrieNode down to attachedTo is followed again instead.
+    node = Traits::KEEP_PARENT ? attachedTo : this;
+    while (true) {
+        node->adjustCounts(numCreated, keyAdded);
+        node->raiseMaxWeight(current->keyWeight());
+        if (node == attachedTo) {
+            break;
+        }
+        node = node->findChild(*path);
+        ++path;
+    }
+    return current;
+}
+
+/**
+ * Insert the given key (any container of T, eg. std::string for TrieNode<char>).
+ */
+template<class T, class Traits> template<class Key> TrieNode<T, Traits> *TrieNode<T, Traits>::insert(const Key &key)
+{
+    return insert(std::begin(key), std::end(key));
+}
+
+/**
+ * Return the node at which the given key ends, or NULL if the key was never inserted
+ * (including when it only exists as a prefix of longer keys).
+ */
+template<class T, class Traits> template<class Key> TrieNode<T, Traits> *TrieNode<T, Traits>::find(const Key &key)
+{
+    TRIE_COUNT(Traits::COUNT_OPERATIONS, lookups, 1);
+    auto first = std::begin(key);
+    TrieNode<T, Traits> *node = descend(first, std::end(key));
+    if (first != std::end(key) || !node->endOfKey) {
+        TRIE_COUNT(Traits::COUNT_OPERATIONS, misses, 1);
+        return NULL;
+    }
+    return node;
+}
+
+/**
+ * Return true if the given key is a path in this Trie, ie. if it is a stored key or
+ * a prefix of one, false otherwise.
+ */
+template<class T, class Traits> template<class Key> bool TrieNode<T, Traits>::isPrefix(const Key &key)
+{
+    auto first = std::begin(key);
+    descend(first, std::end(key));
+    return first == std::end(key);
+}
+
+/**
+ * Return the node at which the longest stored key that is a prefix of the given key
+ * ends, or NULL if there is no such key. If length is not NULL, the number of values
+ * in that stored key is written to it.
+ */
+template<class T, class Traits> template<class Key>
+TrieNode<T, Traits> *TrieNode<T, Traits>::longestPrefix(const Key &key, size_t *length)
+{
+    TrieNode<T, Traits> *current = this;
+    TrieNode<T, Traits> *match = endOfKey ? this : NULL;
+    size_t depth = 0, matchDepth = 0;
+
+    auto first = std::begin(key), last = std::end(key);
+    for (; first != last; ++first) {
+        current = current->findChild(*first);
+        if (current == NULL) {
+            break;
+        }
+        depth++;
+        if (current->endOfKey) {
+            match = current;
+            matchDepth = depth;
+        }
+    }
+    if (length != NULL) {
+        *length = matchDepth;
+    }
+    return match;
+}
+
+/**
+ * Return the number of stored keys that start with the given prefix (including the
+ * prefix itself, if it is a key). O(length of prefix).
+ */
+template<class T, class Traits> template<class Key> uint64_t TrieNode<T, Traits>::countKeysWithPrefix(const Key &prefix)
+{
+    auto first = std::begin(prefix);
+    TrieNode<T, Traits> *node = descend(first, std::end(prefix));
+    return (first == std::end(prefix)) ? node->getNumKeys() : 0;
+}
+
+#endif // SRC_PATH_H
@@ -0,0 +1,431 @@
+#ifndef SRC_PERSISTENT_TRIE_H
+#define SRC_PERSISTENT_TRIE_H
+
+#include <atomic>
+#include <unordered_set>
+#include <vector>
+#include <stdint.h>
+
+#include "childIndex.h"
+#include "trieNodeTraits.h"
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Persistent (copy-on-write) Trie. Copying a PersistentTrie - or calling
+ *      clone() - is O(1): both copies share every node. Changing one of them copies
+ *      only the nodes on the path from the root to the key being changed; all other
+ *      nodes stay shared with the older versions.
+ *
+ * DETAILS:
+ *      Nodes are reference-counted; a node's count is the number of parents (and
+ *      PersistentTrie handles) pointing at it. A node with a count of 1 whose parent is
+ *      not shared either belongs to this version alone, so it is changed in place;
+ *      otherwise it is copied first, which shares (and counts) its children in turn.
+ *      Since nodes have several parents, there are no parent pointers.
+ *
+ *      Counts are atomic, so versions may be handed to other threads: any number of
+ *      threads may read and release their own versions while another thread changes
+ *      its version. A single version must not be changed by two threads at once, nor
+ *      read while it is being changed. A node is freed when the last version that
+ *      contains it is released.
+ */
+template<class T> class PersistentTrie
+{
+public:
+    struct Node
+    {
+        T value;
+        bool endOfKey;
+        uint64_t subtreeSize;   // Nodes in this subtree, including this one
+        uint64_t numKeys;       // end-of-key Nodes in this subtree, including this one
+        std::vector<Node *> children;
+        ChildIndex<T, Node> childIndex;
+        std::atomic<uint32_t> refs;
+
+        Node(const T &value) : value(value), endOfKey(false), subtreeSize(1), numKeys(0), refs(1) {}
+
+        // Copy of a node about to be changed: shares (and counts) the original's children.
+        Node(const Node &other) : value(other.value), endOfKey(other.endOfKey),
+            subtreeSize(other.subtreeSize), numKeys(other.numKeys), children(other.children),
+            childIndex(other.childIndex), refs(1)
+        {
+            for (size_t i = 0; i < children.size(); i++) {
+                children[i]->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    };
+
+private:
+    Node *root;
+
+    /**
+     * Drop one reference to node, freeing it - and, in turn, every child that it held
+     * the last reference to - once nobody refers to it any more.
+     */
+    static void release(Node *node)
+    {
+        std::vector<Node *> pending(1, node);
+        while (!pending.empty()) {
+            Node *current = pending.back();
+            pending.pop_back();
+            if (current->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                pending.insert(pending.end(), current->children.begin(), current->children.end());
+                delete current;
+            }
+        }
+    }
+
+    /**
+     * Make the node in slot private to this version (copying it if it is shared) and
+     * return it. Only called for slots whose owner is already private.
+     */
+    static Node *makePrivate(Node *&slot)
+    {
+        if (slot->refs.load(std::memory_order_acquire) == 1) {
+            return slot;
+        }
+        Node *copy = new Node(*slot);
+        release(slot);
+        slot = copy;
+        return copy;
+    }
+
+    static Node *findChild(const Node *node, const T &value)
+    {
+        int index = node->childIndex.find(node->children, value);
+        return (index == -1) ? NULL : node->children[index];
+    }
+
+    // Follow [first, last) down from the root for as long as it matches; same
+    // contract as TrieNode::descend.
+    template<class Iter> const Node *descend(Iter &first, Iter last) const
+    {
+        const Node *current = root;
+        for (; first != last; ++first) {
+            const Node *next = findChild(current, *first);
+            if (next == NULL) {
+                break;
+            }
+            current = next;
+        }
+        return current;
+    }
+
+public:
+    /**
+     * Create an empty Trie whose root has the given value.
+     */
+    explicit PersistentTrie(const T &rootValue = T()) : root(new Node(rootValue)) {}
+
+    /**
+     * Copy the given Trie into a new PersistentTrie. See also thaw().
+     */
+    template<class Traits> explicit PersistentTrie(TrieNode<T, Traits> &trie) : root(new Node(trie.getValue()))
+    {
+        std::vector<std::pair<TrieNode<T, Traits> *, Node *> > pending(1, std::make_pair(&trie, root));
+        while (!pending.empty()) {
+            TrieNode<T, Traits> *original = pending.back().first;
+            Node *copy = pending.back().second;
+            pending.pop_back();
+
+            copy->endOfKey = original->isEndOfKey();
+            copy->subtreeSize = original->size();
+            copy->numKeys = original->getNumKeys();
+            copy->children.reserve(original->getNumChildren());
+            for (int i = 0; i < original->getNumChildren(); i++) {
+                TrieNode<T, Traits> *child = original->getChildAtIndex(i);
+                copy->children.push_back(new Node(child->getValue()));
+                pending.push_back(std::make_pair(child, copy->children.back()));
+            }
+            copy->childIndex.rebuild(copy->children);
+        }
+    }
+
+    /**
+     * Snapshot of other, in O(1): the two share all of their nodes until one of them
+     * is changed.
+     */
+    PersistentTrie(const PersistentTrie &other) : root(other.root)
+    {
+        root->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    PersistentTrie &operator=(const PersistentTrie &other)
+    {
+        if (root != other.root) {
+            other.root->refs.fetch_add(1, std::memory_order_relaxed);
+            release(root);
+            root = other.root;
+        }
+        return *this;
+    }
+
+    /**
+     * Release this version. Nodes that no other version shares are freed.
+     */
+    ~PersistentTrie()
+    {
+        release(root);
+    }
+
+    /**
+     * Return a new snapshot of this Trie, in O(1).
+     */
+    PersistentTrie *clone() const
+    {
+        return new PersistentTrie(*this);
+    }
+
+    /**
+     * Rebuild a TrieNode Trie from this version; the result is == to a TrieNode Trie
+     * with the same keys inserted in the same order.
+     */
+    TrieNode<T> *thaw() const
+    {
+        TrieNode<T> *newRoot = new TrieNode<T>(root->value);
+        std::vector<std::pair<const Node *, TrieNode<T> *> > pending(1, std::make_pair(root, newRoot));
+        while (!pending.empty()) {
+            const Node *original = pending.back().first;
+            TrieNode<T> *copy = pending.back().second;
+            pending.pop_back();
+
+            copy->endOfKey = original->endOfKey;
+            copy->setCounts(original->subtreeSize, original->numKeys);
+            copy->children.reserve(original->children.size());
+            for (size_t i = 0; i < original->children.size(); i++) {
+                TrieNode<T> *childCopy = new TrieNode<T>(original->children[i]->value);
+                childCopy->linkParent(copy);
+                copy->children.push_back(childCopy);
+                pending.push_back(std::make_pair(original->children[i], childCopy));
+            }
+            copy->childIndex.rebuild(copy->children);
+        }
+        return newRoot;
+    }
+
+    const T &getValue() const
+    {
+        return root->value;
+    }
+
+    /**
+     * Return the number of nodes in this version, including the root. O(1).
+     */
+    uint64_t size() const
+    {
+        return root->subtreeSize;
+    }
+
+    /**
+     * Return the number of keys stored in this version. O(1).
+     */
+    uint64_t getNumKeys() const
+    {
+        return root->numKeys;
+    }
+
+    /**
+     * Return the number of nodes of this version that other shares. Eg. a snapshot
+     * that has since had one key of length n inserted shares all but at most n + 1 of
+     * the nodes of the version it was taken from.
+     */
+    uint64_t countSharedNodes(const PersistentTrie &other) const
+    {
+        std::unordered_set<const Node *> otherNodes;
+        std::vector<const Node *> pending(1, other.root);
+        while (!pending.empty()) {
+            const Node *node = pending.back();
+            pending.pop_back();
+            // A shared subtree has been seen in full already.
+            if (otherNodes.insert(node).second) {
+                pending.insert(pending.end(), node->children.begin(), node->children.end());
+            }
+        }
+        uint64_t numShared = 0;
+        pending.assign(1, root);
+        while (!pending.empty()) {
+            const Node *node = pending.back();
+            pending.pop_back();
+            if (otherNodes.count(node) != 0) {
+                numShared += node->subtreeSize;
+                continue;
+            }
+            pending.insert(pending.end(), node->children.begin(), node->children.end());
+        }
+        return numShared;
+    }
+
+    /**
+     * Insert the given key (any container of T) into this version, copying only the
+     * nodes on its path that are shared with other versions. Return true if the key
+     * was added, false if it was already stored (in which case nothing is copied).
+     */
+    template<class Key> bool insert(const Key &key)
+    {
+        auto first = std::begin(key), last = std::end(key);
+        const Node *existing = descend(first, last);
+        if (first == last && existing->endOfKey) {
+            return false;
+        }
+
+        // Copy the part of the path that already exists, then hang the rest below it.
+        auto value = std::begin(key);
+        std::vector<Node *> path(1, makePrivate(root));
+        for (; value != first; ++value) {
+            Node *node = path.back();
+            int index = node->childIndex.find(node->children, *value);
+            path.push_back(makePrivate(node->children[index]));
+        }
+        size_t numExisting = path.size();
+        for (; value != last; ++value) {
+            Node *node = path.back();
+            node->children.push_back(new Node(*value));
+            node->childIndex.pushed(node->children);
+            path.push_back(node->children.back());
+        }
+        path.back()->endOfKey = true;
+
+        uint64_t numCreated = path.size() - numExisting;
+        for (size_t i = 0; i < path.size(); i++) {
+            path[i]->numKeys++;
+            path[i]->subtreeSize = (i < numExisting) ? path[i]->subtreeSize + numCreated : path.size() - i;
+        }
+        return true;
+    }
+
+    /**
+     * Remove the given key from this version, copying only the nodes on its path that
+     * are shared with other versions. Nodes left without any key below them are
+     * dropped rather than copied. Return true if the key was removed, false if it was
+     * not stored.
+     */
+    template<class Key> bool remove(const Key &key)
+    {
+        if (!contains(key)) {
+            return false;
+        }
+        // Find the nodes along the key without changing anything yet. Those from top
+        // down only lead to this key, so they go.
+        std::vector<const Node *> nodes(1, root);
+        for (auto value = std::begin(key); value != std::end(key); ++value) {
+            nodes.push_back(findChild(nodes.back(), *value));
+        }
+        size_t top = nodes.size();
+        while (top > 1 && nodes[top - 1]->numKeys == 1) {
+            top--;
+        }
+
+        std::vector<Node *> path(1, makePrivate(root));
+        auto value = std::begin(key);
+        for (size_t depth = 1; depth < top; depth++, ++value) {
+            Node *node = path.back();
+            int index = node->childIndex.find(node->children, *value);
+            path.push_back(makePrivate(node->children[index]));
+        }
+
+        uint64_t numDropped = 0;
+        if (top < nodes.size()) {
+            Node *parent = path.back();
+            int index = parent->childIndex.find(parent->children, *value);
+            Node *dropped = parent->children[index];
+            numDropped = dropped->subtreeSize;
+            parent->children.erase(parent->children.begin() + index);
+            parent->childIndex.erased(parent->children, index, *value);
+            release(dropped);
+        }
+        else {
+            path.back()->endOfKey = false;
+        }
+        for (size_t i = 0; i < path.size(); i++) {
+            path[i]->numKeys--;
+            path[i]->subtreeSize -= numDropped;
+        }
+        return true;
+    }
+
+    /**
+     * Return true if the given key is stored in this version.
+     */
+    template<class Key> bool contains(const Key &key) const
+    {
+        auto first = std::begin(key);
+        const Node *node = descend(first, std::end(key));
+        return first == std::end(key) && node->endOfKey;
+    }
+
+    /**
+     * Return true if the given key is a stored key or a prefix of one.
+     */
+    template<class Key> bool isPrefix(const Key &key) const
+    {
+        auto first = std::begin(key);
+        descend(first, std::end(key));
+        return first == std::end(key);
+    }
+
+    /**
+     * Return the number of stored keys that start with the given prefix.
+     */
+    template<class Key> uint64_t countKeysWithPrefix(const Key &prefix) const
+    {
+        auto first = std::begin(prefix);
+        const Node *node = descend(first, std::end(prefix));
+        return (first == std::end(prefix)) ? node->numKeys : 0;
+    }
+
+    /**
+     * Call visit(key) with every stored key, in pre-order. See FrozenTrie::forEachKey().
+     */
+    template<class Visitor> void forEachKey(Visitor visit) const
+    {
+        std::vector<T> key;
+        std::vector<std::pair<const Node *, size_t> > pending(1, std::make_pair(root, size_t(0)));
+        while (!pending.empty()) {
+            const Node *node = pending.back().first;
+            size_t depth = pending.back().second;
+            pending.pop_back();
+            key.resize(depth);
+            if (node != root) {
+                key.push_back(node->value);
+            }
+            if (node->endOfKey) {
+                visit(static_cast<const std::vector<T> &>(key));
+            }
+            for (size_t i = node->children.size(); i-- > 0;) {
+                pending.push_back(std::make_pair(node->children[i], key.size()));
+            }
+        }
+    }
+
+    /**
+     * Return true if this version and other have the same values, keys and children.
+     * Subtrees the two versions share are equal without being looked at.
+     */
+    bool operator==(const PersistentTrie &other) const
+    {
+        std::vector<std::pair<const Node *, const Node *> > pending(1, std::make_pair(root, other.root));
+        while (!pending.empty()) {
+            const Node *node = pending.back().first;
+            const Node *otherNode = pending.back().second;
+            pending.pop_back();
+            if (node == otherNode) {
+                continue;
+            }
+            if (node->value != otherNode->value || node->endOfKey != otherNode->endOfKey ||
+                node->subtreeSize != otherNode->subtreeSize || node->children.size() != otherNode->children.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < node->children.size(); i++) {
+                pending.push_back(std::make_pair(node->children[i], otherNode->children[i]));
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const PersistentTrie &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+#endif // SRC_PERSISTENT_TRIE_H
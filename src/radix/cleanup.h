@@ -0,0 +1,33 @@
+#ifndef SRC_RADIX_CLEANUP_H
+#define SRC_RADIX_CLEANUP_H
+
+/**
+ * Remove all children from this Trie - this Trie shall become a leaf. Descendants
+ * are freed with an explicit stack, as in TrieNode::clear().
+ */
+template<class T> void RadixTrieNode<T>::clear()
+{
+    std::vector<RadixTrieNode<T> *> pending(children.begin(), children.end());
+    children.clear();
+    childIndex.cleared();
+
+    while (!pending.empty()) {
+        RadixTrieNode<T> *node = pending.back();
+        pending.pop_back();
+        pending.insert(pending.end(), node->children.begin(), node->children.end());
+        node->children.clear();
+        node->childIndex.cleared();
+        delete node;
+    }
+}
+
+/**
+ * Invoked when this RadixTrieNode is being deleted. At that time, free all of the
+ * children as well.
+ */
+template<class T> RadixTrieNode<T>::~RadixTrieNode()
+{
+    clear();
+}
+
+#endif // SRC_RADIX_CLEANUP_H
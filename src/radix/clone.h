@@ -0,0 +1,43 @@
+#ifndef SRC_RADIX_CLONE_H
+#define SRC_RADIX_CLONE_H
+
+/**
+ * Helper method - create a deep copy of this RadixTrieNode whose label starts at
+ * labelOffset (so that a subtree can be copied in below a node that already spells
+ * the beginning of its label). Built with an explicit stack, like TrieNode::cloneInto.
+ */
+template<class T> RadixTrieNode<T> *RadixTrieNode<T>::copySubtree(size_t labelOffset)
+{
+    RadixTrieNode<T> *newRoot = new RadixTrieNode<T>(label.begin() + labelOffset, label.end());
+    newRoot->endOfKey = endOfKey;
+
+    std::vector<std::pair<RadixTrieNode<T> *, RadixTrieNode<T> *> > pending;
+    pending.push_back(std::make_pair(this, newRoot));
+    while (!pending.empty()) {
+        RadixTrieNode<T> *original = pending.back().first;
+        RadixTrieNode<T> *copy = pending.back().second;
+        pending.pop_back();
+
+        copy->children.reserve(original->getNumChildren());
+        for (int i = 0; i < original->getNumChildren(); i++) {
+            RadixTrieNode<T> *child = original->children[i];
+            RadixTrieNode<T> *childCopy = new RadixTrieNode<T>(child->label.begin(), child->label.end());
+            childCopy->endOfKey = child->endOfKey;
+            childCopy->parent = copy;
+            copy->children.push_back(childCopy);
+            pending.push_back(std::make_pair(child, childCopy));
+        }
+        copy->childIndex.rebuild(copy->children);
+    }
+    return newRoot;
+}
+
+/**
+ * Create a deep copy of this RadixTrieNode.
+ */
+template<class T> RadixTrieNode<T> *RadixTrieNode<T>::clone()
+{
+    return copySubtree(0);
+}
+
+#endif // SRC_RADIX_CLONE_H
@@ -0,0 +1,45 @@
+#ifndef SRC_RADIX_COMPARE_H
+#define SRC_RADIX_COMPARE_H
+
+/**
+ * Helper method - used in "==" and "!=" to determine if this RadixTrieNode has the
+ * same label, end-of-key mark and children as other.
+ */
+template<class T> bool RadixTrieNode<T>::equals(RadixTrieNode<T> &other)
+{
+    std::vector<std::pair<RadixTrieNode<T> *, RadixTrieNode<T> *> > pending;
+    pending.push_back(std::make_pair(this, &other));
+
+    while (!pending.empty()) {
+        RadixTrieNode<T> *node = pending.back().first;
+        RadixTrieNode<T> *otherNode = pending.back().second;
+        pending.pop_back();
+
+        if (node->label != otherNode->label || node->endOfKey != otherNode->endOfKey ||
+            node->getNumChildren() != otherNode->getNumChildren()) {
+            return false;
+        }
+        for (int i = 0; i < node->getNumChildren(); i++) {
+            pending.push_back(std::make_pair(node->children[i], otherNode->children[i]));
+        }
+    }
+    return true;
+}
+
+/**
+ * Return true if this RadixTrieNode and other share the same labels and children.
+ */
+template<class T> bool RadixTrieNode<T>::operator==(RadixTrieNode<T> &other)
+{
+    return equals(other);
+}
+
+/**
+ * Return true if this RadixTrieNode does not have the same labels/children as other.
+ */
+template<class T> bool RadixTrieNode<T>::operator!=(RadixTrieNode<T> &other)
+{
+    return !equals(other);
+}
+
+#endif // SRC_RADIX_COMPARE_H
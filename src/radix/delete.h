@@ -0,0 +1,62 @@
+#ifndef SRC_RADIX_DELETE_H
+#define SRC_RADIX_DELETE_H
+
+/**
+ * Helper method - remove child from this RadixTrieNode's children (without deleting it).
+ */
+template<class T> void RadixTrieNode<T>::detachChild(RadixTrieNode<T> *child)
+{
+    int index = childIndex.find(children, child->value);
+    children.erase(children.begin() + index);
+    childIndex.erased(children, index, child->value);
+    child->parent = NULL;
+}
+
+/**
+ * Helper method - fold this RadixTrieNode's only child into it: the child's label is
+ * appended to this node's, and the child's children and end-of-key mark move up.
+ * The reverse of split().
+ */
+template<class T> void RadixTrieNode<T>::absorbChild()
+{
+    RadixTrieNode<T> *child = children[0];
+    children.clear();
+    childIndex.cleared();
+
+    label.insert(label.end(), child->label.begin(), child->label.end());
+    endOfKey = child->endOfKey;
+    takeChildren(*child);
+    delete child;
+}
+
+/**
+ * Remove the given key from this Trie. Return true if it was removed, false if it
+ * was not stored in the first place.
+ *
+ * A leaf that no longer ends a key is deleted, and a node left with a single child
+ * and no key of its own is merged with that child, so the Trie stays as compressed as
+ * if the key had never been inserted. This RadixTrieNode itself is never merged away.
+ */
+template<class T> template<class Key> bool RadixTrieNode<T>::operator>>(const Key &key)
+{
+    auto first = std::begin(key);
+    size_t matched;
+    RadixTrieNode<T> *node = descend(first, std::end(key), matched);
+    if (first != std::end(key) || matched < node->label.size() || !node->endOfKey) {
+        return false;
+    }
+    node->endOfKey = false;
+
+    if (node != this && !node->hasChildren()) {
+        RadixTrieNode<T> *parentNode = node->parent;
+        parentNode->detachChild(node);
+        delete node;
+        node = parentNode;
+    }
+    if (node != this && !node->endOfKey && node->getNumChildren() == 1) {
+        node->absorbChild();
+    }
+    return true;
+}
+
+#endif // SRC_RADIX_DELETE_H
@@ -0,0 +1,79 @@
+#ifndef SRC_RADIX_DISPLAY_H
+#define SRC_RADIX_DISPLAY_H
+
+/**
+ * Write a label to output. Values are separated by commas, except for character
+ * labels, which are written as one string.
+ */
+template<class T> void displayLabel(std::ostream &output, const std::vector<T> &label)
+{
+    for (size_t i = 0; i < label.size(); i++) {
+        output << (i > 0 ? "," : "") << label[i];
+    }
+}
+
+inline void displayLabel(std::ostream &output, const std::vector<char> &label)
+{
+    output.write(label.data(), label.size());
+}
+
+/**
+ * Defines how a single RadixTrieNode should be displayed - as for TrieNode, but with
+ * labels in place of values:
+ *    rom
+ * ========
+ * ane ulus
+ */
+template<class T> std::string displayNode(RadixTrieNode<T> &rn)
+{
+    std::stringstream childStream;
+    for (int i = 0; i < rn.getNumChildren(); i++) {
+        displayLabel(childStream, rn.getChildAtIndex(i)->getLabel());
+        childStream << " ";
+    }
+    std::string childLine = childStream.str();
+
+    std::stringstream strStream;
+    strStream << std::string(rn.getNumChildren(), ' ');
+    displayLabel(strStream, rn.getLabel());
+    strStream << std::endl;
+    strStream << std::string(childLine.size() - 1, '=') << std::endl;
+    strStream << childLine;
+    return strStream.str();
+}
+
+/**
+ * Writes the current Trie and all sub-Tries to output, in pre-order.
+ */
+template<class T> void displayTrie(std::ostream &output, RadixTrieNode<T> &rn)
+{
+    std::vector<RadixTrieNode<T> *> pending(1, &rn);
+    while (!pending.empty()) {
+        RadixTrieNode<T> *node = pending.back();
+        pending.pop_back();
+        // Skip leaves.
+        if (!node->hasChildren()) {
+            continue;
+        }
+        output << displayNode(*node) << std::endl << std::endl;
+        for (int i = node->getNumChildren() - 1; i >= 0; i--) {
+            pending.push_back(node->getChildAtIndex(i));
+        }
+    }
+}
+
+/**
+ * Writes the provided Trie (this node + all descendants) to the given output stream.
+ */
+template<class T> std::ostream &operator<<(std::ostream &output, RadixTrieNode<T> &rn)
+{
+    if (!rn.hasChildren()) {
+        displayLabel(output, rn.getLabel());
+        output << std::endl;
+        return output;
+    }
+    displayTrie(output, rn);
+    return output;
+}
+
+#endif // SRC_RADIX_DISPLAY_H
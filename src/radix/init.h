@@ -0,0 +1,51 @@
+#ifndef SRC_RADIX_INIT_H
+#define SRC_RADIX_INIT_H
+
+/**
+ * Default constructor - a root, with an empty label.
+ */
+template<class T> RadixTrieNode<T>::RadixTrieNode() : value(), parent(NULL), endOfKey(false) {}
+
+/**
+ * Initialize a RadixTrieNode whose edge label is [first, last).
+ */
+template<class T> template<class Iter> RadixTrieNode<T>::RadixTrieNode(Iter first, Iter last)
+    : value(), parent(NULL), endOfKey(false)
+{
+    setLabel(first, last);
+}
+
+/**
+ * Helper method - replace this RadixTrieNode's label with [first, last).
+ */
+template<class T> template<class Iter> void RadixTrieNode<T>::setLabel(Iter first, Iter last)
+{
+    label.assign(first, last);
+    value = label.empty() ? T() : label[0];
+}
+
+/**
+ * Return a reference to this RadixTrieNode's parent.
+ */
+template<class T> RadixTrieNode<T> *RadixTrieNode<T>::getParent()
+{
+    return parent;
+}
+
+/**
+ * Return the values on the edge leading down to this RadixTrieNode.
+ */
+template<class T> const std::vector<T> &RadixTrieNode<T>::getLabel()
+{
+    return label;
+}
+
+/**
+ * Return true if a key ends at this RadixTrieNode, false otherwise.
+ */
+template<class T> bool RadixTrieNode<T>::isEndOfKey()
+{
+    return endOfKey;
+}
+
+#endif // SRC_RADIX_INIT_H
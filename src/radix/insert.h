@@ -0,0 +1,80 @@
+#ifndef SRC_RADIX_INSERT_H
+#define SRC_RADIX_INSERT_H
+
+/**
+ * Helper method - append child to this RadixTrieNode's children. The caller makes
+ * sure that no other child's label starts with the same value.
+ */
+template<class T> void RadixTrieNode<T>::attachChild(RadixTrieNode<T> *child)
+{
+    child->parent = this;
+    children.push_back(child);
+    childIndex.pushed(children);
+}
+
+/**
+ * Helper method - move all of from's children over to this RadixTrieNode, which must
+ * not have any children of its own.
+ */
+template<class T> void RadixTrieNode<T>::takeChildren(RadixTrieNode<T> &from)
+{
+    children.swap(from.children);
+    from.childIndex.cleared();
+    childIndex.rebuild(children);
+    for (int i = 0; i < getNumChildren(); i++) {
+        children[i]->parent = this;
+    }
+}
+
+/**
+ * Helper method - cut this RadixTrieNode's label after its first length values
+ * (0 < length < label size). The rest of the label moves down into a new, only child
+ * that takes over this node's children and end-of-key mark.
+ *     abcd          ab
+ *    ======  ->   ======
+ *     x  y          cd
+ *                 ======
+ *                  x  y
+ */
+template<class T> void RadixTrieNode<T>::split(size_t length)
+{
+    RadixTrieNode<T> *rest = new RadixTrieNode<T>(label.begin() + length, label.end());
+    rest->endOfKey = endOfKey;
+    rest->takeChildren(*this);
+
+    label.resize(length);
+    endOfKey = false;
+    attachChild(rest);
+}
+
+/**
+ * Insert the key [first, last) below this RadixTrieNode and mark the node it ends at
+ * as the end of a key, splitting a label if the key ends or branches off in the
+ * middle of it. Return that node.
+ */
+template<class T> template<class Iter> RadixTrieNode<T> *RadixTrieNode<T>::insert(Iter first, Iter last)
+{
+    size_t matched;
+    RadixTrieNode<T> *current = descend(first, last, matched);
+    if (matched < current->label.size()) {
+        current->split(matched);
+    }
+    // Whatever is left of the key becomes a single new leaf.
+    if (first != last) {
+        RadixTrieNode<T> *leaf = new RadixTrieNode<T>(first, last);
+        current->attachChild(leaf);
+        current = leaf;
+    }
+    current->endOfKey = true;
+    return current;
+}
+
+/**
+ * Insert the given key (any container of T, eg. std::string for RadixTrieNode<char>).
+ */
+template<class T> template<class Key> RadixTrieNode<T> *RadixTrieNode<T>::insert(const Key &key)
+{
+    return insert(std::begin(key), std::end(key));
+}
+
+#endif // SRC_RADIX_INSERT_H
@@ -0,0 +1,73 @@
+#ifndef SRC_RADIX_MERGE_H
+#define SRC_RADIX_MERGE_H
+
+/**
+ * Helper method - insert every key stored below other into this Trie, copying
+ * other's nodes instead of inserting its keys one by one.
+ *
+ * Each step pairs a node of this Trie with a node of other whose label has been
+ * matched up to some offset. Once all of the source's label is matched, its children
+ * are paired up with this node in turn; otherwise the rest of its label either goes
+ * under a child that starts the same way (splitting that child's label where the two
+ * diverge) or, if there is no such child, is copied in whole.
+ */
+template<class T> void RadixTrieNode<T>::merge(RadixTrieNode<T> &other)
+{
+    struct Step
+    {
+        RadixTrieNode<T> *node;
+        RadixTrieNode<T> *source;
+        size_t offset;
+    };
+    Step first = { this, &other, other.label.size() };
+    std::vector<Step> pending(1, first);
+
+    while (!pending.empty()) {
+        Step step = pending.back();
+        pending.pop_back();
+        RadixTrieNode<T> *node = step.node;
+        RadixTrieNode<T> *source = step.source;
+
+        if (step.offset == source->label.size()) {
+            node->endOfKey = node->endOfKey || source->endOfKey;
+            // Pushed in reverse, so that new children are added in other's order.
+            for (int i = source->getNumChildren() - 1; i >= 0; i--) {
+                Step next = { node, source->children[i], 0 };
+                pending.push_back(next);
+            }
+            continue;
+        }
+
+        RadixTrieNode<T> *child = node->findChild(source->label[step.offset]);
+        if (child == NULL) {
+            node->attachChild(source->copySubtree(step.offset));
+            continue;
+        }
+        size_t common = 1;
+        while (common < child->label.size() && step.offset + common < source->label.size() &&
+               child->label[common] == source->label[step.offset + common]) {
+            common++;
+        }
+        if (common < child->label.size()) {
+            child->split(common);
+        }
+        Step next = { child, source, step.offset + common };
+        pending.push_back(next);
+    }
+}
+
+/**
+ * Merge other into this Trie: afterwards, every key stored below other (relative to
+ * other, so other's own label is not part of them) is also stored below this node.
+ * other is left untouched.
+ */
+template<class T> void RadixTrieNode<T>::operator+=(RadixTrieNode<T> &other)
+{
+    // Merging a Trie into itself changes nothing.
+    if (&other == this) {
+        return;
+    }
+    merge(other);
+}
+
+#endif // SRC_RADIX_MERGE_H
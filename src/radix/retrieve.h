@@ -0,0 +1,92 @@
+#ifndef SRC_RADIX_RETRIEVE_H
+#define SRC_RADIX_RETRIEVE_H
+
+/**
+ * Return the child at the specified index, or NULL if the index is out of bounds.
+ */
+template<class T> RadixTrieNode<T> *RadixTrieNode<T>::getChildAtIndex(int index)
+{
+    if (index < 0 || index >= getNumChildren()) {
+        return NULL;
+    }
+    return children[index];
+}
+
+/**
+ * Helper method - return the child whose label starts with value, or NULL if there
+ * is none. At most one child can start with any given value.
+ */
+template<class T> RadixTrieNode<T> *RadixTrieNode<T>::findChild(const T &value)
+{
+    int index = childIndex.find(children, value);
+    return (index == -1) ? NULL : children[index];
+}
+
+/**
+ * Return the child whose label starts with the given value, or NULL if there is none.
+ */
+template<class T> RadixTrieNode<T> *RadixTrieNode<T>::operator[](const T &first)
+{
+    return findChild(first);
+}
+
+/**
+ * Helper method - follow [first, last) down from this RadixTrieNode for as long as it
+ * matches. Return the deepest node reached; matched is set to the number of values of
+ * that node's label that were matched (all of them, unless the key ran out or
+ * diverged in the middle of the label), and first is left pointing at the first value
+ * that could not be matched (or at last if all of them were).
+ */
+template<class T> template<class Iter>
+RadixTrieNode<T> *RadixTrieNode<T>::descend(Iter &first, Iter last, size_t &matched)
+{
+    RadixTrieNode<T> *current = this;
+    matched = label.size();
+    while (first != last) {
+        RadixTrieNode<T> *next = current->findChild(*first);
+        if (next == NULL) {
+            break;
+        }
+        current = next;
+        // The first value is known to match; compare the rest of the label in place.
+        ++first;
+        matched = 1;
+        while (matched < current->label.size() && first != last && current->label[matched] == *first) {
+            ++first;
+            matched++;
+        }
+        if (matched < current->label.size()) {
+            break;
+        }
+    }
+    return current;
+}
+
+/**
+ * Return the node at which the given key ends, or NULL if the key was never inserted
+ * (including when it only exists as a prefix of longer keys).
+ */
+template<class T> template<class Key> RadixTrieNode<T> *RadixTrieNode<T>::find(const Key &key)
+{
+    auto first = std::begin(key);
+    size_t matched;
+    RadixTrieNode<T> *node = descend(first, std::end(key), matched);
+    if (first != std::end(key) || matched < node->label.size() || !node->endOfKey) {
+        return NULL;
+    }
+    return node;
+}
+
+/**
+ * Return true if the given key is a path in this Trie, ie. if it is a stored key or
+ * a prefix of one (which may end in the middle of a label), false otherwise.
+ */
+template<class T> template<class Key> bool RadixTrieNode<T>::isPrefix(const Key &key)
+{
+    auto first = std::begin(key);
+    size_t matched;
+    descend(first, std::end(key), matched);
+    return first == std::end(key);
+}
+
+#endif // SRC_RADIX_RETRIEVE_H
@@ -0,0 +1,64 @@
+#ifndef SRC_RADIX_SIZE_H
+#define SRC_RADIX_SIZE_H
+
+/**
+ * Return the number of children that this RadixTrieNode has.
+ */
+template<class T> int RadixTrieNode<T>::getNumChildren()
+{
+    return children.size();
+}
+
+/**
+ * Return true if this RadixTrieNode has children, false otherwise.
+ */
+template<class T> bool RadixTrieNode<T>::hasChildren()
+{
+    return !children.empty();
+}
+
+/**
+ * Return true if this RadixTrieNode has a parent, false otherwise.
+ */
+template<class T> bool RadixTrieNode<T>::hasParent()
+{
+    return parent != NULL;
+}
+
+/**
+ * Return the number of RadixTrieNodes in this Trie, including this one. Unlike
+ * TrieNode::size(), this walks the Trie.
+ */
+template<class T> uint64_t RadixTrieNode<T>::size()
+{
+    uint64_t numNodes = 0;
+    std::vector<RadixTrieNode<T> *> pending(1, this);
+    while (!pending.empty()) {
+        RadixTrieNode<T> *node = pending.back();
+        pending.pop_back();
+        numNodes++;
+        pending.insert(pending.end(), node->children.begin(), node->children.end());
+    }
+    return numNodes;
+}
+
+/**
+ * Return the number of keys stored in this Trie (including the empty key, if this
+ * RadixTrieNode ends one).
+ */
+template<class T> uint64_t RadixTrieNode<T>::getNumKeys()
+{
+    uint64_t numKeys = 0;
+    std::vector<RadixTrieNode<T> *> pending(1, this);
+    while (!pending.empty()) {
+        RadixTrieNode<T> *node = pending.back();
+        pending.pop_back();
+        if (node->endOfKey) {
+            numKeys++;
+        }
+        pending.insert(pending.end(), node->children.begin(), node->children.end());
+    }
+    return numKeys;
+}
+
+#endif // SRC_RADIX_SIZE_H
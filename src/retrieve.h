@@ -4,9 +4,9 @@
 /**
  * Return the index-th child reference if index is valid, NULL otherwise.
  */
-template<class T> TrieNode<T> *TrieNode<T>::getChildAtIndex(int index)
+template<class T, class Traits> TrieNode<T, Traits> *TrieNode<T, Traits>::getChildAtIndex(int index)
 {
-    if (index < 0 || index >= children.size()) {
+    if (index < 0 || index >= getNumChildren()) {
         return NULL;
     }
     return children[index];
@@ -14,54 +14,80 @@ template<class T> TrieNode<T> *TrieNode<T>::getChildAtIndex(int index)
 
 /**
  * Update the index-th child reference if index is valid; do nothing otherwise.
+ * The new child's parent becomes this TrieNode; the old child is detached.
  */
-template<class T> void TrieNode<T>::setChildAtIndex(int index, TrieNode<T> *updatedChild)
+template<class T, class Traits> void TrieNode<T, Traits>::setChildAtIndex(int index, TrieNode<T, Traits> *updatedChild)
 {
-    if (index < 0 || index >= children.size()) {
+    if (index < 0 || index >= getNumChildren()) {
         return;
     }
+    TrieNode<T, Traits> *oldChild = children[index];
+    if (oldChild != NULL) {
+        adjustCounts(-(int64_t) oldChild->countedNodes(), -(int64_t) oldChild->countedKeys());
+        if (oldChild->parentLink() == this) {
+            oldChild->linkParent(NULL);
+        }
+    }
+    childIndex.removing(children, index);
     children[index] = updatedChild;
+    childIndex.added(children, index);
+    if (updatedChild != NULL) {
+        updatedChild->linkParent(this);
+        adjustCounts(updatedChild->countedNodes(), updatedChild->countedKeys());
+    }
+    refreshMaxWeight();
 }
 
 /**
  * Return the index of the child with the given value.
  * If this node does not have any such children, then return -1.
  */
-template<class T> int TrieNode<T>::getIndexOfChild(T value)
+template<class T, class Traits> int TrieNode<T, Traits>::getIndexOfChild(const T &value)
 {
-    for (int i = 0; i < children.size(); i++) {
-        if (children[i]->getValue() == value) {
-            return i;
-        }
-    }
-    return -1;
+    return indexOfChild(value);
+}
+
+/**
+ * Helper method - same as getIndexOfChild, without going through the public API.
+ * See src/childIndex.h for how the lookup adapts to the number of children.
+ */
+template<class T, class Traits> int TrieNode<T, Traits>::indexOfChild(const T &value)
+{
+    TRIE_COUNT(Traits::COUNT_OPERATIONS, childLookups, 1);
+    return childIndex.find(children, value);
+}
+
+/**
+ * Helper method - return the child with the given value or NULL if no such
+ * child exists.
+ */
+template<class T, class Traits> TrieNode<T, Traits> *TrieNode<T, Traits>::findChild(const T &value)
+{
+    int index = indexOfChild(value);
+    return (index == -1) ? NULL : children[index];
 }
 
 /**
  * Return child node with the given value or NULL if no such child exists.
  */
-template<class T> TrieNode<T> *TrieNode<T>::operator[](T value)
+template<class T, class Traits> TrieNode<T, Traits> *TrieNode<T, Traits>::operator[](const T &value)
 {
-    int index = this->getIndexOfChild(value);
-    if (index == -1) {
-        return NULL;
-    }
-    return children[index];
+    return findChild(value);
 }
 
 /**
  * Return true if this TrieNode has a child with the given value, false otherwise.
  */
-template<class T> bool TrieNode<T>::hasChild(T value)
+template<class T, class Traits> bool TrieNode<T, Traits>::hasChild(const T &value)
 {
-    return (*this)[value] != NULL;
+    return findChild(value) != NULL;
 }
 
 /**
  * Return true if this TrieNode has a child with the same value as possibleChild and
  * false otherwise.
  */
-template<class T> bool TrieNode<T>::hasChild(TrieNode<T> *possibleChild)
+template<class T, class Traits> bool TrieNode<T, Traits>::hasChild(TrieNode<T, Traits> *possibleChild)
 {
     return hasChild(possibleChild->getValue());
 }
@@ -0,0 +1,66 @@
+#ifndef SRC_SERIALIZE_H
+#define SRC_SERIALIZE_H
+
+#include <deque>
+#include <type_traits>
+
+/**
+ * Write this Trie to output in the binary format described in src/trieFile.h, with
+ * this TrieNode as the root. Return true if everything was written successfully.
+ *
+ * Nodes are written as they come off a breadth-first queue, so apart from that queue
+ * (at most one level of the Trie at a time) nothing is copied; the header is filled
+ * from size() and getNumKeys() and the checksum is computed on the way.
+ */
+template<class T, class Traits> bool TrieNode<T, Traits>::serialize(std::ostream &output)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be serialized");
+    typedef TrieFileRecord<T> Record;
+
+    // Node numbers are 31 bits wide; the top bit marks the end of a key.
+    const uint64_t NUM_NODES = size();
+    if (NUM_NODES >= Record::END_OF_KEY) {
+        return false;
+    }
+    TrieFileChecksum checksum;
+    TrieFileHeader header;
+    header.valueSize = sizeof(T);
+    header.recordSize = sizeof(Record);
+    header.numNodes = NUM_NODES;
+    header.numKeys = getNumKeys();
+
+    char headerBytes[TrieFileHeader::DATA_OFFSET] = {};
+    memcpy(headerBytes, &header, sizeof(header));
+    output.write(headerBytes, sizeof(headerBytes));
+    checksum.update(headerBytes, sizeof(headerBytes));
+
+    uint64_t numQueued = 1;
+    std::deque<TrieNode<T, Traits> *> pending(1, this);
+    while (!pending.empty()) {
+        TrieNode<T, Traits> *node = pending.front();
+        pending.pop_front();
+
+        // Zero the whole record first, so that padding bytes are deterministic.
+        Record record;
+        memset(static_cast<void *>(&record), 0, sizeof(record));
+        record.childBegin = numQueued | (node->endOfKey ? Record::END_OF_KEY : 0);
+        record.value = node->value;
+        output.write(reinterpret_cast<const char *>(&record), sizeof(record));
+        checksum.update(&record, sizeof(record));
+
+        pending.insert(pending.end(), node->children.begin(), node->children.end());
+        numQueued += node->getNumChildren();
+    }
+
+    char padding[8] = {};
+    size_t paddingSize = TrieFileHeader::fileSize(NUM_NODES, sizeof(Record)) - sizeof(uint64_t) -
+        TrieFileHeader::DATA_OFFSET - NUM_NODES * sizeof(Record);
+    output.write(padding, paddingSize);
+    checksum.update(padding, paddingSize);
+
+    uint64_t sum = checksum.value();
+    output.write(reinterpret_cast<const char *>(&sum), sizeof(sum));
+    return output.good();
+}
+
+#endif // SRC_SERIALIZE_H
@@ -4,7 +4,7 @@
 /**
  * Return the number of children/first-level descendants for this TrieNode.
  */
-template<class T> int TrieNode<T>::getNumChildren()
+template<class T, class Traits> int TrieNode<T, Traits>::getNumChildren()
 {
     return children.size();
 }
@@ -12,7 +12,7 @@ template<class T> int TrieNode<T>::getNumChildren()
 /**
  * Return true if this TrieNode has children and false otherwise.
  */
-template<class T> bool TrieNode<T>::hasChildren()
+template<class T, class Traits> bool TrieNode<T, Traits>::hasChildren()
 {
     return !children.empty();
 }
@@ -20,39 +20,99 @@ template<class T> bool TrieNode<T>::hasChildren()
 /**
  * Return true if this TrieNode has a parent and false otherwise.
  */
-template<class T> bool TrieNode<T>::hasParent()
+template<class T, class Traits> bool TrieNode<T, Traits>::hasParent()
 {
-	return parent != NULL;
+    static_assert(Traits::KEEP_PARENT, "hasParent() needs Traits::KEEP_PARENT");
+	return this->parentLink() != NULL;
 }
 
 /**
  * Return true if this TrieNode does not have a parent or any children,
- * and if size = 1. Otherwise, return false.
+ * and if size = 1. Otherwise, return false. (Without parent pointers, only the
+ * children and the size are checked.)
  */
-template<class T> bool TrieNode<T>::isSingleton()
+template<class T, class Traits> bool TrieNode<T, Traits>::isSingleton()
 {
-	return !hasChildren() && !hasParent() && size() == 1;
+	return !hasChildren() && this->parentLink() == NULL && size() == 1;
 }
 
 /**
  * Return the total number of TrieNodes below this TrieNode (all descendants), including
- * this TrieNode.
+ * this TrieNode. With Traits::CACHE_COUNTS (see CachingTrieTraits), the count is kept
+ * up to date as the Trie changes, so this is O(1); otherwise the subtree is walked.
  */
-template<class T> int TrieNode<T>::size()
+template<class T, class Traits> uint64_t TrieNode<T, Traits>::size()
 {
-    // Return 1 if this TrieNode has no children/descendants.
-    int size = 1;
-    if (children.empty()) {
-        return size;
+    if (Traits::CACHE_COUNTS) {
+        return this->countedNodes();
     }
+    uint64_t numNodes, numKeys;
+    countSubtree(numNodes, numKeys);
+    return numNodes;
+}
 
-    // Otherwise, add up the number of descendants for each TrieNode.
-    // size starts at 1 to account for this TrieNode.
-    for (int i = 0; i < children.size(); i++) {
-        size += children[i]->size();
+/**
+ * Return the number of keys stored in this TrieNode's subtree, ie. the number of
+ * end-of-key TrieNodes below it, including this TrieNode. O(1) with cached counts,
+ * like size().
+ */
+template<class T, class Traits> uint64_t TrieNode<T, Traits>::getNumKeys()
+{
+    if (Traits::CACHE_COUNTS) {
+        return this->countedKeys();
     }
-    return size;
+    uint64_t numNodes, numKeys;
+    countSubtree(numNodes, numKeys);
+    return numKeys;
 }
 
-#endif // SRC_SIZE_H
+/**
+ * Helper method - count the TrieNodes and the keys of this subtree by walking it, for
+ * TrieNodes that do not cache their counts.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::countSubtree(uint64_t &numNodes, uint64_t &numKeys)
+{
+    numNodes = 0;
+    numKeys = 0;
+    std::vector<TrieNode<T, Traits> *> pending(1, this);
+    while (!pending.empty()) {
+        TrieNode<T, Traits> *node = pending.back();
+        pending.pop_back();
+        numNodes++;
+        numKeys += node->endOfKey ? 1 : 0;
+        pending.insert(pending.end(), node->children.begin(), node->children.end());
+    }
+}
 
+/**
+ * Helper method - add the given deltas to the node and key counts of this TrieNode
+ * and of every one of its ancestors. Called whenever this TrieNode's subtree changes,
+ * so it also drops their cached hashes.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::adjustCounts(int64_t nodesDelta, int64_t keysDelta)
+{
+    for (TrieNode<T, Traits> *node = this; node != NULL; node = node->parentLink()) {
+        node->addCounts(nodesDelta, keysDelta);
+        node->cacheHash(0);
+    }
+}
+
+/**
+ * Helper method - recompute this TrieNode's counts and best weight from its
+ * children's, and drop its cached hash. Does not touch any ancestor.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::recount()
+{
+    this->cacheHash(0);
+    uint64_t numNodes = 1, numKeys = endOfKey ? 1 : 0;
+    double maxWeight = endOfKey ? this->keyWeight() : NO_WEIGHT();
+    for (int i = 0; i < getNumChildren(); i++) {
+        numNodes += children[i]->countedNodes();
+        numKeys += children[i]->countedKeys();
+        maxWeight = std::max(maxWeight, children[i]->bestWeight());
+    }
+    this->setCounts(numNodes, numKeys);
+    this->setBestWeight(maxWeight);
+}
+
+#endif // SRC_SIZE_H
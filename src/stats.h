@@ -0,0 +1,62 @@
+#ifndef SRC_STATS_H
+#define SRC_STATS_H
+
+/**
+ * Return the shape of this subtree - counts, depth, fanout and single-child chain
+ * histograms - and the bytes it uses, in one walk (see src/trieStats.h). Depths are
+ * relative to this TrieNode. TrieNodes are counted as allocated where they were
+ * created (their parent's arena, or the global heap, with or without an allocation
+ * header - see operator new), and this TrieNode as if on the global heap.
+ */
+template<class T, class Traits> TrieStats TrieNode<T, Traits>::stats()
+{
+    TrieStats stats;
+    // chainLengths[d] is the length of the chain ending at the TrieNode at depth d on
+    // the current path (0 if it is not in one); a chain is counted where it ends.
+    std::vector<uint64_t> chainLengths;
+    std::vector<std::pair<TrieNode<T, Traits> *, size_t> > pending(1, std::make_pair(this, size_t(0)));
+    while (!pending.empty()) {
+        TrieNode<T, Traits> *node = pending.back().first;
+        size_t depth = pending.back().second;
+        pending.pop_back();
+
+        const size_t NUM_CHILDREN = node->children.size();
+        stats.numNodes++;
+        stats.numKeys += node->endOfKey ? 1 : 0;
+        stats.numLeaves += (NUM_CHILDREN == 0) ? 1 : 0;
+        stats.maxDepth = std::max(stats.maxDepth, (uint64_t) depth);
+        TrieStats::count(stats.depthHistogram, depth);
+        TrieStats::count(stats.fanoutHistogram, NUM_CHILDREN);
+
+        if (chainLengths.size() <= depth) {
+            chainLengths.resize(depth + 1);
+        }
+        uint64_t parentChain = (depth > 0) ? chainLengths[depth - 1] : 0;
+        bool inChain = (NUM_CHILDREN == 1 && !node->endOfKey);
+        chainLengths[depth] = inChain ? parentChain + 1 : 0;
+        if (!inChain && parentChain > 0) {
+            TrieStats::count(stats.chainHistogram, parentChain);
+        }
+
+        stats.nodeBytes += Traits::USE_ARENAS ? Arena::bytesPerNode((node == this) ? NULL : node->arenaLink()) :
+            sizeof(TrieNode<T, Traits>);
+        size_t heapCapacity = heapCapacityOf(node->children);
+        if (heapCapacity > 0) {
+            stats.childVectorBytes += NUM_CHILDREN * sizeof(TrieNode<T, Traits> *);
+            stats.childSlackBytes += (heapCapacity - NUM_CHILDREN) * sizeof(TrieNode<T, Traits> *);
+        }
+        stats.childIndexBytes += node->childIndex.heapBytes() + indexBytesOf(node->children);
+        stats.childIndexNodeBytes += std::is_empty<ChildIndex<T, TrieNode<T, Traits>, Children,
+            Traits::COUNT_OPERATIONS> >::value ? 0 : sizeof(node->childIndex);
+        stats.valueBytes += TrieStats::heapBytesOf(node->value);
+
+        for (size_t i = NUM_CHILDREN; i-- > 0;) {
+            if (node->children[i] != NULL) {
+                pending.push_back(std::make_pair(node->children[i], depth + 1));
+            }
+        }
+    }
+    return stats;
+}
+
+#endif // SRC_STATS_H
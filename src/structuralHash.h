@@ -0,0 +1,50 @@
+#ifndef SRC_STRUCTURAL_HASH_H
+#define SRC_STRUCTURAL_HASH_H
+
+#include <type_traits>
+#include <stdint.h>
+
+#include "childIndex.h"
+
+/**
+ * Building blocks for hashing the structure of a Trie: a node's hash is its value,
+ * its end-of-key flag and its children's hashes, in order, folded together with
+ * mix(). Values are hashed with std::hash where T has it; otherwise only the
+ * structure is hashed, and equal hashes just mean "compare to be sure" more often.
+ */
+struct StructuralHash
+{
+    static const uint64_t SEED = 14695981039346656037ULL;
+
+    /**
+     * Fold x into hash: combine the two (an odd multiplier keeps the order of what was
+     * folded in), then run the result through the splitmix64 finalizer, so that every
+     * bit of both reaches every bit of the hash. Small inputs such as chars, which
+     * std::hash leaves as they are, would otherwise only stir the low bits, and tiny
+     * Tries collide.
+     */
+    static uint64_t mix(uint64_t hash, uint64_t x)
+    {
+        uint64_t z = hash * 0x9e3779b97f4a7c15ULL + x;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    template<class T> static uint64_t ofValue(const T &value)
+    {
+        return ofValue(value, std::integral_constant<bool, IsHashableValue<T>::value>());
+    }
+
+private:
+    template<class T> static uint64_t ofValue(const T &value, std::true_type)
+    {
+        return std::hash<T>()(value);
+    }
+    template<class T> static uint64_t ofValue(const T &, std::false_type)
+    {
+        return 0;
+    }
+};
+
+#endif // SRC_STRUCTURAL_HASH_H
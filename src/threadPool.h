@@ -0,0 +1,180 @@
+#ifndef SRC_THREAD_POOL_H
+#define SRC_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Fixed-size thread pool with one task deque per worker. A worker takes tasks from
+ *      the back of its own deque (newest first, which keeps it working on the subtree it
+ *      just split up), and when that runs dry it steals from the front of the others'
+ *      (oldest first, which tend to be the biggest pieces of work).
+ *
+ * DETAILS:
+ *      Tasks receive the index of the worker running them, so they can keep per-worker
+ *      state without locking. Tasks submitted from inside a task go to that worker's
+ *      own deque; tasks submitted from outside are spread round-robin. wait() blocks
+ *      until every task - including the ones submitted by other tasks - has finished.
+ */
+class WorkStealingPool
+{
+public:
+    typedef std::function<void(unsigned)> Task;
+
+private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<Queue *> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued;     // tasks sitting in some deque
+    std::atomic<size_t> pending;    // tasks submitted but not finished yet
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+    std::mutex stateLock;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+
+    // The pool and worker index of the calling thread, if it is one of our workers.
+    static std::pair<WorkStealingPool *, unsigned> &currentWorker()
+    {
+        static thread_local std::pair<WorkStealingPool *, unsigned> current(NULL, 0);
+        return current;
+    }
+
+    bool popOwn(unsigned index, Task &task)
+    {
+        Queue *queue = queues[index];
+        std::lock_guard<std::mutex> guard(queue->lock);
+        if (queue->tasks.empty()) {
+            return false;
+        }
+        task = queue->tasks.back();
+        queue->tasks.pop_back();
+        return true;
+    }
+
+    bool steal(unsigned index, Task &task)
+    {
+        for (size_t i = 1; i < queues.size(); i++) {
+            Queue *victim = queues[(index + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim->lock);
+            if (!victim->tasks.empty()) {
+                task = victim->tasks.front();
+                victim->tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(unsigned index)
+    {
+        currentWorker() = std::make_pair(this, index);
+        while (true) {
+            Task task;
+            if (popOwn(index, task) || steal(index, task)) {
+                queued--;
+                task(index);
+                if (--pending == 0) {
+                    std::lock_guard<std::mutex> guard(stateLock);
+                    allDone.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(stateLock);
+            workAvailable.wait(guard, [this] { return stopping || queued > 0; });
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    // No copying - the workers refer back to this pool.
+    WorkStealingPool(const WorkStealingPool &);
+    WorkStealingPool &operator=(const WorkStealingPool &);
+
+public:
+    /**
+     * Start numThreads workers (one per hardware thread if numThreads is 0).
+     */
+    explicit WorkStealingPool(unsigned numThreads)
+        : queued(0), pending(0), nextQueue(0), stopping(false)
+    {
+        if (numThreads == 0) {
+            numThreads = std::thread::hardware_concurrency();
+        }
+        if (numThreads == 0) {
+            numThreads = 1;
+        }
+        for (unsigned i = 0; i < numThreads; i++) {
+            queues.push_back(new Queue());
+        }
+        for (unsigned i = 0; i < numThreads; i++) {
+            threads.push_back(std::thread(&WorkStealingPool::run, this, i));
+        }
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+        for (size_t i = 0; i < queues.size(); i++) {
+            delete queues[i];
+        }
+    }
+
+    /**
+     * Return the number of workers.
+     */
+    unsigned size()
+    {
+        return queues.size();
+    }
+
+    /**
+     * Queue a task to be run by one of the workers.
+     */
+    void submit(const Task &task)
+    {
+        std::pair<WorkStealingPool *, unsigned> &current = currentWorker();
+        unsigned index = (current.first == this) ? current.second : nextQueue++ % queues.size();
+
+        pending++;
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            queued++;
+        }
+        {
+            std::lock_guard<std::mutex> guard(queues[index]->lock);
+            queues[index]->tasks.push_back(task);
+        }
+        workAvailable.notify_one();
+    }
+
+    /**
+     * Block until every submitted task has finished.
+     */
+    void wait()
+    {
+        std::unique_lock<std::mutex> guard(stateLock);
+        allDone.wait(guard, [this] { return pending == 0; });
+    }
+};
+
+#endif // SRC_THREAD_POOL_H
@@ -0,0 +1,82 @@
+#ifndef SRC_TRAVERSE_H
+#define SRC_TRAVERSE_H
+
+/**
+ * Iterators over this TrieNode's subtree (see src/iterator.h). Eg.,
+ *     for (TrieNode<char> &node : *root) { ... }                  // pre-order
+ *     for (const std::vector<char> &key : root->keys(std::string("ab"))) { ... }
+ */
+
+/**
+ * Return a pre-order iterator positioned at this TrieNode, so that a TrieNode can be
+ * used in range-for directly.
+ */
+template<class T, class Traits> TriePreOrderIterator<T, Traits> TrieNode<T, Traits>::begin()
+{
+    return TriePreOrderIterator<T, Traits>(this, this);
+}
+
+/**
+ * Return the end of a pre-order walk.
+ */
+template<class T, class Traits> TriePreOrderIterator<T, Traits> TrieNode<T, Traits>::end()
+{
+    return TriePreOrderIterator<T, Traits>(this, NULL);
+}
+
+/**
+ * Return the TrieNodes of this subtree, each before its children.
+ */
+template<class T, class Traits>
+TrieRange<TriePreOrderIterator<T, Traits> > TrieNode<T, Traits>::preOrder()
+{
+    return TrieRange<TriePreOrderIterator<T, Traits> >(begin(), end());
+}
+
+/**
+ * Return the TrieNodes of this subtree, each after its children.
+ */
+template<class T, class Traits>
+TrieRange<TriePostOrderIterator<T, Traits> > TrieNode<T, Traits>::postOrder()
+{
+    typedef TriePostOrderIterator<T, Traits> Iterator;
+    return TrieRange<Iterator>(Iterator(this), Iterator(this, NULL));
+}
+
+/**
+ * Return the TrieNodes of this subtree level by level, starting with this one.
+ */
+template<class T, class Traits>
+TrieRange<TrieLevelOrderIterator<T, Traits> > TrieNode<T, Traits>::levelOrder()
+{
+    typedef TrieLevelOrderIterator<T, Traits> Iterator;
+    return TrieRange<Iterator>(Iterator(this), Iterator());
+}
+
+/**
+ * Return the keys stored below this TrieNode, in pre-order.
+ */
+template<class T, class Traits> TrieRange<TrieKeyIterator<T, Traits> > TrieNode<T, Traits>::keys()
+{
+    typedef TrieKeyIterator<T, Traits> Iterator;
+    std::vector<T> noPrefix;
+    return TrieRange<Iterator>(Iterator(this, noPrefix.begin(), noPrefix.end()), Iterator());
+}
+
+/**
+ * Return the keys stored below this TrieNode that start with the given prefix (the
+ * prefix included), in pre-order. The range is empty if no key does.
+ */
+template<class T, class Traits> template<class Key>
+TrieRange<TrieKeyIterator<T, Traits> > TrieNode<T, Traits>::keys(const Key &prefix)
+{
+    typedef TrieKeyIterator<T, Traits> Iterator;
+    auto first = std::begin(prefix);
+    TrieNode<T, Traits> *node = descend(first, std::end(prefix));
+    if (first != std::end(prefix)) {
+        node = NULL;
+    }
+    return TrieRange<Iterator>(Iterator(node, std::begin(prefix), std::end(prefix)), Iterator());
+}
+
+#endif // SRC_TRAVERSE_H
@@ -0,0 +1,94 @@
+#ifndef SRC_TRIE_FILE_H
+#define SRC_TRIE_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Binary file format written by TrieNode::serialize() and read by MappedTrie.
+ *      It is laid out so that a mapped file can be searched in place: after a fixed
+ *      header comes one fixed-size record per node, in breadth-first order (as in
+ *      FrozenTrie), then a checksum.
+ *
+ * DETAILS:
+ *          offset 0                    TrieFileHeader (padded to DATA_OFFSET bytes)
+ *          offset DATA_OFFSET          numNodes x TrieFileRecord<T>
+ *          (padded to 8 bytes)         uint64_t checksum of everything before it
+ *
+ *      A record holds the node's value and the number of its first child; the top bit
+ *      of that number marks the end of a key. A node's children run up to the first
+ *      child of the next node (or to the last node, for the last one).
+ *      Values are stored as their raw bytes, in the writer's byte order, so only
+ *      trivially copyable T can be written; the header records enough (byte order,
+ *      sizes) for a reader to reject a file it cannot interpret.
+ */
+struct TrieFileHeader
+{
+    static const uint32_t VERSION = 1;
+    static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static const size_t DATA_OFFSET = 64;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t valueSize;
+    uint32_t recordSize;
+    uint64_t numNodes;
+    uint64_t numKeys;
+
+    static const char *expectedMagic()
+    {
+        return "TRIEBIN";
+    }
+
+    TrieFileHeader() : version(VERSION), byteOrder(BYTE_ORDER_MARK), valueSize(0), recordSize(0),
+        numNodes(0), numKeys(0)
+    {
+        memcpy(magic, expectedMagic(), sizeof(magic));
+    }
+
+    /**
+     * Return the total size of a file holding numNodes records of recordSize bytes.
+     */
+    static uint64_t fileSize(uint64_t numNodes, uint64_t recordSize)
+    {
+        return (DATA_OFFSET + numNodes * recordSize + 7) / 8 * 8 + sizeof(uint64_t);
+    }
+};
+
+template<class T> struct TrieFileRecord
+{
+    static const uint32_t END_OF_KEY = 0x80000000u;
+
+    uint32_t childBegin;    // END_OF_KEY | number of the first child
+    T value;
+};
+
+/**
+ * Running 64-bit FNV-1a checksum, fed the bytes of a file as they are written or read.
+ */
+class TrieFileChecksum
+{
+private:
+    uint64_t hash;
+
+public:
+    TrieFileChecksum() : hash(14695981039346656037ull) {}
+
+    void update(const void *data, size_t length)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+
+    uint64_t value() const
+    {
+        return hash;
+    }
+};
+
+#endif // SRC_TRIE_FILE_H
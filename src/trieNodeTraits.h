@@ -0,0 +1,321 @@
+#ifndef SRC_TRIE_NODE_TRAITS_H
+#define SRC_TRIE_NODE_TRAITS_H
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <stdint.h>
+
+#include "childList.h"
+#include "byteChildList.h"
+
+template<class Node> class NodeArena;
+template<class T, class Traits> class TrieNode;
+
+/**
+ * The children of a TrieNode, unless its Traits say otherwise: a ChildList, or for
+ * byte-sized values a ByteChildList, which also indexes them (see src/byteChildList.h).
+ */
+template<class Node> struct DefaultChildContainer
+{
+    typedef ChildList<Node> type;
+};
+template<class Traits> struct DefaultChildContainer<TrieNode<char, Traits> >
+{
+    typedef ByteChildList<TrieNode<char, Traits> > type;
+};
+template<class Traits> struct DefaultChildContainer<TrieNode<signed char, Traits> >
+{
+    typedef ByteChildList<TrieNode<signed char, Traits> > type;
+};
+template<class Traits> struct DefaultChildContainer<TrieNode<unsigned char, Traits> >
+{
+    typedef ByteChildList<TrieNode<unsigned char, Traits> > type;
+};
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      Compile-time options (policies) of a TrieNode, given as its second template
+ *      parameter. Everything that costs room in every TrieNode is off by default, so
+ *      that a TrieNode<char> is no bigger than a value, a parent pointer and its
+ *      children (32 bytes on 64-bit platforms):
+ *          TrieNode<char>                          - the default, TrieNodeTraits: a
+ *                                                    parent pointer, and nothing cached
+ *          TrieNode<char, NoParentTrieTraits>      - no parent pointers
+ *          TrieNode<char, CachingTrieTraits>       - cached counts and hashes
+ *          TrieNode<char, WeightedTrieTraits>      - weighted keys and topK()
+ *          TrieNode<char, ArenaTrieTraits>         - arenas (see useArena())
+ *          TrieNode<char, FullTrieTraits>          - all three of the above
+ *          TrieNode<char, VectorChildTrieTraits>   - children in a std::vector
+ *          TrieNode<char, OperationCountingTrieTraits> - operation counters
+ *          TrieNode<char, CompactTrieTraits>       - the smallest TrieNode: no parent
+ *                                                    pointers, caches, weights or arenas
+ *      To change some options, derive from TrieNodeTraits (or one of the others) and
+ *      redefine them. Every option is resolved at compile time: TrieNode has no
+ *      virtual methods, and code for the options not taken is never instantiated.
+ *
+ * DETAILS:
+ *      ChildContainer<Node>::type - what holds a TrieNode's children: a ChildList (see
+ *          src/childList.h) by default, or a ByteChildList for char, signed char and
+ *          unsigned char values. Any container with the std::vector methods TrieNode
+ *          uses (push_back, erase, reserve, assign, swap, ...) will do; a ChildIndex
+ *          is then kept next to it.
+ *      NodeAllocator<Node>::type - where TrieNodes are allocated: NodeArena (see
+ *          src/arena.h) by default. A replacement provides the same members, and is
+ *          most easily derived from NodeArena, redefining its static allocateNode()
+ *          and releaseNode() to change what "new TrieNode" does outside of arenas.
+ *      CACHE_COUNTS - every TrieNode caches the number of TrieNodes and of keys in its
+ *          subtree (16 bytes per TrieNode), so that size(), getNumKeys() and
+ *          countKeysWithPrefix() are O(1). Without it, they walk the subtree, and
+ *          parallel merges only hand out the children of the root, one task each.
+ *      KEEP_PARENT - every TrieNode points to its parent (8 bytes per TrieNode).
+ *          Without it, getParent(), setParent(), hasParent(), setWeight() and topK()
+ *          do not compile, and iterators keep the TrieNodes on the path to the
+ *          current one on a stack instead. A TrieNode also cannot tell its ancestors
+ *          about changes ("<<", ">>", setEndOfKey() or setValue() below the root), so
+ *          nothing that depends on its subtree may be cached: CACHE_COUNTS and
+ *          CACHE_HASHES must be off as well (TrieNode checks). Nor can setValue()
+ *          re-index a TrieNode in its parent: take the TrieNode out with ">>" before
+ *          changing its value, and add it back after.
+ *      CACHE_HASHES - every TrieNode caches the structural hash of its subtree (8
+ *          bytes per TrieNode), so that getHash() only rehashes the paths changed since
+ *          the last call, and == and merges can tell unequal subtrees apart (or skip
+ *          equal ones) without walking them. Without it, getHash() hashes the whole
+ *          subtree every time.
+ *      KEEP_WEIGHTS - every TrieNode keeps the weight of its key and the best weight
+ *          in its subtree (16 bytes per TrieNode; see src/weight.h). Without it,
+ *          every key weighs 0, and setWeight(), insert(key, weight) and topK() do not
+ *          compile.
+ *      USE_ARENAS - every TrieNode remembers the arena its children are carved from
+ *          (8 bytes per TrieNode; see useArena()). Without it, all TrieNodes come from
+ *          the global heap, and useArena() returns false.
+ *      COUNT_OPERATIONS - lookups, inserts and child scans are added to the
+ *          process-wide TrieCounters (see src/trieStats.h). Off by default, in which
+ *          case counting compiles to nothing.
+ */
+struct TrieNodeTraits
+{
+    template<class Node> struct ChildContainer
+    {
+        typedef typename DefaultChildContainer<Node>::type type;
+    };
+    template<class Node> struct NodeAllocator
+    {
+        typedef NodeArena<Node> type;
+    };
+    static const bool CACHE_COUNTS = false;
+    static const bool KEEP_PARENT = true;
+    static const bool CACHE_HASHES = false;
+    static const bool KEEP_WEIGHTS = false;
+    static const bool USE_ARENAS = false;
+    static const bool COUNT_OPERATIONS = false;
+};
+
+struct NoParentTrieTraits : TrieNodeTraits
+{
+    static const bool KEEP_PARENT = false;
+};
+
+struct CachingTrieTraits : TrieNodeTraits
+{
+    static const bool CACHE_COUNTS = true;
+    static const bool CACHE_HASHES = true;
+};
+
+struct WeightedTrieTraits : TrieNodeTraits
+{
+    static const bool KEEP_WEIGHTS = true;
+};
+
+struct ArenaTrieTraits : TrieNodeTraits
+{
+    static const bool USE_ARENAS = true;
+};
+
+struct FullTrieTraits : TrieNodeTraits
+{
+    static const bool CACHE_COUNTS = true;
+    static const bool CACHE_HASHES = true;
+    static const bool KEEP_WEIGHTS = true;
+    static const bool USE_ARENAS = true;
+};
+
+struct VectorChildTrieTraits : TrieNodeTraits
+{
+    template<class Node> struct ChildContainer
+    {
+        typedef std::vector<Node *> type;
+    };
+};
+
+struct OperationCountingTrieTraits : TrieNodeTraits
+{
+    static const bool COUNT_OPERATIONS = true;
+};
+
+struct CompactTrieTraits : TrieNodeTraits
+{
+    static const bool CACHE_COUNTS = false;
+    static const bool KEEP_PARENT = false;
+    static const bool CACHE_HASHES = false;
+    static const bool KEEP_WEIGHTS = false;
+    static const bool USE_ARENAS = false;
+};
+
+/**
+ * Where a TrieNode keeps its parent pointer (a base class, so that it takes no room
+ * at all without KEEP_PARENT). Without it, parentLink() is always NULL.
+ */
+template<class Node, bool KEEP_PARENT> class TrieParentLink
+{
+protected:
+    TrieParentLink() : parent(NULL) {}
+    Node *parentLink() const { return parent; }
+    void linkParent(Node *parent) { this->parent = parent; }
+
+private:
+    Node *parent;
+};
+
+template<class Node> class TrieParentLink<Node, false>
+{
+protected:
+    Node *parentLink() const { return NULL; }
+    void linkParent(Node *) {}
+};
+
+/**
+ * Where a TrieNode caches the size of its subtree (a base class, like TrieParentLink).
+ * Without CACHE_COUNTS, nothing is stored: the cached counts read as 0 and changes to
+ * them are dropped, so the deltas TrieNode passes up the Trie all come out as 0.
+ */
+template<bool CACHE_COUNTS> class TrieCountCache
+{
+protected:
+    TrieCountCache() : subtreeSize(1), numKeys(0) {}
+    uint64_t countedNodes() const { return subtreeSize; }
+    uint64_t countedKeys() const { return numKeys; }
+    void setCounts(uint64_t nodes, uint64_t keys) { subtreeSize = nodes; numKeys = keys; }
+    void addCounts(int64_t nodesDelta, int64_t keysDelta) { subtreeSize += nodesDelta; numKeys += keysDelta; }
+
+private:
+    uint64_t subtreeSize;   // TrieNodes in this subtree, including this one
+    uint64_t numKeys;       // end-of-key TrieNodes in this subtree, including this one
+};
+
+template<> class TrieCountCache<false>
+{
+protected:
+    uint64_t countedNodes() const { return 0; }
+    uint64_t countedKeys() const { return 0; }
+    void setCounts(uint64_t, uint64_t) {}
+    void addCounts(int64_t, int64_t) {}
+};
+
+/**
+ * Where a TrieNode caches the structural hash of its subtree (a base class, like
+ * TrieParentLink). 0 means "not computed"; without CACHE_HASHES, that is all it ever
+ * reads as.
+ */
+template<bool CACHE_HASHES> class TrieHashCache
+{
+protected:
+    TrieHashCache() : hash(0) {}
+    uint64_t cachedHash() const { return hash; }
+    void cacheHash(uint64_t hash) { this->hash = hash; }
+
+private:
+    uint64_t hash;
+};
+
+template<> class TrieHashCache<false>
+{
+protected:
+    uint64_t cachedHash() const { return 0; }
+    void cacheHash(uint64_t) {}
+};
+
+/**
+ * Where a TrieNode keeps the weight of its key and the best weight of any key in its
+ * subtree (-infinity if there is none). Without KEEP_WEIGHTS, every weight reads as 0
+ * and changes to them are dropped.
+ */
+template<bool KEEP_WEIGHTS> class TrieWeights
+{
+protected:
+    TrieWeights() : weight(0), maxWeight(-std::numeric_limits<double>::infinity()) {}
+    double keyWeight() const { return weight; }
+    void setKeyWeight(double weight) { this->weight = weight; }
+    double bestWeight() const { return maxWeight; }
+    void setBestWeight(double weight) { maxWeight = weight; }
+
+private:
+    double weight;          // weight of the key ending here (see src/weight.h)
+    double maxWeight;       // best weight of any key in this subtree
+};
+
+template<> class TrieWeights<false>
+{
+protected:
+    double keyWeight() const { return 0; }
+    void setKeyWeight(double) {}
+    double bestWeight() const { return 0; }
+    void setBestWeight(double) {}
+};
+
+/**
+ * Where a TrieNode keeps the arena its children are carved from (NULL for the global
+ * heap). Without USE_ARENAS, it is always NULL.
+ */
+template<class Arena, bool USE_ARENAS> class TrieArenaLink
+{
+protected:
+    TrieArenaLink() : arena(NULL) {}
+    Arena *arenaLink() const { return arena; }
+    void linkArena(Arena *arena) { this->arena = arena; }
+
+private:
+    Arena *arena;
+};
+
+template<class Arena> class TrieArenaLink<Arena, false>
+{
+protected:
+    Arena *arenaLink() const { return NULL; }
+    void linkArena(Arena *) {}
+};
+
+/**
+ * The ancestors of the TrieNode a walk is at (see src/iterator.h): the position of
+ * every TrieNode on the path among its parent's children, and, without parent
+ * pointers, the TrieNodes between the root of the walk and the current one as well.
+ */
+template<class Node, bool KEEP_PARENT> struct TrieAncestors
+{
+    std::vector<size_t> positions;
+
+    Node *parentOf(Node *node) const { return node->parentLink(); }
+    size_t position() const { return positions.back(); }
+    void descended(Node *, size_t position) { positions.push_back(position); }
+    void movedTo(size_t position) { positions.back() = position; }
+    void ascended() { positions.pop_back(); }
+};
+
+template<class Node> struct TrieAncestors<Node, false>
+{
+    std::vector<Node *> path;
+    std::vector<size_t> positions;
+
+    Node *parentOf(Node *) const { return path.back(); }
+    size_t position() const { return positions.back(); }
+    void descended(Node *parent, size_t position) { path.push_back(parent); positions.push_back(position); }
+    void movedTo(size_t position) { positions.back() = position; }
+    void ascended() { path.pop_back(); positions.pop_back(); }
+};
+
+/**
+ * TrieNode itself is defined in trieNode.h; the helper headers name it through here.
+ */
+template<class T, class Traits = TrieNodeTraits> class TrieNode;
+
+#endif // SRC_TRIE_NODE_TRAITS_H
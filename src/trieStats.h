@@ -0,0 +1,145 @@
+#ifndef SRC_TRIE_STATS_H
+#define SRC_TRIE_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * HIGH-LEVEL OVERVIEW:
+ *      What TrieNode::stats() reports about a subtree: its shape and the memory it
+ *      uses. See src/stats.h.
+ *
+ * DETAILS:
+ *      Histograms are indexed by the quantity they count: depthHistogram[d] is the
+ *      number of TrieNodes d levels below the root, fanoutHistogram[f] the number
+ *      with f children, and chainHistogram[n] the number of single-child chains of n
+ *      TrieNodes - runs of TrieNodes with exactly one child that end no key, which a
+ *      RadixTrieNode would store as one label.
+ *
+ *      Bytes are what the subtree owns on the heap: the TrieNodes themselves (with the
+ *      arena header in front of each, see src/arena.h), the heap buffers of their
+ *      children lists (split into the part in use and the unused capacity; children
+ *      kept inline, see src/childList.h, are part of the TrieNode), their child
+ *      indexes (for a ByteChildList, the keys and table in its block), and what the
+ *      values allocate beyond sizeof(T) (std::string only;
+ *      other types are counted as sizeof(T), inside the TrieNodes). Hash tables are
+ *      estimated from their bucket and element counts.
+ *
+ *      childIndexNodeBytes is the part of nodeBytes that the child indexes take up
+ *      inside the TrieNodes (sizeof the index, in every TrieNode; 0 where the children
+ *      index themselves), so that it can be weighed against what the indexes save; it
+ *      is not counted twice in totalBytes().
+ */
+struct TrieStats
+{
+    uint64_t numNodes;
+    uint64_t numKeys;
+    uint64_t numLeaves;
+    uint64_t maxDepth;
+    std::vector<uint64_t> depthHistogram;
+    std::vector<uint64_t> fanoutHistogram;
+    std::vector<uint64_t> chainHistogram;
+
+    uint64_t nodeBytes;
+    uint64_t childVectorBytes;      // children pointers in use, in heap buffers
+    uint64_t childSlackBytes;       // children capacity not in use
+    uint64_t childIndexBytes;       // allocated by child indexes
+    uint64_t childIndexNodeBytes;   // child indexes inside the TrieNodes (part of nodeBytes)
+    uint64_t valueBytes;            // allocated by the values themselves
+
+    TrieStats() : numNodes(0), numKeys(0), numLeaves(0), maxDepth(0), nodeBytes(0), childVectorBytes(0),
+        childSlackBytes(0), childIndexBytes(0), childIndexNodeBytes(0), valueBytes(0) {}
+
+    uint64_t totalBytes() const
+    {
+        return nodeBytes + childVectorBytes + childSlackBytes + childIndexBytes + valueBytes;
+    }
+
+    /**
+     * Add one to histogram[bucket], growing it as needed.
+     */
+    static void count(std::vector<uint64_t> &histogram, size_t bucket)
+    {
+        if (histogram.size() <= bucket) {
+            histogram.resize(bucket + 1);
+        }
+        histogram[bucket]++;
+    }
+
+    /**
+     * Return the number of bytes value allocated beyond sizeof(value): nothing in
+     * general, and the buffer of a std::string too long for its inline storage.
+     */
+    template<class V> static uint64_t heapBytesOf(const V &)
+    {
+        return 0;
+    }
+    static uint64_t heapBytesOf(const std::string &value)
+    {
+        uintptr_t data = reinterpret_cast<uintptr_t>(value.data());
+        uintptr_t self = reinterpret_cast<uintptr_t>(&value);
+        bool isInline = data >= self && data < self + sizeof(value);
+        return isInline ? 0 : value.capacity() + 1;
+    }
+};
+
+/**
+ * Process-wide operation counters, shared by every TrieNode type that counts its
+ * operations (Traits::COUNT_OPERATIONS, see src/trieNodeTraits.h). For the others,
+ * TRIE_COUNT compiles to nothing. Being a template switch rather than a macro, it
+ * lets counting and non-counting Tries live in the same program.
+ *      lookups      - calls to find()
+ *      misses       - calls to find() that returned NULL
+ *      inserts      - keys inserted through insert()
+ *      childLookups - lookups of a child by value, from every operation
+ *      childScans   - children compared one by one during those lookups (the linear
+ *                     tiers of the child indexes; the others look up directly)
+ */
+struct TrieCounters
+{
+    std::atomic<uint64_t> lookups;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> inserts;
+    std::atomic<uint64_t> childLookups;
+    std::atomic<uint64_t> childScans;
+
+    static TrieCounters &instance()
+    {
+        static TrieCounters counters;
+        return counters;
+    }
+
+    void reset()
+    {
+        lookups = 0;
+        misses = 0;
+        inserts = 0;
+        childLookups = 0;
+        childScans = 0;
+    }
+
+    /**
+     * Add n to the given counter if ENABLED; do nothing (at compile time) otherwise.
+     */
+    template<bool ENABLED> static void add(std::atomic<uint64_t> TrieCounters::*counter, uint64_t n)
+    {
+        add(counter, n, std::integral_constant<bool, ENABLED>());
+    }
+
+private:
+    TrieCounters() : lookups(0), misses(0), inserts(0), childLookups(0), childScans(0) {}
+
+    static void add(std::atomic<uint64_t> TrieCounters::*counter, uint64_t n, std::true_type)
+    {
+        (instance().*counter).fetch_add(n, std::memory_order_relaxed);
+    }
+    static void add(std::atomic<uint64_t> TrieCounters::*, uint64_t, std::false_type) {}
+};
+
+#define TRIE_COUNT(ENABLED, counter, n) TrieCounters::add<ENABLED>(&TrieCounters::counter, (n))
+
+#endif // SRC_TRIE_STATS_H
@@ -0,0 +1,195 @@
+#ifndef SRC_WEIGHT_H
+#define SRC_WEIGHT_H
+
+/**
+ * Every key carries a weight (a score, eg. how often it was searched for), 0 unless
+ * set otherwise. Each TrieNode also keeps the best weight of any key in its subtree,
+ * kept up to date along with the counts: raising a weight only walks up until an
+ * ancestor already has something at least as good, and lowering or removing one only
+ * rescans the children of the ancestors whose best weight it was. topK uses it to
+ * go straight to the best keys below a prefix.
+ *
+ * When Tries are merged, a key stored in both keeps the larger of its two weights.
+ * Weights belong to TrieNode Tries only; FrozenTrie, MappedTrie and PersistentTrie
+ * copy the keys without them. TrieNodes without Traits::KEEP_WEIGHTS have no weights
+ * either: every key weighs 0, and the best weights are not kept.
+ */
+
+/**
+ * Helper method - the best weight of a subtree without any keys; lower than any
+ * real weight.
+ */
+template<class T, class Traits> double TrieNode<T, Traits>::NO_WEIGHT()
+{
+    return -std::numeric_limits<double>::infinity();
+}
+
+/**
+ * Helper method - a key with the given weight is now stored below this TrieNode;
+ * raise the best weight of this TrieNode and its ancestors to it where needed.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::raiseMaxWeight(double weight)
+{
+    if (!Traits::KEEP_WEIGHTS) {
+        return;
+    }
+    for (TrieNode<T, Traits> *node = this; node != NULL && node->bestWeight() < weight; node = node->parentLink()) {
+        node->setBestWeight(weight);
+    }
+}
+
+/**
+ * Helper method - recompute the best weight of this TrieNode from its own and its
+ * children's, after a key below it was removed or lost weight, and pass any change on
+ * to its ancestors.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::refreshMaxWeight()
+{
+    if (!Traits::KEEP_WEIGHTS) {
+        return;
+    }
+    for (TrieNode<T, Traits> *node = this; node != NULL; node = node->parentLink()) {
+        double best = node->endOfKey ? node->keyWeight() : NO_WEIGHT();
+        for (int i = 0; i < node->getNumChildren(); i++) {
+            best = std::max(best, node->children[i]->bestWeight());
+        }
+        if (best == node->bestWeight()) {
+            return;
+        }
+        node->setBestWeight(best);
+    }
+}
+
+/**
+ * Helper method - used in merges: a key that ends at source also ends at this
+ * TrieNode afterwards, with the larger weight if it already did. Counts and best
+ * weights are left to the caller.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::mergeEndOfKey(TrieNode<T, Traits> &source)
+{
+    if (!source.endOfKey) {
+        return;
+    }
+    this->setKeyWeight(endOfKey ? std::max(this->keyWeight(), source.keyWeight()) : source.keyWeight());
+    endOfKey = true;
+}
+
+/**
+ * Return the weight of the key that ends at this TrieNode.
+ */
+template<class T, class Traits> double TrieNode<T, Traits>::getWeight()
+{
+    return this->keyWeight();
+}
+
+/**
+ * Set the weight of the key that ends at this TrieNode. If no key ends here, the
+ * weight is kept for when one does. Weights need parent pointers (see
+ * src/trieNodeTraits.h): the best weights of all the ancestors depend on this one.
+ */
+template<class T, class Traits> void TrieNode<T, Traits>::setWeight(double weight)
+{
+    static_assert(Traits::KEEP_PARENT, "setWeight() needs Traits::KEEP_PARENT");
+    static_assert(Traits::KEEP_WEIGHTS, "setWeight() needs Traits::KEEP_WEIGHTS");
+    double oldWeight = this->keyWeight();
+    this->setKeyWeight(weight);
+    if (!endOfKey || weight == oldWeight) {
+        return;
+    }
+    invalidateHash();
+    if (weight > oldWeight) {
+        raiseMaxWeight(weight);
+    }
+    else {
+        refreshMaxWeight();
+    }
+}
+
+/**
+ * Insert the given key with the given weight (replacing its weight if the key was
+ * already stored). Return the node at which the key ends.
+ */
+template<class T, class Traits> template<class Key>
+TrieNode<T, Traits> *TrieNode<T, Traits>::insert(const Key &key, double weight)
+{
+    TrieNode<T, Traits> *node = insert(std::begin(key), std::end(key));
+    node->setWeight(weight);
+    return node;
+}
+
+/**
+ * Return the (at most) k heaviest keys that start with the given prefix, with their
+ * weights, heaviest first (keys of equal weight in no particular order, but the
+ * same one every time for the same Trie). Keys are relative to this TrieNode, and
+ * include the prefix.
+ *
+ * Best-first search: a priority queue holds subtrees, ranked by their best weight,
+ * and keys, ranked by their own. Whenever a key comes out on top, nothing left in
+ * the queue can beat it. Only the nodes on the way to the k results (and their
+ * children) are ever looked at, so the cost depends on k, the key length and the
+ * number of children per node - not on how many keys share the prefix.
+ */
+template<class T, class Traits> template<class Key>
+std::vector<std::pair<std::vector<T>, double> > TrieNode<T, Traits>::topK(const Key &prefix, size_t k)
+{
+    static_assert(Traits::KEEP_PARENT, "topK() needs Traits::KEEP_PARENT");
+    static_assert(Traits::KEEP_WEIGHTS, "topK() needs Traits::KEEP_WEIGHTS");
+    std::vector<std::pair<std::vector<T>, double> > results;
+    auto first = std::begin(prefix);
+    TrieNode<T, Traits> *start = descend(first, std::end(prefix));
+    if (first != std::end(prefix) || k == 0 || start->bestWeight() == NO_WEIGHT()) {
+        return results;
+    }
+
+    struct Candidate
+    {
+        double weight;
+        uint64_t order;         // ties go to the candidate found first
+        bool isKey;             // the key ending at node, as opposed to its whole subtree
+        TrieNode<T, Traits> *node;
+
+        bool operator<(const Candidate &other) const
+        {
+            if (weight != other.weight) {
+                return weight < other.weight;
+            }
+            return order > other.order;
+        }
+    };
+    std::priority_queue<Candidate> queue;
+    uint64_t numFound = 0;
+    Candidate top = { start->bestWeight(), numFound++, false, start };
+    queue.push(top);
+
+    std::vector<T> suffix;
+    while (!queue.empty() && results.size() < k) {
+        top = queue.top();
+        queue.pop();
+        TrieNode<T, Traits> *node = top.node;
+        if (top.isKey) {
+            // Spell the key by walking up to the start, then put the prefix in front.
+            suffix.clear();
+            for (TrieNode<T, Traits> *n = node; n != start; n = n->parentLink()) {
+                suffix.push_back(n->value);
+            }
+            results.push_back(std::make_pair(std::vector<T>(std::begin(prefix), std::end(prefix)), top.weight));
+            results.back().first.insert(results.back().first.end(), suffix.rbegin(), suffix.rend());
+            continue;
+        }
+        // Replace the subtree with the key ending here (if any) and the child subtrees.
+        if (node->endOfKey) {
+            Candidate key = { node->keyWeight(), numFound++, true, node };
+            queue.push(key);
+        }
+        for (int i = 0; i < node->getNumChildren(); i++) {
+            TrieNode<T, Traits> *child = node->children[i];
+            if (child->bestWeight() != NO_WEIGHT()) {
+                Candidate subtree = { child->bestWeight(), numFound++, false, child };
+                queue.push(subtree);
+            }
+        }
+    }
+    return results;
+}
+
+#endif // SRC_WEIGHT_H
@@ -1,8 +1,13 @@
 #include <cstdlib>
 #include <ctime>
 #include <cassert>
+#include <fstream>
+#include <map>
+#include <set>
 
 #include "trieNode.h"
+#include "radixTrieNode.h"
+#include "concurrentTrieNode.h"
 
 using namespace std;
 
@@ -149,6 +154,2051 @@ void testMerge()
     delete three;
 }
 
+void testPathOperations()
+{
+    TrieNode<char> *root = new TrieNode<char>();
+    root->insert(string("car"));
+    root->insert(string("cart"));
+    TrieNode<char> *dog = root->insert(string("dog"));
+    // Check if:
+    //      (a) shared prefixes were not duplicated ("car" + "t", "dog" = 8 nodes incl. root)
+    //      (b) re-inserting an existing key returns the same node
+    assert(root->size() == 8 && root->getNumChildren() == 2 && root->insert(string("dog")) == dog);
+
+    // Exact lookups only succeed for stored keys, not for mere prefixes.
+    assert(root->find(string("dog")) == dog && dog->isEndOfKey());
+    assert(root->find(string("ca")) == NULL && root->find(string("cartoon")) == NULL);
+    assert(root->isPrefix(string("ca")) && root->isPrefix(string("cart")) && root->isPrefix(string("")) &&
+        !root->isPrefix(string("cat")));
+
+    // Longest-prefix match returns the deepest stored key along the path.
+    size_t length = 0;
+    TrieNode<char> *match = root->longestPrefix(string("cartography"), &length);
+    assert(match != NULL && match->getValue() == 't' && length == 4);
+    match = root->longestPrefix(string("carp"), &length);
+    assert(match == root->find(string("car")) && length == 3);
+    assert(root->longestPrefix(string("cow")) == NULL);
+
+    // Keys do not have to be strings.
+    TrieNode<int> *numbers = new TrieNode<int>();
+    vector<int> key;
+    key.push_back(4);
+    key.push_back(8);
+    numbers->insert(key);
+    assert(numbers->find(key) != NULL && numbers->isPrefix(vector<int>(1, 4)) &&
+        numbers->find(vector<int>(1, 4)) == NULL);
+
+    // End-of-key markers take part in cloning and comparisons.
+    TrieNode<char> *clone = root->clone();
+    assert(*clone == *root && clone->find(string("cart")) != NULL);
+    clone->find(string("cart"))->setEndOfKey(false);
+    assert(*clone != *root);
+
+    cout << "testPathOperations passed." << endl;
+    delete root;
+    delete numbers;
+    delete clone;
+}
+
+void testWideNode()
+{
+    // Enough children to move the child index through all of its forms.
+    const int NUM_CHILDREN = 1000;
+    TrieNode<int> *root = new TrieNode<int>(-1);
+    for (int i = NUM_CHILDREN - 1; i >= 0; i--) {
+        *root << i;
+        *root << i; // duplicate, must be ignored
+    }
+    // Children keep their insertion order, and every one of them can be found.
+    assert(root->getNumChildren() == NUM_CHILDREN && root->size() == NUM_CHILDREN + 1);
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        assert(root->getChildAtIndex(i)->getValue() == NUM_CHILDREN - 1 - i);
+        assert(root->getIndexOfChild(i) == NUM_CHILDREN - 1 - i && (*root)[i]->getValue() == i);
+    }
+    assert(!root->hasChild(NUM_CHILDREN) && root->getIndexOfChild(-5) == -1);
+
+    // Replacing a child re-indexes it under its new value.
+    TrieNode<int> *replacement = new TrieNode<int>(NUM_CHILDREN);
+    TrieNode<int> *replaced = root->getChildAtIndex(0);
+    root->setChildAtIndex(0, replacement);
+    assert(root->getIndexOfChild(NUM_CHILDREN) == 0 && !root->hasChild(NUM_CHILDREN - 1));
+    delete replaced;
+
+    // Remove all but a few children, shrinking the index back, and check positions.
+    for (int i = 0; i < NUM_CHILDREN - 5; i++) {
+        delete (*root >> i);
+    }
+    assert(root->getNumChildren() == 5);
+    for (int i = 0; i < 5; i++) {
+        TrieNode<int> *child = root->getChildAtIndex(i);
+        assert(root->getIndexOfChild(child->getValue()) == i);
+    }
+    delete root;
+
+    // Same for non-trivial values.
+    TrieNode<string> *words = new TrieNode<string>("");
+    for (int i = 0; i < 200; i++) {
+        stringstream word;
+        word << "w" << i;
+        *words << word.str();
+    }
+    assert(words->getNumChildren() == 200 && words->hasChild(string("w0")) &&
+        words->getIndexOfChild("w150") == 150 && !words->hasChild(string("w200")));
+    delete (*words >> string("w0"));
+    assert(words->getIndexOfChild("w150") == 149 && !words->hasChild(string("w0")));
+    delete words;
+
+    cout << "testWideNode passed." << endl;
+}
+
+void testByteNode()
+{
+    // Grow a TrieNode<char> through every way its ByteChildList finds children (inline,
+    // key scan, SSE2 compare, table), then shrink it back, checking every lookup against
+    // the children's actual positions.
+    TrieNode<char> *root = new TrieNode<char>('*');
+    for (int i = 0; i < 256; i++) {
+        *root << (char) ((i * 7) % 256); // 7 is coprime with 256, so all 256 values appear
+        assert(root->getNumChildren() == i + 1);
+        for (int j = 0; j <= i; j++) {
+            assert(root->getIndexOfChild(root->getChildAtIndex(j)->getValue()) == j);
+        }
+    }
+    *root << 'a';
+    assert(root->getNumChildren() == 256);
+
+    for (int i = 0; i < 256; i++) {
+        char c = (char) ((i * 13) % 256);
+        delete (*root >> c);
+        assert(!root->hasChild(c) && root->getNumChildren() == 255 - i);
+        for (int j = 0; j < root->getNumChildren(); j++) {
+            assert(root->getIndexOfChild(root->getChildAtIndex(j)->getValue()) == j);
+        }
+    }
+    assert(root->isSingleton());
+
+    // Path operations go through the same layouts.
+    root->insert(string("\xff\x80\x01"));
+    assert(root->find(string("\xff\x80\x01")) != NULL && root->find(string("\xff\x80")) == NULL);
+
+    cout << "testByteNode passed." << endl;
+    delete root;
+}
+
+/**
+ * Helper method - check that every child of tn is found under its own value, at its
+ * own position.
+ */
+template<class T> bool childrenAreIndexed(TrieNode<T> *tn)
+{
+    for (int i = 0; i < tn->getNumChildren(); i++) {
+        if (tn->getIndexOfChild(tn->getChildAtIndex(i)->getValue()) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Helper method - rename the child with value "from" to "to" (which no other child
+ * has), then try to rename it to "taken" (which another child has).
+ */
+template<class T> void checkRenameChild(TrieNode<T> *tn, const T &from, const T &to, const T &taken)
+{
+    TrieNode<T> *child = (*tn)[from];
+    int position = tn->getIndexOfChild(from);
+    assert(child != NULL && !tn->hasChild(to) && tn->hasChild(taken));
+
+    assert(child->setValue(to) && child->getValue() == to);
+    assert(tn->hasChild(to) && !tn->hasChild(from) && (*tn)[to] == child && (*tn)[from] == NULL);
+    assert(tn->getIndexOfChild(to) == position && childrenAreIndexed(tn));
+
+    // Duplicates are still rejected, both by addChild and by setValue.
+    TrieNode<T> *duplicate = new TrieNode<T>(to);
+    assert(!tn->addChild(duplicate));
+    delete duplicate;
+    assert(!child->setValue(taken) && child->getValue() == to && (*tn)[to] == child);
+    assert(child->setValue(to) && childrenAreIndexed(tn));
+}
+
+void testRenameChild()
+{
+    // A single child of a TrieNode<char>, and then one of many.
+    TrieNode<char> *letters = new TrieNode<char>('*');
+    letters->insert(string("a"));
+    letters->insert(string("b"));
+    (*letters)['b']->setValue('c');
+    assert(letters->hasChild('c') && !letters->hasChild('b') && letters->find(string("c")) != NULL);
+    for (char c = 'd'; c <= 'z'; c++) {
+        *letters << c;
+    }
+    checkRenameChild<char>(letters, 'q', '0', 'x');
+    delete letters;
+
+    // More than 8 children (sorted index) and more than 64 (hashed index).
+    for (int numChildren = 20; numChildren <= 200; numChildren += 180) {
+        TrieNode<int> *numbers = new TrieNode<int>(-1);
+        for (int i = 0; i < numChildren; i++) {
+            *numbers << i;
+        }
+        checkRenameChild<int>(numbers, 0, 100 * numChildren, numChildren - 1);
+        checkRenameChild<int>(numbers, numChildren / 2, -7, 1);
+        delete numbers;
+    }
+
+    TrieNode<string> *words = new TrieNode<string>("");
+    for (int i = 0; i < 100; i++) {
+        stringstream word;
+        word << "w" << i;
+        *words << word.str();
+    }
+    checkRenameChild<string>(words, "w42", "renamed", "w7");
+    delete words;
+
+    cout << "testRenameChild passed." << endl;
+}
+
+void testArena()
+{
+    typedef TrieNode<char, ArenaTrieTraits> ArenaNode;
+    ArenaNode *root = new ArenaNode();
+    assert(root->useArena(64) && !root->useArena());
+    NodeArena<ArenaNode> *arena = root->getArena();
+
+    // All nodes created below the root are carved from its arena.
+    root->insert(string("arena"));
+    root->insert(string("area"));
+    *root << 'z';
+    assert(arena->getNumNodes() == 7 && root->size() == 8);
+    assert(root->find(string("area"))->getArena() == arena);
+
+    // Removed nodes are recycled by later insertions instead of growing the arena.
+    delete (*root >> 'z');
+    assert(arena->getNumNodes() == 6);
+    *root << 'y';
+    assert(arena->getNumNodes() == 7 && root->hasChild('y'));
+
+    // Nodes from the heap can still be attached; they are freed normally.
+    ArenaNode *heapChild = new ArenaNode(root->find(string("arena")), 's');
+    *heapChild << 't';
+    assert(root->isPrefix(string("arenast")) && heapChild->getArena() == NULL);
+
+    // Merging copies other's nodes into this Trie's arena; cloning does not.
+    ArenaNode *other = new ArenaNode();
+    other->insert(string("art"));
+    other->insert(string("bee"));
+    *root += *other;
+    assert(root->find(string("art")) != NULL && root->find(string("bee"))->getArena() == arena);
+    ArenaNode *clone = root->clone();
+    assert(*clone == *root && clone->getArena() == NULL);
+
+    // Enough nodes to span several blocks; the root's destructor frees them all at once.
+    for (int i = 0; i < 1000; i++) {
+        stringstream key;
+        key << i;
+        root->insert(key.str());
+    }
+    assert(arena->getNumNodes() == (size_t) root->size() - 3); // root, 's' and 't' are not arena nodes
+    ArenaNode onStack('s');
+    assert(arena->owns(root->find(string("999"))) && !arena->owns(heapChild) && !arena->owns(&onStack) &&
+        !arena->owns(root) && !arena->owns(clone->find(string("arena"))));
+
+    cout << "testArena passed." << endl;
+    delete root;
+    delete other;
+    delete clone;
+}
+
+/**
+ * Count the nodes and keys below tn by walking the Trie, for checking cached counts.
+ */
+template<class T, class Traits> void countByWalking(TrieNode<T, Traits> *tn, uint64_t &nodes, uint64_t &keys)
+{
+    nodes = keys = 0;
+    vector<TrieNode<T, Traits> *> pending(1, tn);
+    while (!pending.empty()) {
+        TrieNode<T, Traits> *node = pending.back();
+        pending.pop_back();
+        nodes++;
+        keys += node->isEndOfKey() ? 1 : 0;
+        for (int i = 0; i < node->getNumChildren(); i++) {
+            pending.push_back(node->getChildAtIndex(i));
+        }
+    }
+}
+
+template<class T, class Traits> bool countsAreConsistent(TrieNode<T, Traits> *tn)
+{
+    uint64_t nodes, keys;
+    countByWalking(tn, nodes, keys);
+    return tn->size() == nodes && tn->getNumKeys() == keys;
+}
+
+/**
+ * Helper method - check the counts of a TrieNode<char, Traits> after every kind of
+ * modification, whether they are cached or counted when asked for.
+ */
+template<class Traits> void checkCounts()
+{
+    typedef TrieNode<char, Traits> Node;
+    const char *WORDS[] = { "tea", "ten", "tee", "to", "inn", "in", "i", "tea" };
+    Node *root = new Node();
+    for (int i = 0; i < 8; i++) {
+        root->insert(string(WORDS[i]));
+        assert(countsAreConsistent(root));
+    }
+    // "tea" was inserted twice, but is one key.
+    assert(root->size() == 10 && root->getNumKeys() == 7);
+    assert(root->countKeysWithPrefix(string("te")) == 3 && root->countKeysWithPrefix(string("in")) == 2 &&
+        root->countKeysWithPrefix(string("")) == 7 && root->countKeysWithPrefix(string("x")) == 0);
+
+    // Counts follow every kind of modification up to the root.
+    Node *t = (*root)['t'];
+    t->find(string("o"))->setEndOfKey(false);
+    assert(countsAreConsistent(root) && root->getNumKeys() == 6);
+    Node *removed = *((*t)['e']) >> 'n';
+    assert(countsAreConsistent(root) && root->size() == 9 && removed->getParent() == NULL);
+    *removed << 'x';
+    assert(countsAreConsistent(root) && countsAreConsistent(removed) && root->size() == 9);
+    delete removed;
+
+    Node *replacement = new Node('o');
+    replacement->insert(string("ne"));
+    Node *old = t->getChildAtIndex(t->getIndexOfChild('o'));
+    t->setChildAtIndex(t->getIndexOfChild('o'), replacement);
+    assert(countsAreConsistent(root) && replacement->getParent() == t && old->getParent() == NULL);
+    delete old;
+
+    Node *other = new Node();
+    other->insert(string("tone"));
+    other->insert(string("top"));
+    other->insert(string("zoo"));
+    *root += *other;
+    assert(countsAreConsistent(root) && root->countKeysWithPrefix(string("to")) == 2);
+
+    Node *clone = root->clone();
+    assert(countsAreConsistent(clone) && clone->size() == root->size());
+
+    (*root)['i']->clear();
+    assert(countsAreConsistent(root) && root->countKeysWithPrefix(string("i")) == 1);
+
+    delete root;
+    delete other;
+    delete clone;
+}
+
+void testCounts()
+{
+    checkCounts<TrieNodeTraits>();
+    checkCounts<CachingTrieTraits>();
+    cout << "testCounts passed." << endl;
+}
+
+/**
+ * Build a Trie holding numKeys random lowercase keys of up to maxLength characters.
+ */
+template<class Traits = TrieNodeTraits> TrieNode<char, Traits> *randomTrie(char rootValue, int numKeys, int maxLength)
+{
+    TrieNode<char, Traits> *trie = new TrieNode<char, Traits>(rootValue);
+    for (int i = 0; i < numKeys; i++) {
+        string key(1 + rand() % maxLength, ' ');
+        for (size_t j = 0; j < key.size(); j++) {
+            key[j] = 'a' + rand() % 6;
+        }
+        trie->insert(key);
+    }
+    return trie;
+}
+
+/**
+ * Helper method - check moving merges of TrieNode<char, Traits> against copying ones.
+ */
+template<class Traits> void checkMoveMerge()
+{
+    typedef TrieNode<char, Traits> Node;
+    srand(7);
+    for (int round = 0; round < 20; round++) {
+        // The moving merge must produce exactly what the copying merge does.
+        Node *one = randomTrie<Traits>('r', 50, 6);
+        Node *two = randomTrie<Traits>(round % 4 == 0 ? 's' : 'r', 50, 6);
+        Node *expected = one->clone();
+        *expected += *two;
+
+        uint64_t twoSize = two->size();
+        *one += std::move(*two);
+        assert(*one == *expected && countsAreConsistent(one));
+        // other is left as a leaf; all of its nodes were either moved or freed.
+        assert(!two->hasChildren() && two->size() == 1 && countsAreConsistent(two));
+        assert(one->size() <= expected->size() && twoSize > 1);
+
+        delete one;
+        delete two;
+        delete expected;
+    }
+
+    // Merging into a subtree keeps the counts of the subtree's ancestors right.
+    Node *root = randomTrie<Traits>('r', 30, 4);
+    Node *sub = randomTrie<Traits>('a', 30, 4);
+    root->insert(string("a"));
+    *((*root)['a']) += std::move(*sub);
+    assert(countsAreConsistent(root) && sub->isSingleton());
+    delete sub;
+
+    // Nodes from another Trie's arena (if Traits allow arenas) are copied rather than
+    // spliced in.
+    Node *arenaTrie = new Node('r');
+    arenaTrie->useArena(16);
+    arenaTrie->insert(string("zebra"));
+    arenaTrie->insert(string("zoo"));
+    *root += std::move(*arenaTrie);
+    delete arenaTrie;
+    assert(root->find(string("zebra")) != NULL && root->find(string("zoo"))->getArena() == NULL &&
+        countsAreConsistent(root));
+    delete root;
+}
+
+void testMoveMerge()
+{
+    checkMoveMerge<TrieNodeTraits>();
+    checkMoveMerge<FullTrieTraits>();
+    cout << "testMoveMerge passed." << endl;
+}
+
+/**
+ * A word that counts how many times any word was copied, so tests can check which
+ * TrieNode operations copy values.
+ */
+struct CountedWord
+{
+    static int copies;
+    string text;
+
+    CountedWord() {}
+    CountedWord(const char *text) : text(text) {}
+    CountedWord(const CountedWord &other) : text(other.text) { copies++; }
+    CountedWord(CountedWord &&other) : text(std::move(other.text)) {}
+    CountedWord &operator=(const CountedWord &other) { text = other.text; copies++; return *this; }
+    CountedWord &operator=(CountedWord &&other) { text = std::move(other.text); return *this; }
+    bool operator==(const CountedWord &other) const { return text == other.text; }
+    bool operator!=(const CountedWord &other) const { return text != other.text; }
+    bool operator<(const CountedWord &other) const { return text < other.text; }
+};
+int CountedWord::copies = 0;
+
+void testCopyMove()
+{
+    // Lookups, rvalue insertions and emplaceChild never copy a value.
+    const char *words[] = { "alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta",
+        "iota", "kappa", "lambda", "mu" };
+    TrieNode<CountedWord> *sentence = new TrieNode<CountedWord>();
+    CountedWord::copies = 0;
+    for (int i = 0; i < 12; i++) {
+        *sentence << CountedWord(words[i]);
+    }
+    TrieNode<CountedWord> *lambda = sentence->emplaceChild("lambda");
+    TrieNode<CountedWord> *nu = sentence->emplaceChild("nu");
+    CountedWord alpha("alpha");
+    assert(lambda != NULL && lambda->getValue().text == "lambda" && sentence->getNumChildren() == 13);
+    assert(nu == (*sentence)["nu"] && sentence->hasChild(alpha) && sentence->getIndexOfChild(alpha) == 0);
+    delete (*sentence >> alpha);
+    assert(CountedWord::copies == 0 && sentence->getNumChildren() == 12);
+
+    // Moving a TrieNode moves its value too, unless its parent still finds it by that
+    // value.
+    TrieNode<CountedWord> omega(CountedWord("omega"));
+    TrieNode<CountedWord> movedOmega(std::move(omega));
+    TrieNode<CountedWord> assignedOmega;
+    assignedOmega = std::move(movedOmega);
+    assert(CountedWord::copies == 0 && assignedOmega.getValue().text == "omega");
+    TrieNode<CountedWord> beta(std::move(*(*sentence)["beta"]));
+    assert(CountedWord::copies == 1 && beta.getValue().text == "beta" && sentence->hasChild(CountedWord("beta")));
+    delete sentence;
+
+    // Assigning to a child re-indexes it in its parent under its new value, unless a
+    // sibling already has that value.
+    TrieNode<char> letters('*');
+    letters << 'x' << 'y';
+    *letters['x'] = TrieNode<char>('q');
+    assert(letters['x'] == NULL && letters['q'] != NULL && letters['q']->getValue() == 'q');
+    *letters['q'] = TrieNode<char>('y');
+    assert(letters['q']->getValue() == 'q' && letters['y'] != letters['q'] && childrenAreIndexed(&letters));
+    // ... and then other keeps its value too, rather than losing it to the move.
+    TrieNode<string> names("");
+    names << "a" << "b";
+    TrieNode<string> named("b");
+    named << "x";
+    *names["a"] = std::move(named);
+    assert(names["a"]->getValue() == "a" && names["a"]->hasChild(string("x")) && named.getValue() == "b");
+    assert(named.isSingleton() && names.size() == 4 && !names["b"]->hasChildren());
+
+    // Moves only allocate to copy values or arena nodes, so they are noexcept without
+    // either; a vector of TrieNodes then moves them when it grows.
+    static_assert(std::is_nothrow_move_constructible<TrieNode<char> >::value &&
+        std::is_nothrow_move_assignable<TrieNode<int> >::value, "moves should be noexcept");
+    static_assert(!std::is_nothrow_move_constructible<TrieNode<string> >::value &&
+        !std::is_nothrow_move_assignable<TrieNode<char, ArenaTrieTraits> >::value, "moves may copy");
+    vector<TrieNode<char> > forest;
+    for (char c = 'a'; c < 'a' + 20; c++) {
+        forest.push_back(TrieNode<char>(c));
+        forest.back().insert(string("xy"));
+    }
+    for (size_t i = 0; i < forest.size(); i++) {
+        assert(forest[i].getValue() == 'a' + (int) i && forest[i].find(string("xy")) != NULL && forest[i].size() == 3);
+        assert(forest[i]['x']->getParent() == &forest[i]);
+    }
+
+    // The rest needs weights and arenas.
+    typedef TrieNode<char, FullTrieTraits> FullNode;
+    srand(13);
+    FullNode *original = randomTrie<FullTrieTraits>('r', 200, 6);
+    original->setWeight(2.0);
+    original->setEndOfKey(true);
+
+    // Copies are deep and independent of the original.
+    FullNode copy(*original);
+    assert(copy == *original && copy.getParent() == NULL && countsAreConsistent(&copy));
+    copy.insert(string("zzz"));
+    assert(copy != *original && original->find(string("zzz")) == NULL);
+    copy = *original;
+    assert(copy == *original && countsAreConsistent(&copy) && copy.getWeight() == 2.0);
+
+    // A move takes the whole subtree and leaves the source as a leaf.
+    uint64_t size = original->size();
+    FullNode moved(std::move(copy));
+    assert(moved == *original && countsAreConsistent(&moved) && moved.getWeight() == 2.0);
+    assert(copy.isSingleton() && copy.getValue() == 'r' && countsAreConsistent(&copy));
+
+    // Assigning to (and moving from) nodes inside a Trie keeps both Tries' counts right.
+    FullNode *other = randomTrie<FullTrieTraits>('s', 100, 5);
+    FullNode *source = moved.getChildAtIndex(0);
+    FullNode *target = other->hasChild(source) ? (*other)[source->getValue()] : other->getChildAtIndex(0);
+    FullNode expected(*source);
+    *target = std::move(*source);
+    assert(*target == expected && target->getParent() == other && !source->hasChildren());
+    assert(countsAreConsistent(other) && countsAreConsistent(&moved) && moved.size() < size);
+    delete other;
+
+    // Moving an arena's root hands the arena over; nodes from another arena are copied.
+    FullNode *arenaTrie = new FullNode('a');
+    arenaTrie->useArena(16);
+    arenaTrie->insert(string("bc"));
+    arenaTrie->insert(string("bd"));
+    FullNode arenaMoved(std::move(*arenaTrie));
+    assert(arenaMoved.getArena() != NULL && arenaMoved.getArena()->getRoot() == &arenaMoved);
+    assert(arenaTrie->getArena() == NULL && !arenaTrie->hasChildren());
+    delete arenaTrie;
+    FullNode fromArena(std::move(*arenaMoved['b']));
+    assert(fromArena.find(string("c")) != NULL && fromArena.getArena() == NULL);
+    assert(countsAreConsistent(&fromArena) && countsAreConsistent(&arenaMoved) && arenaMoved.size() == 2);
+
+    delete original;
+    cout << "testCopyMove passed." << endl;
+}
+
+/**
+ * Return true if tn's cached hash matches one computed from scratch, on a copy that
+ * has no cached hashes yet.
+ */
+template<class T, class Traits> bool hashIsFresh(TrieNode<T, Traits> *tn)
+{
+    FrozenTrie<T> *frozen = tn->freeze();
+    TrieNode<T> *copy = frozen->thaw();
+    bool fresh = copy->getHash() == tn->getHash();
+    delete copy;
+    delete frozen;
+    return fresh;
+}
+
+/**
+ * Helper method - check the structural hashes of TrieNode<char, Traits>, and the merges
+ * that rely on them, whether they are cached or computed when asked for.
+ */
+template<class Traits> void checkStructuralHash()
+{
+    typedef TrieNode<char, Traits> Node;
+    srand(31);
+    Node *root = randomTrie<Traits>('r', 500, 6);
+    Node *clone = root->clone();
+    // Check if:
+    //      (a) equal Tries hash equally, and copies keep the cached hashes
+    //      (b) every kind of modification reaches the cached hashes of its ancestors
+    uint64_t original = root->getHash();
+    assert(clone->getHash() == original && *clone == *root && hashIsFresh(root));
+
+    clone->insert(string("zzz"));
+    assert(clone->getHash() != original && *clone != *root && hashIsFresh(clone));
+    delete (*clone >> 'z');
+    assert(clone->getHash() == original && *clone == *root);
+
+    Node *node = (*root)['a'];
+    node->setEndOfKey(!node->isEndOfKey());
+    assert(root->getHash() != original && hashIsFresh(root));
+    node->setEndOfKey(!node->isEndOfKey());
+    assert(root->getHash() == original);
+    node = (*root)['b'];
+    node->getChildAtIndex(0)->setValue('z');
+    assert(root->getHash() != original && hashIsFresh(root) && *root != *clone);
+    node->getChildAtIndex(0)->setValue((*clone)['b']->getChildAtIndex(0)->getValue());
+    assert(root->getHash() == original && *root == *clone);
+    (*root)['c']->clear();
+    assert(hashIsFresh(root) && *root != *clone);
+
+    // Merging skips identical subtrees, but must still give the full result, and
+    // leave hashes that match the merged Trie.
+    *root += *clone;
+    assert(*root == *clone && hashIsFresh(root) && countsAreConsistent(root));
+    Node *other = randomTrie<Traits>('r', 500, 6);
+    Node *expected = root->clone();
+    *expected += *other;
+    *root += std::move(*other);
+    assert(*root == *expected && hashIsFresh(root) && countsAreConsistent(root) && other->size() == 1);
+
+    delete root;
+    delete clone;
+    delete other;
+    delete expected;
+
+    // Pairs of subtrees that collided under the old hash ({"a", "ab"} and {"b", "ba"}
+    // below "q") and many small random ones: after caching every hash, copy and move
+    // merges must still give the same keys as inserting both Tries key by key.
+    for (int round = 0; round < 300; round++) {
+        Node *left = (round == 0) ? new Node('r') : randomTrie<Traits>('r', 1 + rand() % 4, 3);
+        Node *right = (round == 0) ? new Node('r') : randomTrie<Traits>('r', 1 + rand() % 4, 3);
+        if (round == 0) {
+            left->insert(string("qa"));
+            left->insert(string("qab"));
+            right->insert(string("qb"));
+            right->insert(string("qba"));
+        }
+        Node naive('r');
+        for (TrieKeyIterator<char, Traits> it = left->keys().begin(); it != left->keys().end(); ++it) {
+            naive.insert(*it);
+        }
+        for (TrieKeyIterator<char, Traits> it = right->keys().begin(); it != right->keys().end(); ++it) {
+            naive.insert(*it);
+        }
+        left->getHash();
+        right->getHash();
+        Node *copied = left->clone();
+        *copied += *right;
+        *left += std::move(*right);
+        assert(*copied == naive && *left == naive && copied->getNumKeys() == naive.getNumKeys());
+        assert(left->getNumKeys() == naive.getNumKeys() && countsAreConsistent(left));
+        delete copied;
+        delete left;
+        delete right;
+    }
+}
+
+void testStructuralHash()
+{
+    checkStructuralHash<TrieNodeTraits>();
+    checkStructuralHash<CachingTrieTraits>();
+    cout << "testStructuralHash passed." << endl;
+}
+
+typedef TrieNode<char, WeightedTrieTraits> WeightedNode;
+
+/**
+ * Return the weights of the keys below tn that start with prefix, heaviest first.
+ */
+vector<double> weightsByWalking(WeightedNode *tn, const string &prefix)
+{
+    vector<double> weights;
+    vector<pair<WeightedNode *, string> > pending(1, make_pair(tn, string()));
+    while (!pending.empty()) {
+        WeightedNode *node = pending.back().first;
+        string key = pending.back().second;
+        pending.pop_back();
+        if (node->isEndOfKey() && key.compare(0, prefix.size(), prefix) == 0) {
+            weights.push_back(node->getWeight());
+        }
+        for (int i = 0; i < node->getNumChildren(); i++) {
+            pending.push_back(make_pair(node->getChildAtIndex(i), key + node->getChildAtIndex(i)->getValue()));
+        }
+    }
+    sort(weights.rbegin(), weights.rend());
+    return weights;
+}
+
+/**
+ * Return true if topK(prefix, k) finds the k heaviest keys below tn (by weight, since
+ * ties may come in any order), each with its own weight.
+ */
+bool topKIsCorrect(WeightedNode *tn, const string &prefix, size_t k)
+{
+    vector<double> expected = weightsByWalking(tn, prefix);
+    expected.resize(min(k, expected.size()));
+    vector<pair<vector<char>, double> > found = tn->topK(prefix, k);
+    if (found.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < found.size(); i++) {
+        WeightedNode *node = tn->find(found[i].first);
+        if (found[i].second != expected[i] || node == NULL || node->getWeight() != found[i].second ||
+            string(found[i].first.begin(), found[i].first.begin() + prefix.size()) != prefix) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testTopK()
+{
+    WeightedNode *root = new WeightedNode();
+    root->insert(string("tea"), 5);
+    root->insert(string("ten"), 9);
+    root->insert(string("to"), 7);
+    root->insert(string("inn"), 8);
+    root->insert(string("t"));
+    // Check if:
+    //      (a) results come heaviest first, include the prefix, and stop at k
+    //      (b) missing prefixes and k == 0 give nothing
+    vector<pair<vector<char>, double> > top = root->topK(string("t"), 2);
+    assert(top.size() == 2 && string(top[0].first.begin(), top[0].first.end()) == "ten" && top[0].second == 9 &&
+        string(top[1].first.begin(), top[1].first.end()) == "to" && top[1].second == 7);
+    top = root->topK(string(""), 10);
+    assert(top.size() == 5 && top[1].second == 8 && top[4].second == 0 && top[4].first.size() == 1);
+    assert(root->topK(string("x"), 3).empty() && root->topK(string("te"), 0).empty() &&
+        root->topK(string("te"), 5).size() == 2);
+
+    // Re-inserting a key replaces its weight; weights take part in ==.
+    WeightedNode *clone = root->clone();
+    root->insert(string("ten"), 1);
+    assert(root->topK(string("te"), 1)[0].second == 5 && *root != *clone);
+    root->find(string("ten"))->setWeight(9);
+    assert(*root == *clone);
+    delete clone;
+
+    // A weight set where no key ends yet is kept until one does, also after the key
+    // is taken out again.
+    WeightedNode *te = (*(*root)['t'])['e'];
+    te->setWeight(6);
+    assert(root->topK(string("te"), 3).size() == 2 && root->topK(string(""), 1)[0].second == 9);
+    root->insert(string("te"));
+    top = root->topK(string("te"), 1);
+    assert(string(top[0].first.begin(), top[0].first.end()) == "ten" && te->getWeight() == 6);
+    assert(root->topK(string("te"), 3)[1].second == 6 && topKIsCorrect(root, "", 10));
+    te->setEndOfKey(false);
+    root->insert(string("te"));
+    assert(te->getWeight() == 6 && topKIsCorrect(root, "t", 10));
+    delete root;
+
+    // Best weights follow every kind of modification.
+    srand(37);
+    root = randomTrie<WeightedTrieTraits>('r', 2000, 6);
+    for (int i = 0; i < 300; i++) {
+        string key(1 + rand() % 6, ' ');
+        for (size_t j = 0; j < key.size(); j++) {
+            key[j] = 'a' + rand() % 6;
+        }
+        root->insert(key, rand() % 1000);
+    }
+    assert(topKIsCorrect(root, "", 20) && topKIsCorrect(root, "a", 20) && topKIsCorrect(root, "bc", 5));
+    top = root->topK(string(""), 1);
+    WeightedNode *best = root->find(top[0].first);
+    best->setWeight(-1);
+    assert(topKIsCorrect(root, "", 20) && root->topK(string(""), 1)[0].second < top[0].second);
+    best->setWeight(2000);
+    assert(topKIsCorrect(root, "", 1));
+    best->setEndOfKey(false);
+    assert(topKIsCorrect(root, "", 20));
+    best->setEndOfKey(true);
+    assert(root->topK(string(""), 1)[0].second == 2000);
+    delete (*root >> 'a');
+    assert(topKIsCorrect(root, "", 20) && topKIsCorrect(root, "a", 5));
+    (*root)['b']->clear();
+    assert(topKIsCorrect(root, "", 20) && topKIsCorrect(root, "b", 5));
+
+    // Merging keeps the larger weight of keys stored in both Tries.
+    WeightedNode *other = randomTrie<WeightedTrieTraits>('r', 2000, 6);
+    for (int i = 0; i < 300; i++) {
+        string key(1 + rand() % 6, ' ');
+        for (size_t j = 0; j < key.size(); j++) {
+            key[j] = 'a' + rand() % 6;
+        }
+        other->insert(key, rand() % 3000);
+    }
+    WeightedNode *copied = root->clone();
+    *copied += *other;
+    assert(topKIsCorrect(copied, "", 50) && topKIsCorrect(copied, "c", 10));
+    *root += std::move(*other);
+    assert(*root == *copied && topKIsCorrect(root, "", 50));
+    WeightedNode *parallel = new WeightedNode('r');
+    vector<WeightedNode *> sources(1, copied);
+    parallel->mergeAll(sources, 2);
+    assert(*parallel == *copied && topKIsCorrect(parallel, "d", 10));
+
+    delete root;
+    delete other;
+    delete copied;
+    delete parallel;
+    cout << "testTopK passed." << endl;
+}
+
+/**
+ * Helper method - check parallel merges of TrieNode<char, Traits> against sequential
+ * ones, and into an arena if Traits allow arenas.
+ */
+template<class Traits> void checkParallelMerge()
+{
+    typedef TrieNode<char, Traits> Node;
+    srand(11);
+    // Shards share most of their structure, so groups get merged at several levels;
+    // one shard has a different root value and must be merged in sequence.
+    vector<Node *> shards;
+    for (int i = 0; i < 8; i++) {
+        shards.push_back(randomTrie<Traits>(i == 5 ? 'x' : 'r', 3000, 8));
+    }
+    Node *expected = randomTrie<Traits>('r', 100, 8);
+    Node *parallel = expected->clone();
+    for (size_t i = 0; i < shards.size(); i++) {
+        *expected += *shards[i];
+    }
+    parallel->mergeAll(shards, 4);
+    assert(*parallel == *expected && countsAreConsistent(parallel));
+
+    // Same into an arena-backed Trie, with a single thread and with many.
+    for (unsigned threads = 1; threads <= 16; threads *= 4) {
+        Node *arenaTrie = new Node('r');
+        arenaTrie->useArena(256);
+        Node *sequential = new Node('r');
+        for (size_t i = 0; i < shards.size(); i++) {
+            *sequential += *shards[i];
+        }
+        arenaTrie->mergeAll(shards, threads);
+        assert(*arenaTrie == *sequential && countsAreConsistent(arenaTrie));
+        delete arenaTrie;
+        delete sequential;
+    }
+
+    for (size_t i = 0; i < shards.size(); i++) {
+        delete shards[i];
+    }
+    delete expected;
+    delete parallel;
+}
+
+void testParallelMerge()
+{
+    checkParallelMerge<TrieNodeTraits>();
+    checkParallelMerge<FullTrieTraits>();
+    cout << "testParallelMerge passed." << endl;
+}
+
+/**
+ * Regression test for stack overflows on deep Tries: every operation below used to
+ * recurse once per level. Also reports how long the whole round trip took.
+ */
+/**
+ * Return numKeys distinct random keys of up to maxLength values drawn from a small
+ * alphabet, so that they share plenty of prefixes.
+ */
+vector<string> randomKeys(int numKeys, int maxLength)
+{
+    vector<string> keys;
+    set<string> seen;
+    while ((int) keys.size() < numKeys) {
+        string key(1 + rand() % maxLength, ' ');
+        for (size_t j = 0; j < key.size(); j++) {
+            key[j] = 'a' + rand() % 4;
+        }
+        if (seen.insert(key).second) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+void testRadixTrie()
+{
+    RadixTrieNode<char> *root = new RadixTrieNode<char>();
+    root->insert(string("romane"));
+    RadixTrieNode<char> *romulus = root->insert(string("romulus"));
+    // Check if:
+    //      (a) the two keys share one "rom" node, with "ane" and "ulus" below it
+    //      (b) lookups only succeed for whole keys, but prefixes may end mid-label
+    assert(root->size() == 4 && root->getNumChildren() == 1 && romulus->getLabel().size() == 4);
+    assert(root->find(string("romulus")) == romulus && root->find(string("rom")) == NULL &&
+        root->find(string("romanes")) == NULL);
+    assert(root->isPrefix(string("roma")) && root->isPrefix(string("")) && !root->isPrefix(string("rome")));
+
+    // Inserting a key that ends mid-label splits the label, but adds no leaf.
+    RadixTrieNode<char> *rom = root->insert(string("rom"));
+    assert(root->size() == 4 && rom->isEndOfKey() && (*root)['r'] == rom && rom->getNumChildren() == 2);
+    root->insert(string("rubens"));
+    assert(root->size() == 6 && (*root)['r']->getLabel().size() == 1 && root->getNumKeys() == 4);
+
+    // Removing keys merges single-child chains back together.
+    assert(*root >> string("rubens") && root->size() == 4);
+    assert((*root)['r']->getLabel() == vector<char>(rom->getLabel()) && rom->getLabel().size() == 3);
+    assert(*root >> string("romane") && root->size() == 3);
+    assert(*root >> string("rom") && root->size() == 2 && (*root)['r']->getLabel().size() == 7);
+    assert(!(*root >> string("rom")) && !(*root >> string("romul")) && root->find(string("romulus")) != NULL);
+
+    // Display shows whole labels in place of single values.
+    root->insert(string("romane"));
+    stringstream out;
+    out << *root;
+    assert(out.str().find("rom\n========\nulus ane ") != string::npos);
+
+    // Random keys: compare against an uncompressed TrieNode, removing half of them
+    // again, and merging two halves must give what inserting everything does.
+    srand(13);
+    for (int round = 0; round < 10; round++) {
+        vector<string> keys = randomKeys(300, 10);
+        RadixTrieNode<char> *radix = new RadixTrieNode<char>();
+        TrieNode<char> *plain = new TrieNode<char>();
+        RadixTrieNode<char> *firstHalf = new RadixTrieNode<char>();
+        RadixTrieNode<char> *secondHalf = new RadixTrieNode<char>();
+        for (size_t i = 0; i < keys.size(); i++) {
+            radix->insert(keys[i]);
+            plain->insert(keys[i]);
+            (i % 2 == 0 ? firstHalf : secondHalf)->insert(keys[i]);
+        }
+        assert(radix->getNumKeys() == plain->getNumKeys() && radix->size() < plain->size());
+
+        RadixTrieNode<char> *clone = radix->clone();
+        assert(*clone == *radix);
+        *firstHalf += *secondHalf;
+        assert(firstHalf->size() == radix->size() && firstHalf->getNumKeys() == radix->getNumKeys());
+
+        RadixTrieNode<char> *remaining = new RadixTrieNode<char>();
+        for (size_t i = 0; i < keys.size(); i++) {
+            assert(firstHalf->find(keys[i]) != NULL);
+            if (i % 2 == 0) {
+                *radix >> keys[i];
+            }
+        }
+        for (size_t i = 1; i < keys.size(); i += 2) {
+            remaining->insert(keys[i]);
+        }
+        // Same keys, same (fully compressed) shape - though children may be in
+        // another order.
+        assert(radix->size() == remaining->size() && radix->getNumKeys() == remaining->getNumKeys());
+        for (size_t i = 0; i < keys.size(); i++) {
+            assert((radix->find(keys[i]) != NULL) == (remaining->find(keys[i]) != NULL));
+        }
+        assert(*clone != *radix);
+
+        delete radix;
+        delete plain;
+        delete firstHalf;
+        delete secondHalf;
+        delete clone;
+        delete remaining;
+    }
+
+    cout << "testRadixTrie passed." << endl;
+    delete root;
+}
+
+/**
+ * Return the edit distance between a and b (the textbook full table).
+ */
+template<class Seq> size_t editDistance(const Seq &a, const Seq &b)
+{
+    vector<vector<size_t> > table(a.size() + 1, vector<size_t>(b.size() + 1));
+    for (size_t i = 0; i <= a.size(); i++) {
+        for (size_t j = 0; j <= b.size(); j++) {
+            if (i == 0 || j == 0) {
+                table[i][j] = i + j;
+                continue;
+            }
+            table[i][j] = min(min(table[i - 1][j], table[i][j - 1]) + 1,
+                table[i - 1][j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1));
+        }
+    }
+    return table[a.size()][b.size()];
+}
+
+void testFuzzyFind()
+{
+    TrieNode<char> *root = new TrieNode<char>();
+    const char *words[] = { "cat", "cart", "car", "act", "dog", "cats", "" };
+    for (int i = 0; i < 7; i++) {
+        root->insert(string(words[i]));
+    }
+    // Check if:
+    //      (a) keys come in pre-order, each with its distance
+    //      (b) distance 0 is an exact lookup, and the empty key counts like any other
+    vector<pair<vector<char>, size_t> > found = root->fuzzyFind(string("cat"), 1);
+    assert(found.size() == 4 && string(found[0].first.begin(), found[0].first.end()) == "cat" &&
+        found[0].second == 0 && found[1].second == 1 && string(found[3].first.begin(), found[3].first.end()) == "cart");
+    assert(root->fuzzyFind(string("cat"), 0).size() == 1 && root->fuzzyFind(string("cta"), 0).empty());
+    found = root->fuzzyFind(string("a"), 1);
+    assert(found.size() == 1 && found[0].first.empty() && found[0].second == 1);
+    assert(root->fuzzyFind(string(""), 3).size() == 5);
+    delete root;
+
+    // Same result as checking every key, for several distances.
+    srand(41);
+    vector<string> keys = randomKeys(2000, 8);
+    root = new TrieNode<char>();
+    for (size_t i = 0; i < keys.size(); i++) {
+        root->insert(keys[i]);
+    }
+    for (int q = 0; q < 30; q++) {
+        string query = keys[rand() % keys.size()];
+        query[rand() % query.size()] = 'e';
+        for (size_t d = 0; d <= 3; d++) {
+            set<string> expected;
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (editDistance(keys[i], query) <= d) {
+                    expected.insert(keys[i]);
+                }
+            }
+            found = root->fuzzyFind(query, d);
+            assert(found.size() == expected.size());
+            for (size_t i = 0; i < found.size(); i++) {
+                string key(found[i].first.begin(), found[i].first.end());
+                assert(expected.count(key) == 1 && found[i].second == editDistance(key, query));
+            }
+        }
+    }
+    delete root;
+
+    // Any value type: whole words as values.
+    TrieNode<string> *phrases = new TrieNode<string>();
+    const char *sentences[][3] = { { "the", "quick", "fox" }, { "the", "slow", "fox" }, { "a", "quick", "dog" } };
+    for (int i = 0; i < 3; i++) {
+        phrases->insert(vector<string>(sentences[i], sentences[i] + 3));
+    }
+    vector<string> query(sentences[0], sentences[0] + 3);
+    query[2] = "cat";
+    vector<pair<vector<string>, size_t> > foundPhrases = phrases->fuzzyFind(query, 1);
+    assert(foundPhrases.size() == 1 && foundPhrases[0].first[1] == "quick" && foundPhrases[0].second == 1);
+    assert(phrases->fuzzyFind(query, 2).size() == 3);
+    delete phrases;
+
+    cout << "testFuzzyFind passed." << endl;
+}
+
+void testIterators()
+{
+    srand(43);
+    TrieNode<char> *root = randomTrie('r', 1000, 6);
+    // Check if:
+    //      (a) pre-order visits what an explicit stack does, in the same order
+    //      (b) post-order puts every node after its children, level order by depth
+    vector<TrieNode<char> *> expected, pending(1, root);
+    while (!pending.empty()) {
+        TrieNode<char> *node = pending.back();
+        pending.pop_back();
+        expected.push_back(node);
+        for (int i = node->getNumChildren(); i-- > 0;) {
+            pending.push_back(node->getChildAtIndex(i));
+        }
+    }
+    vector<TrieNode<char> *> visited;
+    for (TrieNode<char> &node : *root) {
+        visited.push_back(&node);
+    }
+    assert(visited == expected && (uint64_t) distance(root->preOrder().begin(), root->preOrder().end()) == root->size());
+
+    map<TrieNode<char> *, size_t> position;
+    for (TrieNode<char> &node : root->postOrder()) {
+        assert(!node.hasParent() || position.count(node.getParent()) == 0);
+        position[&node] = position.size();
+    }
+    assert(position.size() == root->size() && position[root] == root->size() - 1);
+    size_t lastDepth = 0;
+    uint64_t numLevelOrder = 0;
+    for (TrieNode<char> &node : root->levelOrder()) {
+        size_t depth = 0;
+        for (TrieNode<char> *n = &node; n != root; n = n->getParent()) {
+            depth++;
+        }
+        assert(depth >= lastDepth);
+        lastDepth = depth;
+        numLevelOrder++;
+    }
+    assert(numLevelOrder == root->size());
+
+    // Keys come in pre-order, like FrozenTrie::forEachKey; with a prefix, only the
+    // keys under it, prefix included.
+    vector<vector<char> > frozenKeys, iteratedKeys;
+    FrozenTrie<char> *frozen = root->freeze();
+    frozen->forEachKey([&frozenKeys](const vector<char> &key) { frozenKeys.push_back(key); });
+    delete frozen;
+    TrieRange<TrieKeyIterator<char> > keys = root->keys();
+    for (TrieKeyIterator<char> it = keys.begin(); it != keys.end(); ++it) {
+        assert(it.getNode() == root->find(*it));
+        iteratedKeys.push_back(*it);
+    }
+    assert(iteratedKeys == frozenKeys);
+    uint64_t numWithPrefix = 0;
+    for (const vector<char> &key : root->keys(string("ab"))) {
+        assert(key.size() >= 2 && key[0] == 'a' && key[1] == 'b');
+        numWithPrefix++;
+    }
+    assert(numWithPrefix == root->countKeysWithPrefix(string("ab")) && numWithPrefix > 0);
+    assert(root->keys(string("abz")).begin() == root->keys(string("abz")).end());
+
+    // A subtree is walked on its own, and works with <algorithm>.
+    TrieNode<char> *a = (*root)['a'];
+    TrieRange<TriePreOrderIterator<char> > subtree = a->preOrder();
+    assert((uint64_t) distance(subtree.begin(), subtree.end()) == a->size());
+    assert(find_if(subtree.begin(), subtree.end(), [root](TrieNode<char> &node) { return &node == root; }) ==
+        subtree.end());
+    assert((uint64_t) count_if(a->postOrder().begin(), a->postOrder().end(),
+        [](TrieNode<char> &node) { return node.isEndOfKey(); }) == a->getNumKeys());
+
+    TrieNode<char> leaf('x');
+    assert(distance(leaf.begin(), leaf.end()) == 1 && leaf.keys().begin() == leaf.keys().end());
+    delete root;
+
+    // Walks follow positions, not values: two children with the same value (allowed by
+    // setChildAtIndex) are both visited, once each.
+    TrieNode<char> twins('*');
+    twins.insert(string("ab"));
+    twins.insert(string("b"));
+    TrieNode<char> *twin = new TrieNode<char>('a');
+    twin->insert(string("c"));
+    TrieNode<char> *b = twins.getChildAtIndex(1);
+    twins.setChildAtIndex(1, twin);
+    delete b;
+    assert(distance(twins.begin(), twins.end()) == 5 && distance(twins.postOrder().begin(),
+        twins.postOrder().end()) == 5 && distance(twins.keys().begin(), twins.keys().end()) == 2);
+    stringstream exported;
+    exported << twins;
+    assert(!exported.str().empty());
+
+    cout << "testIterators passed." << endl;
+}
+
+/**
+ * Test whether TrieExporter writes the pretty format exactly as displayNode does, and
+ * DOT and JSON as documented, within the depth and node limits.
+ */
+void testExport()
+{
+    // Check if the pretty format matches displayNode, for any buffer size.
+    srand(44);
+    TrieNode<char> *random = randomTrie('r', 500, 6);
+    string expected;
+    for (TrieNode<char> &node : *random) {
+        if (node.hasChildren()) {
+            expected += displayNode(node) + "\n\n";
+        }
+    }
+    stringstream displayed, chunked;
+    displayed << *random;
+    TrieExporter<char> smallBuffer(chunked, 16);
+    assert(smallBuffer.write(*random, TRIE_EXPORT_PRETTY) && smallBuffer.getNumNodes() == random->size());
+    assert(displayed.str() == expected && chunked.str() == expected);
+    delete random;
+
+    TrieNode<string> *car = new TrieNode<string>("<car>");
+    TrieNode<string> *model = new TrieNode<string>(car, "<model>");
+    new TrieNode<string>(car, "<yr>");
+    *model << "Toyota Corolla" << "Lexus";
+    stringstream displayedCar;
+    displayedCar << *car;
+    assert(displayedCar.str() == displayNode(*car) + "\n\n" + displayNode(*model) + "\n\n");
+    delete car;
+
+    // Check if JSON and DOT are written as expected, whole and sampled.
+    TrieNode<char> *root = new TrieNode<char>('r');
+    root->insert(string("ab"));
+    root->insert(string("ac"));
+    root->insert(string("b"));
+    stringstream json, dot, shallow, few;
+    {
+        TrieExporter<char> jsonExporter(json), dotExporter(dot);
+        assert(jsonExporter.write(*root, TRIE_EXPORT_JSON) && !jsonExporter.isTruncated());
+        assert(dotExporter.write(*root, TRIE_EXPORT_DOT) && dotExporter.getNumNodes() == 5);
+    }
+    assert(json.str() == "{\"value\":\"r\",\"endOfKey\":false,\"children\":["
+        "{\"value\":\"a\",\"endOfKey\":false,\"children\":["
+        "{\"value\":\"b\",\"endOfKey\":true,\"children\":[]},{\"value\":\"c\",\"endOfKey\":true,\"children\":[]}]},"
+        "{\"value\":\"b\",\"endOfKey\":true,\"children\":[]}]}\n");
+    assert(dot.str() == "digraph trie {\n"
+        "  n0 [label=\"r\"];\n"
+        "  n1 [label=\"a\"];\n  n0 -> n1;\n"
+        "  n2 [label=\"b\", shape=doublecircle];\n  n1 -> n2;\n"
+        "  n3 [label=\"c\", shape=doublecircle];\n  n1 -> n3;\n"
+        "  n4 [label=\"b\", shape=doublecircle];\n  n0 -> n4;\n"
+        "}\n");
+
+    {
+        TrieExporter<char> sampler(shallow);
+        sampler.setMaxDepth(1);
+        assert(sampler.write(*root, TRIE_EXPORT_JSON) && sampler.isTruncated() && sampler.getNumNodes() == 3);
+    }
+    assert(shallow.str() == "{\"value\":\"r\",\"endOfKey\":false,\"children\":["
+        "{\"value\":\"a\",\"endOfKey\":false,\"children\":[],\"truncated\":true},"
+        "{\"value\":\"b\",\"endOfKey\":true,\"children\":[]}]}\n");
+    {
+        TrieExporter<char> sampler(few);
+        sampler.setMaxNodes(2);
+        assert(sampler.write(*root, TRIE_EXPORT_DOT) && sampler.isTruncated() && sampler.getNumNodes() == 2);
+    }
+    assert(few.str() == "digraph trie {\n  n0 [label=\"r\"];\n  n1 [label=\"a\"];\n  n0 -> n1;\n"
+        "  n1 [style=dashed];\n  n0 [style=dashed];\n}\n");
+    delete root;
+
+    // Strings are escaped; integers are JSON numbers.
+    TrieNode<string> quoted("say \"hi\"\\");
+    quoted << "a\nb";
+    TrieNode<int> numbers(7);
+    numbers << 12 << -3;
+    stringstream quotedJson, quotedDot, numbersJson;
+    {
+        TrieExporter<string> stringExporter(quotedJson);
+        stringExporter.write(quoted, TRIE_EXPORT_JSON);
+        TrieExporter<string> dotExporter(quotedDot);
+        dotExporter.write(quoted, TRIE_EXPORT_DOT);
+        TrieExporter<int> intExporter(numbersJson);
+        intExporter.write(numbers, TRIE_EXPORT_JSON);
+    }
+    assert(quotedJson.str() == "{\"value\":\"say \\\"hi\\\"\\\\\",\"endOfKey\":false,\"children\":["
+        "{\"value\":\"a\\u000ab\",\"endOfKey\":false,\"children\":[]}]}\n");
+    assert(quotedDot.str().find("  n1 [label=\"a\\\\x0ab\"];\n") != string::npos);
+    assert(numbersJson.str() == "{\"value\":7,\"endOfKey\":false,\"children\":["
+        "{\"value\":12,\"endOfKey\":false,\"children\":[]},{\"value\":-3,\"endOfKey\":false,\"children\":[]}]}\n");
+    cout << "testExport passed." << endl;
+}
+
+/**
+ * Helper method - fill random with random keys, check that the histograms of its
+ * stats() add up, and delete it.
+ */
+template<class Traits> void checkHistograms(TrieNode<char, Traits> *random)
+{
+    for (int i = 0; i < 500; i++) {
+        random->insert(randomKeys(1, 8)[0]);
+    }
+    TrieStats randomStats = random->stats();
+    uint64_t numNodes = 0, numEdges = 0, numChained = 0, numSingleChild = 0;
+    for (size_t i = 0; i < randomStats.depthHistogram.size(); i++) {
+        numNodes += randomStats.depthHistogram[i];
+    }
+    for (size_t i = 0; i < randomStats.fanoutHistogram.size(); i++) {
+        numEdges += i * randomStats.fanoutHistogram[i];
+    }
+    for (size_t i = 0; i < randomStats.chainHistogram.size(); i++) {
+        numChained += i * randomStats.chainHistogram[i];
+    }
+    for (TrieNode<char, Traits> &node : *random) {
+        numSingleChild += (node.getNumChildren() == 1 && !node.isEndOfKey()) ? 1 : 0;
+    }
+    assert(randomStats.numNodes == random->size() && numNodes == random->size() && numEdges == numNodes - 1);
+    assert(randomStats.numKeys == random->getNumKeys() && numChained == numSingleChild);
+    delete random;
+}
+
+/**
+ * Test whether stats() describes the shape and memory of a Trie, and whether the
+ * counters count lookups (only for a Trie with OperationCountingTrieTraits).
+ */
+void testStats()
+{
+    TrieNode<char> *root = new TrieNode<char>();
+    root->insert(string("abcd"));
+    root->insert(string("abce"));
+    root->insert(string("x"));
+    root->insert(string("xyz"));
+    // Check if:
+    //      (a) counts and histograms match the Trie
+    //            root
+    //           a    x*
+    //           b    y
+    //           c    z*
+    //          d* e*
+    //      (b) a-b and y are the single-child chains (x ends a key)
+    //      (c) only root and c, with 2 children each, have a heap children buffer, which
+    //          also holds their keys (16 bytes each); there is no separate index
+    TrieStats stats = root->stats();
+    assert(stats.numNodes == 9 && stats.numKeys == 4 && stats.numLeaves == 3 && stats.maxDepth == 4);
+    assert(stats.depthHistogram == vector<uint64_t>({ 1, 2, 2, 2, 2 }));
+    assert(stats.fanoutHistogram == vector<uint64_t>({ 3, 4, 2 }));
+    assert(stats.chainHistogram == vector<uint64_t>({ 0, 1, 1 }));
+    assert(stats.childVectorBytes == 4 * sizeof(TrieNode<char> *) && stats.childIndexBytes == 2 * 16 &&
+        stats.valueBytes == 0 && stats.nodeBytes >= 9 * sizeof(TrieNode<char>));
+    assert(stats.childIndexNodeBytes == 0 && sizeof(ByteChildList<TrieNode<char> >) == 2 * sizeof(uint64_t));
+    assert(stats.totalBytes() == stats.nodeBytes + stats.childVectorBytes + stats.childSlackBytes + 2 * 16);
+
+    // Check if the counters saw 2 lookups (1 miss) and 1 insert on the counting copy
+    // of the Trie, and every child compared on the way; and nothing on the others.
+    TrieNode<char, OperationCountingTrieTraits> *counted = new TrieNode<char, OperationCountingTrieTraits>();
+    for (TrieKeyIterator<char> it = root->keys().begin(); it != root->keys().end(); ++it) {
+        counted->insert(*it);
+    }
+    TrieCounters &counters = TrieCounters::instance();
+    counters.reset();
+    assert(counted->find(string("abcd")) != NULL && counted->find(string("abz")) == NULL);
+    counted->insert(string("q"));
+    assert(counters.lookups == 2 && counters.misses == 1 && counters.inserts == 1);
+    assert(counters.childLookups == 8 && counters.childScans == 9);
+    counters.reset();
+    assert(root->find(string("abcd")) != NULL);
+    root->insert(string("q"));
+    assert(counters.lookups == 0 && counters.inserts == 0 && counters.childLookups == 0 && counters.childScans == 0);
+    delete counted;
+    delete root;
+
+    // Wide nodes own an index; long strings own a buffer.
+    TrieNode<int> wide;
+    for (int i = 0; i < 100; i++) {
+        wide << i;
+    }
+    TrieNode<string> words;
+    words << "short" << string(100, 'w');
+    assert(wide.stats().childIndexBytes > 0 && wide.stats().fanoutHistogram[100] == 1);
+    assert(words.stats().valueBytes > 100 && words.stats().numLeaves == 2);
+
+    // Random Tries: the histograms add up, on the heap or in an arena.
+    srand(45);
+    checkHistograms(new TrieNode<char>());
+    TrieNode<char, ArenaTrieTraits> *arenaTrie = new TrieNode<char, ArenaTrieTraits>();
+    assert(arenaTrie->useArena());
+    checkHistograms(arenaTrie);
+    cout << "testStats passed." << endl;
+}
+
+void testNoParentTrie()
+{
+    typedef TrieNode<char, NoParentTrieTraits> CompactNode;
+    // Check if:
+    //      (a) dropping the parent pointer saves exactly one pointer per TrieNode
+    //      (b) leaves and single-child TrieNodes keep their child inline (no heap
+    //          buffer at all in a chain)
+    assert(sizeof(CompactNode) == sizeof(TrieNode<char>) - sizeof(void *));
+    CompactNode chain;
+    chain.insert(string("abc"));
+    TrieStats chainStats = chain.stats();
+    assert(chainStats.childVectorBytes == 0 && chainStats.childSlackBytes == 0 && chain.size() == 4);
+    assert(chain["a"[0]]->size() == 3 && chain.getNumKeys() == 1 && !chain.isSingleton());
+
+    // Random keys: without parent pointers, the Trie has the same counts, keys,
+    // display and stats as with them, and clones, merges and deletions on the root
+    // keep it that way.
+    srand(46);
+    vector<string> keys = randomKeys(600, 8);
+    TrieNode<char> *linked = new TrieNode<char>();
+    CompactNode *compact = new CompactNode();
+    for (size_t i = 0; i < keys.size(); i++) {
+        linked->insert(keys[i]);
+        compact->insert(keys[i]);
+    }
+    for (int round = 0; round < 3; round++) {
+        ostringstream linkedText, compactText, linkedJson, compactJson;
+        linkedText << *linked;
+        compactText << *compact;
+        TrieExporter<char>(linkedJson).write(*linked, TRIE_EXPORT_JSON);
+        TrieExporter<char, NoParentTrieTraits>(compactJson).write(*compact, TRIE_EXPORT_JSON);
+        assert(linkedText.str() == compactText.str() && linkedJson.str() == compactJson.str());
+
+        vector<uint64_t> linkedCounts, compactCounts;
+        for (TrieNode<char> &node : linked->postOrder()) {
+            linkedCounts.push_back(node.size() * 1000 + node.getNumKeys());
+        }
+        for (CompactNode &node : compact->postOrder()) {
+            compactCounts.push_back(node.size() * 1000 + node.getNumKeys());
+        }
+        assert(linkedCounts == compactCounts && linked->getHash() == compact->getHash());
+
+        vector<vector<char> > linkedKeys(linked->keys().begin(), linked->keys().end());
+        vector<vector<char> > compactKeys(compact->keys().begin(), compact->keys().end());
+        assert(linkedKeys == compactKeys && compact->find(keys[round]) != NULL);
+
+        TrieStats linkedStats = linked->stats(), compactStats = compact->stats();
+        assert(compactStats.numNodes == linkedStats.numNodes &&
+            compactStats.chainHistogram == linkedStats.chainHistogram);
+        assert(compactStats.childVectorBytes == linkedStats.childVectorBytes &&
+            compactStats.nodeBytes + compactStats.numNodes * sizeof(void *) == linkedStats.nodeBytes);
+
+        CompactNode *copy = compact->clone();
+        assert(*copy == *compact);
+        delete copy;
+
+        // Change both Tries from the root for the next round.
+        vector<string> more = randomKeys(200, 10);
+        TrieNode<char> linkedOther;
+        CompactNode compactOther;
+        for (size_t i = 0; i < more.size(); i++) {
+            linkedOther.insert(more[i]);
+            compactOther.insert(more[i]);
+        }
+        *linked += linkedOther;
+        *compact += compactOther;
+        delete (*linked >> keys[round][0]);
+        delete (*compact >> keys[round][0]);
+    }
+    delete linked;
+    delete compact;
+
+    // Changes below the root: nothing cached above them can go stale.
+    CompactNode left, right;
+    left.insert(string("ab"));
+    left.insert(string("ac"));
+    right.insert(string("ab"));
+    assert(left.getHash() != right.getHash() && left.getNumKeys() == 2);
+    delete (*left['a'] >> 'c');
+    assert(left == right && left.getHash() == right.getHash() && left.getNumKeys() == 1 && left.size() == 3);
+    left['a']->setEndOfKey(true);
+    right['a']->setEndOfKey(true);
+    assert(left == right && left.getNumKeys() == 2 && left['a']->getNumKeys() == 2);
+    left['a']->getChildAtIndex(0)->setEndOfKey(false);
+    assert(left != right && left.getNumKeys() == 1);
+    cout << "testNoParentTrie passed." << endl;
+}
+
+/**
+ * An allocator policy (see src/trieNodeTraits.h) that counts the TrieNodes it hands
+ * out, on the heap or from an arena.
+ */
+template<class Node> class CountingArena : public NodeArena<Node>
+{
+public:
+    static size_t numAllocated;
+
+    CountingArena(Node *root, size_t nodesPerBlock) : NodeArena<Node>(root, nodesPerBlock) {}
+
+    static void *allocateNode(NodeArena<Node> *arena)
+    {
+        numAllocated++;
+        return NodeArena<Node>::allocateNode(arena);
+    }
+};
+template<class Node> size_t CountingArena<Node>::numAllocated = 0;
+
+struct CountingTrieTraits : ArenaTrieTraits
+{
+    template<class Node> struct NodeAllocator
+    {
+        typedef CountingArena<Node> type;
+    };
+};
+
+// No parent pointers, and children in a std::vector.
+struct LeanTrieTraits : VectorChildTrieTraits
+{
+    static const bool KEEP_PARENT = false;
+};
+
+/**
+ * Build the same Trie as a TrieNode<char> and as a TrieNode<char, Traits>, change both
+ * the same way from the root, and check that they never tell apart.
+ */
+template<class Traits> void checkTraits(bool arena)
+{
+    typedef TrieNode<char, Traits> Node;
+    vector<string> keys = randomKeys(400, 8);
+    TrieNode<char> *expected = new TrieNode<char>();
+    Node *trie = new Node();
+    if (arena) {
+        trie->useArena(64);
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+        expected->insert(keys[i]);
+        trie->insert(keys[i]);
+    }
+
+    for (int round = 0; round < 2; round++) {
+        ostringstream expectedText, text;
+        expectedText << *expected;
+        text << *trie;
+        vector<vector<char> > expectedKeys(expected->keys().begin(), expected->keys().end());
+        vector<vector<char> > trieKeys(trie->keys().begin(), trie->keys().end());
+        assert(expectedText.str() == text.str() && expectedKeys == trieKeys);
+        assert(trie->size() == expected->size() && trie->getNumKeys() == expected->getNumKeys() &&
+            trie->stats().numNodes == expected->size());
+        assert(trie->countKeysWithPrefix(string("ab")) == expected->countKeysWithPrefix(string("ab")));
+        assert(trie->getHash() == expected->getHash() &&
+            (trie->find(keys[round]) == NULL) == (expected->find(keys[round]) == NULL));
+        for (Node &node : *trie) {
+            assert(node.size() == node.stats().numNodes);
+        }
+        Node *copy = trie->clone();
+        assert(*copy == *trie);
+        delete copy;
+
+        // Merge (in parallel in the second round) and delete from the root.
+        vector<TrieNode<char> *> expectedSources;
+        vector<Node *> sources;
+        for (int i = 0; i < 3; i++) {
+            vector<string> more = randomKeys(100, 10);
+            expectedSources.push_back(new TrieNode<char>());
+            sources.push_back(new Node());
+            for (size_t j = 0; j < more.size(); j++) {
+                expectedSources.back()->insert(more[j]);
+                sources.back()->insert(more[j]);
+            }
+        }
+        expected->mergeAll(expectedSources, round + 1);
+        trie->mergeAll(sources, round + 1);
+        for (int i = 0; i < 3; i++) {
+            delete expectedSources[i];
+            delete sources[i];
+        }
+        delete (*expected >> keys[round][0]);
+        delete (*trie >> keys[round][0]);
+    }
+    delete expected;
+    delete trie;
+}
+
+void testTraits()
+{
+    // Check if the bases of the options that are off take no room: a default
+    // TrieNode<char> is its value, its parent and its children (which index themselves),
+    // and every opt-in option adds its own fields and nothing else.
+    assert(sizeof(TrieNode<char>) == 4 * sizeof(uint64_t));
+    assert(sizeof(TrieNode<char, CachingTrieTraits>) == sizeof(TrieNode<char>) + 3 * sizeof(uint64_t));
+    assert(sizeof(TrieNode<char, WeightedTrieTraits>) == sizeof(TrieNode<char>) + 2 * sizeof(double));
+    assert(sizeof(TrieNode<char, ArenaTrieTraits>) == sizeof(TrieNode<char>) + sizeof(void *));
+    assert(sizeof(TrieNode<char, FullTrieTraits>) ==
+        sizeof(TrieNode<char>) + 3 * sizeof(uint64_t) + 2 * sizeof(double) + sizeof(void *));
+    // A std::vector of children needs a ByteChildIndex next to it; a ByteChildList does not.
+    assert(sizeof(TrieNode<char, LeanTrieTraits>) + sizeof(ByteChildList<void>) ==
+        sizeof(TrieNode<char>) - sizeof(void *) + sizeof(vector<void *>) + sizeof(ByteChildIndex<void, vector<void *> >));
+    // Without the parent, only the value and the children are left: 24 bytes.
+    assert(sizeof(TrieNode<char, CompactTrieTraits>) == sizeof(TrieNode<char>) - sizeof(void *));
+    TrieNode<char, CompactTrieTraits> compact;
+    assert(!compact.useArena() && compact.getArena() == NULL);
+    assert(compact.insert(string("ab"))->getWeight() == 0 && compact.getHash() == compact.getHash());
+    // Nor is there an allocation header in front of each TrieNode.
+    assert(compact.stats().nodeBytes == 3 * sizeof(TrieNode<char, CompactTrieTraits>));
+
+    // Check if every combination behaves like the default one.
+    srand(47);
+    checkTraits<CachingTrieTraits>(false);
+    checkTraits<WeightedTrieTraits>(false);
+    checkTraits<ArenaTrieTraits>(true);
+    checkTraits<FullTrieTraits>(true);
+    checkTraits<VectorChildTrieTraits>(true);
+    checkTraits<LeanTrieTraits>(false);
+    checkTraits<CompactTrieTraits>(true);
+    checkTraits<CountingTrieTraits>(true);
+
+    // Check if the allocator policy saw every TrieNode: 1 root, 10 on the heap and
+    // 10 in the arena, and the ones above.
+    typedef TrieNode<char, CountingTrieTraits> CountingNode;
+    size_t before = CountingArena<CountingNode>::numAllocated;
+    CountingNode *counted = new CountingNode();
+    counted->insert(string("0123456789"));
+    CountingNode *arenaRoot = new CountingNode();
+    arenaRoot->useArena();
+    arenaRoot->insert(string("0123456789"));
+    assert(CountingArena<CountingNode>::numAllocated - before == 22 && arenaRoot->getArena()->getNumNodes() == 10);
+    delete counted;
+    delete arenaRoot;
+    cout << "testTraits passed." << endl;
+}
+
+void testFreeze()
+{
+    TrieNode<char> *root = new TrieNode<char>('r');
+    root->insert(string("at"));
+    root->insert(string("od"));
+    root->insert(string("o"));
+    FrozenTrie<char> *frozen = root->freeze();
+    // Check if:
+    //      (a) nodes are numbered breadth-first, children in the TrieNode's order
+    //      (b) child, parent and path lookups agree with the TrieNode
+    assert(frozen->size() == 5 && frozen->getNumKeys() == 3 && frozen->getValue(frozen->getRoot()) == 'r');
+    FrozenTrie<char>::Node o = frozen->getChild(frozen->getRoot(), 'o');
+    assert(o == 2 && frozen->getChildAtIndex(0, 1) == o && frozen->getChildAtIndex(0, 2) == FrozenTrie<char>::NO_NODE);
+    assert(frozen->isEndOfKey(o) && frozen->getParent(frozen->find(string("od"))) == o &&
+        frozen->getParent(0) == FrozenTrie<char>::NO_NODE && frozen->getParent(3) == 1);
+    assert(frozen->find(string("a")) == FrozenTrie<char>::NO_NODE && frozen->isPrefix(string("a")) &&
+        !frozen->isPrefix(string("ax")) && frozen->getChild(o, 'x') == FrozenTrie<char>::NO_NODE);
+
+    // Keys come out in pre-order.
+    vector<string> keys;
+    frozen->forEachKey([&keys](const vector<char> &key) { keys.push_back(string(key.begin(), key.end())); });
+    assert(keys.size() == 3 && keys[0] == "at" && keys[1] == "o" && keys[2] == "od");
+
+    TrieNode<char> *thawed = frozen->thaw();
+    assert(*thawed == *root && countsAreConsistent(thawed));
+    delete thawed;
+    delete frozen;
+    delete root;
+
+    // Wide nodes are searched in sorted order; the result must not change.
+    srand(17);
+    TrieNode<int> *wide = new TrieNode<int>();
+    vector<vector<int> > wideKeys;
+    for (int i = 0; i < 2000; i++) {
+        vector<int> key(1 + rand() % 3);
+        for (size_t j = 0; j < key.size(); j++) {
+            key[j] = rand() % 100;
+        }
+        wide->insert(key);
+        wideKeys.push_back(key);
+    }
+    FrozenTrie<int> *frozenWide = wide->freeze();
+    assert(frozenWide->size() == wide->size() && frozenWide->getNumKeys() == wide->getNumKeys());
+    assert(frozenWide->memoryUsage() < wide->size() * sizeof(TrieNode<int>));
+    for (size_t i = 0; i < wideKeys.size(); i++) {
+        assert(frozenWide->find(wideKeys[i]) != FrozenTrie<int>::NO_NODE);
+    }
+    assert(frozenWide->find(vector<int>(1, 100)) == FrozenTrie<int>::NO_NODE);
+    uint64_t numVisited = 0;
+    frozenWide->forEachKey([&numVisited, wide](const vector<int> &key) {
+        assert(wide->find(key) != NULL);
+        numVisited++;
+    });
+    assert(numVisited == wide->getNumKeys());
+
+    TrieNode<int> *thawedWide = frozenWide->thaw();
+    assert(*thawedWide == *wide && countsAreConsistent(thawedWide));
+    delete thawedWide;
+    delete frozenWide;
+    delete wide;
+
+    cout << "testFreeze passed." << endl;
+}
+
+void testMinimize()
+{
+    TrieNode<char> *root = new TrieNode<char>('r');
+    const char *words[] = { "tap", "taps", "top", "tops" };
+    for (int i = 0; i < 4; i++) {
+        root->insert(string(words[i]));
+    }
+    FrozenTrie<char> *frozen = root->freeze();
+    vector<string> keys;
+    frozen->forEachKey([&keys](const vector<char> &key) { keys.push_back(string(key.begin(), key.end())); });
+    frozen->minimize();
+    // Check if:
+    //      (a) the two "p" subtrees (and so the two "s" leaves) are stored once
+    //      (b) lookups, iteration and thaw() see the same Trie as before
+    assert(frozen->size() == 6 && frozen->getNumKeys() == 4);
+    FrozenTrie<char>::Node a = frozen->getChild(frozen->getChild(0, 't'), 'a');
+    FrozenTrie<char>::Node o = frozen->getChild(frozen->getChild(0, 't'), 'o');
+    // A shared node reports its lowest-numbered parent.
+    assert(frozen->getChild(a, 'p') == frozen->getChild(o, 'p') &&
+        frozen->getParent(frozen->find(string("top"))) == a);
+    assert(frozen->find(string("tops")) != FrozenTrie<char>::NO_NODE && frozen->isPrefix(string("to")) &&
+        frozen->find(string("to")) == FrozenTrie<char>::NO_NODE && !frozen->isPrefix(string("tapx")));
+    vector<string> minimizedKeys;
+    frozen->forEachKey([&minimizedKeys](const vector<char> &key) {
+        minimizedKeys.push_back(string(key.begin(), key.end()));
+    });
+    assert(minimizedKeys == keys);
+    TrieNode<char> *thawed = frozen->thaw();
+    assert(*thawed == *root && countsAreConsistent(thawed));
+    delete thawed;
+    delete frozen;
+    delete root;
+
+    // Larger Tries, including wide nodes; minimizing twice changes nothing.
+    srand(29);
+    root = randomTrie('r', 3000, 8);
+    frozen = root->freeze();
+    uint64_t numNodes = frozen->size();
+    frozen->minimize();
+    uint64_t numMinimized = frozen->size();
+    frozen->minimize();
+    assert(numMinimized < numNodes && frozen->size() == numMinimized);
+    thawed = frozen->thaw();
+    assert(*thawed == *root && countsAreConsistent(thawed));
+    delete thawed;
+    delete frozen;
+    delete root;
+
+    TrieNode<int> *wide = new TrieNode<int>();
+    for (int i = 0; i < 2000; i++) {
+        vector<int> key(1 + rand() % 3);
+        for (size_t j = 0; j < key.size(); j++) {
+            key[j] = rand() % 100;
+        }
+        wide->insert(key);
+    }
+    FrozenTrie<int> *frozenWide = wide->freeze();
+    frozenWide->minimize();
+    assert(frozenWide->size() < wide->size() && frozenWide->getNumKeys() == wide->getNumKeys());
+    uint64_t numVisited = 0;
+    frozenWide->forEachKey([&numVisited, wide, frozenWide](const vector<int> &key) {
+        assert(wide->find(key) != NULL && frozenWide->find(key) != FrozenTrie<int>::NO_NODE);
+        numVisited++;
+    });
+    assert(numVisited == wide->getNumKeys());
+    TrieNode<int> *thawedWide = frozenWide->thaw();
+    assert(*thawedWide == *wide);
+    delete thawedWide;
+    delete frozenWide;
+    delete wide;
+
+    cout << "testMinimize passed." << endl;
+}
+
+void testSerialization()
+{
+    srand(19);
+    TrieNode<char> *root = randomTrie('r', 2000, 8);
+    const char *path = "serialization_test.trie";
+    ofstream file(path, ios::binary);
+    assert(root->serialize(file));
+    file.close();
+
+    // Check if:
+    //      (a) the mapped file answers lookups like the Trie that was written
+    //      (b) reading it back gives an equal Trie
+    MappedTrie<char> mapped;
+    assert(mapped.open(path) && mapped.isOpen());
+    assert(mapped.size() == root->size() && mapped.getNumKeys() == root->getNumKeys() &&
+        mapped.getValue(mapped.getRoot()) == 'r');
+    uint64_t numVisited = 0;
+    mapped.forEachKey([&numVisited, &mapped, root](const vector<char> &key) {
+        assert(root->find(key) != NULL && mapped.find(key) != MappedTrie<char>::NO_NODE);
+        numVisited++;
+    });
+    assert(numVisited == root->getNumKeys());
+    assert(mapped.find(string("zzz")) == MappedTrie<char>::NO_NODE && mapped.isPrefix(string("")));
+    TrieNode<char> *thawed = mapped.thaw();
+    assert(*thawed == *root && countsAreConsistent(thawed));
+    delete thawed;
+    mapped.close();
+
+    // Writing is deterministic.
+    stringstream once, twice;
+    root->serialize(once);
+    root->serialize(twice);
+    assert(once.str() == twice.str());
+
+    // A flipped byte fails the checksum; a file for another value type is rejected
+    // outright.
+    string bytes = once.str();
+    bytes[bytes.size() / 2] ^= 1;
+    ofstream corrupt(path, ios::binary);
+    corrupt.write(bytes.data(), bytes.size());
+    corrupt.close();
+    assert(!mapped.open(path) && !mapped.isOpen() && mapped.open(path, false));
+    MappedTrie<int> wrongType;
+    assert(!wrongType.open(path) && !mapped.open("no_such_file.trie"));
+
+    remove(path);
+    delete root;
+    cout << "testSerialization passed." << endl;
+}
+
+void testBulkLoad()
+{
+    srand(23);
+    vector<string> keys = randomKeys(3000, 10);
+    keys.push_back(keys[0]);
+    sort(keys.begin(), keys.end());
+
+    // Check if loading sorted keys gives exactly what inserting them one by one does,
+    // child indexes included.
+    TrieNode<char> *expected = new TrieNode<char>('r');
+    for (size_t i = 0; i < keys.size(); i++) {
+        expected->insert(keys[i]);
+    }
+    TrieNode<char> *loaded = new TrieNode<char>('r');
+    assert(loaded->insertSorted(keys) && *loaded == *expected && countsAreConsistent(loaded));
+    vector<TrieNode<char> *> pending(1, loaded);
+    while (!pending.empty()) {
+        TrieNode<char> *node = pending.back();
+        pending.pop_back();
+        assert(node->getNumChildren() == 0 || node->getChildAtIndex(0) == (*node)[node->getChildAtIndex(0)->getValue()]);
+        for (int i = 0; i < node->getNumChildren(); i++) {
+            pending.push_back(node->getChildAtIndex(i));
+        }
+    }
+    // Only empty nodes can be loaded into.
+    assert(!loaded->insertSorted(keys));
+
+    // Into an arena, below an existing Trie (whose cached counts must follow), and with
+    // the empty key.
+    TrieNode<char, FullTrieTraits> *root = new TrieNode<char, FullTrieTraits>('x');
+    TrieNode<char, FullTrieTraits> *sub = root->insert(string("sub"));
+    sub->useArena(64);
+    keys.insert(keys.begin(), string());
+    assert(sub->insertSorted(keys.begin(), keys.end()) && sub->getArena()->getNumNodes() == expected->size() - 1);
+    assert(countsAreConsistent(root) && sub->getNumKeys() == expected->getNumKeys() + 1 && sub->isEndOfKey());
+
+    // Out-of-order input stops at the first key that is out of place, be it a prefix
+    // of the previous key or smaller than it.
+    vector<string> unsorted;
+    unsorted.push_back("b");
+    unsorted.push_back("bc");
+    unsorted.push_back("b");
+    TrieNode<char> *partial = new TrieNode<char>();
+    assert(!partial->insertSorted(unsorted) && partial->getNumKeys() == 2 && countsAreConsistent(partial));
+    unsorted[2] = "a";
+    TrieNode<char> *stopped = new TrieNode<char>();
+    assert(!stopped->insertSorted(unsorted.begin() + 1, unsorted.end()) && stopped->getNumKeys() == 1);
+
+    // Straight into the frozen layout: same arrays as freezing the loaded Trie.
+    keys.erase(keys.begin());
+    FrozenTrie<char> *frozen = FrozenTrie<char>::fromSorted('r', keys);
+    FrozenTrie<char> *reference = expected->freeze();
+    assert(frozen != NULL && frozen->size() == reference->size() && frozen->getNumKeys() == reference->getNumKeys());
+    for (FrozenTrie<char>::Node node = 0; node < frozen->size(); node++) {
+        assert(frozen->getValue(node) == reference->getValue(node) &&
+            frozen->isEndOfKey(node) == reference->isEndOfKey(node) &&
+            frozen->getNumChildren(node) == reference->getNumChildren(node));
+    }
+    TrieNode<char> *thawed = frozen->thaw();
+    assert(*thawed == *expected);
+    assert(FrozenTrie<char>::fromSorted('r', unsorted) == NULL);
+
+    delete expected;
+    delete loaded;
+    delete root;
+    delete partial;
+    delete stopped;
+    delete frozen;
+    delete reference;
+    delete thawed;
+    cout << "testBulkLoad passed." << endl;
+}
+
+void testPersistentTrie()
+{
+    PersistentTrie<char> *trie = new PersistentTrie<char>('r');
+    assert(trie->insert(string("car")) && trie->insert(string("cart")) && !trie->insert(string("car")));
+    assert(trie->size() == 5 && trie->getNumKeys() == 2);
+
+    // Check if:
+    //      (a) a snapshot shares every node, and does not see later changes
+    //      (b) a change copies only the nodes on its path
+    PersistentTrie<char> *snapshot = trie->clone();
+    assert(*snapshot == *trie && snapshot->countSharedNodes(*trie) == 5);
+    assert(trie->insert(string("cat")));
+    assert(trie->contains(string("cat")) && !snapshot->contains(string("cat")) && *snapshot != *trie);
+    // The root, "c" and "a" were copied; "r" and "t" are still shared.
+    assert(trie->size() == 6 && snapshot->countSharedNodes(*trie) == 2);
+
+    // Removing a key drops the nodes that led only to it, in this version only.
+    assert(trie->remove(string("cart")) && !trie->remove(string("cart")) && !trie->contains(string("cart")));
+    assert(trie->size() == 5 && trie->countKeysWithPrefix(string("ca")) == 2 && trie->isPrefix(string("ca")));
+    assert(snapshot->contains(string("cart")) && snapshot->size() == 5 && snapshot->getNumKeys() == 2);
+    assert(trie->remove(string("car")) && !trie->isPrefix(string("car")) && trie->isPrefix(string("ca")));
+
+    // Releasing the old version leaves the new one intact.
+    delete snapshot;
+    assert(trie->contains(string("cat")) && trie->getNumKeys() == 1);
+    delete trie;
+
+    // Conversions, and random changes against a TrieNode.
+    srand(29);
+    vector<string> keys = randomKeys(2000, 8);
+    TrieNode<char> *plain = new TrieNode<char>('r');
+    for (size_t i = 0; i < keys.size() / 2; i++) {
+        plain->insert(keys[i]);
+    }
+    PersistentTrie<char> current(*plain);
+    vector<PersistentTrie<char> > versions;
+    for (size_t i = keys.size() / 2; i < keys.size(); i++) {
+        if (i % 100 == 0) {
+            versions.push_back(current);
+        }
+        current.insert(keys[i]);
+        plain->insert(keys[i]);
+        if (i % 3 == 0) {
+            current.remove(keys[i / 3]);
+            plain->find(keys[i / 3])->setEndOfKey(false);
+        }
+    }
+    assert(current.getNumKeys() == plain->getNumKeys());
+    uint64_t numVisited = 0;
+    current.forEachKey([&numVisited, plain](const vector<char> &key) {
+        assert(plain->find(key) != NULL);
+        numVisited++;
+    });
+    assert(numVisited == plain->getNumKeys());
+    for (size_t v = 0; v < versions.size(); v++) {
+        size_t inserted = keys.size() / 2 + v * 100;
+        assert(versions[v].contains(keys[inserted - 1]) && !versions[v].contains(keys[inserted + 1]));
+    }
+    TrieNode<char> *thawed = PersistentTrie<char>(*plain).thaw();
+    assert(*thawed == *plain && countsAreConsistent(thawed));
+    delete thawed;
+    delete plain;
+
+    // Readers on other threads keep their snapshots while the writer goes on.
+    PersistentTrie<char> shared('r');
+    vector<thread> readers;
+    for (int r = 0; r < 4; r++) {
+        PersistentTrie<char> readerVersion(shared);
+        readers.push_back(thread([readerVersion, &keys]() {
+            uint64_t numKeys = readerVersion.getNumKeys();
+            for (size_t i = 0; i < keys.size(); i++) {
+                readerVersion.contains(keys[i]);
+            }
+            assert(readerVersion.getNumKeys() == numKeys);
+        }));
+        for (size_t i = r * 200; i < (size_t) (r + 1) * 200; i++) {
+            shared.insert(keys[i]);
+        }
+    }
+    for (size_t i = 0; i < readers.size(); i++) {
+        readers[i].join();
+    }
+    assert(shared.getNumKeys() == 800);
+
+    cout << "testPersistentTrie passed." << endl;
+}
+
+void testConcurrentTrie()
+{
+    ConcurrentTrieNode<char> *root = new ConcurrentTrieNode<char>('r');
+    root->insert(string("car"));
+    root->insert(string("cart"));
+    *root << 'd' << 'd';
+    // Check if the single-threaded behaviour matches TrieNode's.
+    assert(root->size() == 6 && root->getNumChildren() == 2 && root->hasChild('d') && (*root)['x'] == NULL);
+    assert(root->contains(string("car")) && !root->contains(string("ca")) && root->isPrefix(string("ca")));
+    ConcurrentTrieNode<char> *duplicate = new ConcurrentTrieNode<char>('c');
+    assert(!root->addChild(duplicate));
+    delete duplicate;
+    assert(root->remove(string("car")) && !root->remove(string("car")) && root->isPrefix(string("car")));
+    assert(*root >> 'd' && !(*root >> 'd') && root->size() == 5);
+    {
+        ConcurrentTrieNode<char>::ReadGuard guard;
+        ConcurrentTrieNode<char> *c = (*root)['c'];
+        assert(c != NULL && c->getValue() == 'c' && root->getChildAtIndex(0) == c && root->getChildAtIndex(1) == NULL);
+    }
+
+    // Stress: writers insert overlapping keys while readers check that every key a
+    // writer has reported as inserted is visible, and one thread keeps adding and
+    // removing a subtree.
+    srand(31);
+    const int NUM_WRITERS = 4;
+    const int KEYS_PER_WRITER = 2000;
+    vector<string> keys = randomKeys(NUM_WRITERS * KEYS_PER_WRITER, 8);
+    ConcurrentTrieNode<char> *shared = new ConcurrentTrieNode<char>();
+    atomic<int> progress[NUM_WRITERS];
+    atomic<bool> done(false);
+    vector<thread> threads;
+    for (int w = 0; w < NUM_WRITERS; w++) {
+        progress[w].store(0);
+        threads.push_back(thread([shared, &keys, &progress, w]() {
+            for (int k = 0; k < KEYS_PER_WRITER; k++) {
+                shared->insert(keys[w * KEYS_PER_WRITER + k]);
+                progress[w].store(k + 1, memory_order_release);
+            }
+        }));
+    }
+    for (int r = 0; r < 2; r++) {
+        threads.push_back(thread([shared, &keys, &progress, &done, r]() {
+            for (int round = r; !done.load(); round++) {
+                int w = round % NUM_WRITERS;
+                int inserted = progress[w].load(memory_order_acquire);
+                for (int k = 0; k < inserted; k += 7) {
+                    assert(shared->contains(keys[w * KEYS_PER_WRITER + k]));
+                }
+                uint64_t numKeys = 0;
+                shared->forEachKey([&numKeys](const vector<char> &) { numKeys++; });
+                assert(numKeys <= keys.size() + 1);
+            }
+        }));
+    }
+    threads.push_back(thread([shared, &done]() {
+        while (!done.load()) {
+            shared->insert(string("zz"));
+            *shared >> 'z';
+        }
+    }));
+    for (int w = 0; w < NUM_WRITERS; w++) {
+        threads[w].join();
+    }
+    done.store(true);
+    for (size_t i = NUM_WRITERS; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    *shared >> 'z';
+    for (size_t i = 0; i < keys.size(); i++) {
+        assert(shared->contains(keys[i]));
+    }
+    TrieNode<char> *expected = new TrieNode<char>();
+    for (size_t i = 0; i < keys.size(); i++) {
+        expected->insert(keys[i]);
+    }
+    assert(shared->size() == expected->size());
+    EpochDomain::instance().synchronize();
+
+    delete expected;
+    delete shared;
+    delete root;
+
+    // One wide node: writers add overlapping children (appended in place, or to a
+    // larger copy once the array is full) while a reader finds those already added.
+    const int NUM_CHILDREN = 5000;
+    ConcurrentTrieNode<int> *wide = new ConcurrentTrieNode<int>();
+    atomic<int> added(0);
+    threads.clear();
+    for (int w = 0; w < NUM_WRITERS; w++) {
+        threads.push_back(thread([wide, &added, w]() {
+            for (int i = w % 2; i < NUM_CHILDREN; i += 2) {
+                *wide << i;
+                if (w == 0) {
+                    added.store(i + 1, memory_order_release);
+                }
+            }
+        }));
+    }
+    threads.push_back(thread([wide, &added]() {
+        for (int i = 0; i < NUM_CHILDREN; i += 2) {
+            while (added.load(memory_order_acquire) <= i) {
+                this_thread::yield();
+            }
+            assert(wide->hasChild(i) && (*wide)[i] != NULL);
+        }
+    }));
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    assert(wide->getNumChildren() == NUM_CHILDREN && !wide->hasChild(NUM_CHILDREN));
+    for (int i = 0; i < NUM_CHILDREN; i += 3) {
+        assert(*wide >> i && !wide->hasChild(i));
+    }
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        assert(wide->hasChild(i) == (i % 3 != 0));
+    }
+    delete wide;
+    cout << "testConcurrentTrie passed." << endl;
+}
+
+void testDeepTrie()
+{
+    const int DEPTH = 1000000;
+    clock_t start = clock();
+
+    // Build a chain that is DEPTH levels deep.
+    vector<int> key(DEPTH);
+    for (int i = 0; i < DEPTH; i++) {
+        key[i] = i % 10;
+    }
+    TrieNode<int> *chain = new TrieNode<int>(-1);
+    chain->insert(key);
+    assert(chain->size() == DEPTH + 1 && chain->find(key) != NULL);
+
+    // Clone, compare, merge and display it.
+    TrieNode<int> *clone = chain->clone();
+    assert(*clone == *chain);
+    key[DEPTH - 1] = 42;
+    clone->insert(key);
+    assert(*clone != *chain);
+    TrieNode<int> *expected = clone->clone();
+    *chain += *clone;
+    assert(chain->size() == DEPTH + 2 && *chain == *clone);
+    assert(distance(chain->postOrder().begin(), chain->postOrder().end()) == DEPTH + 2 &&
+        distance(chain->keys().begin(), chain->keys().end()) == 2);
+    TrieNode<int> *moved = chain->clone();
+    *moved += std::move(*expected);
+    assert(*moved == *chain && expected->isSingleton());
+    delete moved;
+    delete expected;
+    stringstream output;
+    output << *chain;
+    assert(!output.str().empty());
+
+    // Destroy it, including through clear().
+    delete clone;
+    chain->clear();
+    assert(chain->isSingleton());
+    delete chain;
+
+    cout << "testDeepTrie passed (" << (clock() - start) * 1000 / CLOCKS_PER_SEC << " ms)." << endl;
+}
+
 /**
  * Test whether the Trie is being displayed correctly in stdout.
  */
@@ -175,6 +2225,31 @@ int main()
     testInsertion();
 	testDeletion();
     testMerge();
+    testPathOperations();
+    testWideNode();
+    testByteNode();
+    testRenameChild();
+    testArena();
+    testCounts();
+    testMoveMerge();
+    testCopyMove();
+    testStructuralHash();
+    testTopK();
+    testFuzzyFind();
+    testIterators();
+    testExport();
+    testStats();
+    testNoParentTrie();
+    testTraits();
+    testParallelMerge();
+    testRadixTrie();
+    testFreeze();
+    testMinimize();
+    testSerialization();
+    testBulkLoad();
+    testPersistentTrie();
+    testConcurrentTrie();
+    testDeepTrie();
     testDisplay(); // Check visually.
 
     return 0;
@@ -9,72 +9,218 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <stdint.h>
+#include <type_traits>
+
+#include "src/trieStats.h"
+#include "src/trieNodeTraits.h"
+#include "src/childList.h"
+#include "src/childIndex.h"
+#include "src/structuralHash.h"
+#include "src/arena.h"
+#include "src/threadPool.h"
+#include "src/frozenTrie.h"
+#include "src/mappedTrie.h"
+#include "src/persistentTrie.h"
+#include "src/iterator.h"
+#include "src/exporter.h"
+
+template<class Node> struct ParallelMergeState;
 
 /* Declaration */
-template<class T> class TrieNode
+/**
+ * Traits picks the policies: child container, allocator, parent pointers and what each
+ * TrieNode caches (see src/trieNodeTraits.h). The optional members live in the
+ * TrieParentLink, TrieCountCache, TrieHashCache, TrieWeights and TrieArenaLink bases,
+ * which are empty when they are turned off; endOfKey sits next to value so that, for
+ * small T, the two share a word.
+ */
+template<class T, class Traits> class TrieNode : private TrieParentLink<TrieNode<T, Traits>, Traits::KEEP_PARENT>,
+    private TrieCountCache<Traits::CACHE_COUNTS>, private TrieHashCache<Traits::CACHE_HASHES>,
+    private TrieWeights<Traits::KEEP_WEIGHTS>,
+    private TrieArenaLink<typename Traits::template NodeAllocator<TrieNode<T, Traits> >::type, Traits::USE_ARENAS>
 {
+    static_assert(Traits::KEEP_PARENT || (!Traits::CACHE_COUNTS && !Traits::CACHE_HASHES),
+        "without Traits::KEEP_PARENT, changes below the root cannot reach cached counts or hashes");
+
 private:
+    typedef typename Traits::template ChildContainer<TrieNode>::type Children;
+    typedef typename Traits::template NodeAllocator<TrieNode>::type Arena;
+
+    // Whether moving a TrieNode can be noexcept: it may have to copy its value, or the
+    // nodes of another arena, but allocates nothing else (see src/move.h).
+    static const bool NOTHROW_MOVE = !Traits::USE_ARENAS && std::is_nothrow_copy_constructible<T>::value &&
+        std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value;
+
     // instance variables
     T value;
-    TrieNode *parent;
-    std::vector<TrieNode *> children;
+    bool endOfKey;
+    // Empty when the children index themselves (a ByteChildList); it then shares a word
+    // with value and endOfKey.
+    ChildIndex<T, TrieNode, Children, Traits::COUNT_OPERATIONS> childIndex;
+    Children children;      // a ChildList keeps up to INLINE_SIZE children without a heap block
 
     // helper methods
+    void adjustCounts(int64_t nodesDelta, int64_t keysDelta);
+    void recount();
+    void countSubtree(uint64_t &numNodes, uint64_t &numKeys);
+    void invalidateHash();
+    static double NO_WEIGHT();
+    void raiseMaxWeight(double weight);
+    void refreshMaxWeight();
+    template<class V> bool changeValue(V &&value);
+    static T takeValue(TrieNode &other);
+    void mergeEndOfKey(TrieNode &source);
+    void attachChild(TrieNode *child);
+    void adoptChildren(TrieNode &from);
+    template<class V> TrieNode *createNode(V &&value);
+    TrieNode *cloneInto(Arena *arena);
+    void releaseArena();
+    void copyChildren(const TrieNode &from);
+    void takeSubtree(TrieNode &from);
+    int indexOfChild(const T &value);
+    TrieNode *findChild(const T &value);
+    template<class Iter> TrieNode *descend(Iter &first, Iter last);
     bool equals(TrieNode &other);
-	TrieNode *removeChild(T value);
+	TrieNode *removeChild(const T &value);
     void merge(TrieNode &other);
+    void mergeMove(TrieNode &other);
+    void mergeShared(TrieNode &other, bool splice);
+    void parallelMerge(const std::vector<TrieNode *> &sources, unsigned numThreads);
+    void mergeGroup(ParallelMergeState<TrieNode> &state, const std::vector<TrieNode *> &sources,
+        size_t depth, unsigned worker);
+
+    friend class ChildIndex<T, TrieNode, Children, Traits::COUNT_OPERATIONS>;
+    template<class Node, class NodeChildren, bool COUNTING> friend class ByteChildIndex;
+    template<class Node> friend class ByteChildList;
+    friend class FrozenTrie<T>;
+    friend class MappedTrie<T>;
+    friend class PersistentTrie<T>;
+    friend struct TrieWalk<T, Traits>;
+    friend struct TrieAncestors<TrieNode, Traits::KEEP_PARENT>;
+    friend class TrieLevelOrderIterator<T, Traits>;
+    friend class TrieKeyIterator<T, Traits>;
+    friend class TrieExporter<T, Traits>;
 
 public:
     // Constructors
     TrieNode(); 
-    TrieNode(T val);
-    TrieNode(TrieNode *parentRef, T val);
+    TrieNode(const T &val);
+    TrieNode(T &&val);
+    TrieNode(TrieNode *parentRef, const T &val);
+    TrieNode(TrieNode *parentRef, T &&val);
+
+    // Copying and moving (whole subtrees, see src/move.h)
+    TrieNode(const TrieNode &other);
+    TrieNode(TrieNode &&other) noexcept(NOTHROW_MOVE);
+    TrieNode &operator=(const TrieNode &other);
+    TrieNode &operator=(TrieNode &&other) noexcept(NOTHROW_MOVE);
+
+    // Allocation (see src/arena.h)
+    static void *operator new(size_t size);
+    static void *operator new(size_t size, Arena *arena);
+    static void operator delete(void *ptr);
+    static void operator delete(void *ptr, Arena *arena);
+    bool useArena(size_t nodesPerBlock = 4096);
+    Arena *getArena();
 
     // Accessors
     TrieNode *getParent();
     void setParent(TrieNode *parent);
-    T getValue();
-    void setValue(T value);
+    const T &getValue() const;
+    bool setValue(const T &value);
+    bool setValue(T &&value);
+    bool isEndOfKey();
+    void setEndOfKey(bool endOfKey);
 
     // Size
     int getNumChildren();
     bool hasChildren();
 	bool hasParent();
 	bool isSingleton();
-	int size();
+	uint64_t size();
+	uint64_t getNumKeys();
+
+    // Introspection (shape and memory of this subtree, see src/trieStats.h)
+    TrieStats stats();
 
     // Indexing
 	TrieNode *getChildAtIndex(int index);
     void setChildAtIndex(int index, TrieNode *updatedChild);
-    int getIndexOfChild(T value);
-    TrieNode *operator[](T value);
-    bool hasChild(T value);
+    int getIndexOfChild(const T &value);
+    TrieNode *operator[](const T &value);
+    bool hasChild(const T &value);
     bool hasChild(TrieNode *possibleChild);
 
     // Cloning (deep-copy)
     TrieNode *clone();
 
+    // Traversal (iterators over this subtree, see src/iterator.h)
+    TriePreOrderIterator<T, Traits> begin();
+    TriePreOrderIterator<T, Traits> end();
+    TrieRange<TriePreOrderIterator<T, Traits> > preOrder();
+    TrieRange<TriePostOrderIterator<T, Traits> > postOrder();
+    TrieRange<TrieLevelOrderIterator<T, Traits> > levelOrder();
+    TrieRange<TrieKeyIterator<T, Traits> > keys();
+    template<class Key> TrieRange<TrieKeyIterator<T, Traits> > keys(const Key &prefix);
+
+    // Freezing (flat read-only copy, see src/frozenTrie.h)
+    FrozenTrie<T> *freeze();
+
+    // Serialization (binary, see src/trieFile.h; read back with MappedTrie)
+    bool serialize(std::ostream &output);
+
     // Insertions
     bool addChild(TrieNode *child);
     TrieNode &operator<<(TrieNode &child);
-    TrieNode &operator<<(T value);
+    TrieNode &operator<<(const T &value);
+    TrieNode &operator<<(T &&value);
+    template<class... Args> TrieNode *emplaceChild(Args &&... args);
+
+    // Path operations (whole keys, relative to this TrieNode)
+    template<class Iter> TrieNode *insert(Iter first, Iter last);
+    template<class Key> TrieNode *insert(const Key &key);
+    template<class Iter> bool insertSorted(Iter firstKey, Iter lastKey);
+    template<class Keys> bool insertSorted(const Keys &keys);
+    template<class Key> TrieNode *find(const Key &key);
+    template<class Key> bool isPrefix(const Key &key);
+    template<class Key> TrieNode *longestPrefix(const Key &key, size_t *length = NULL);
+    template<class Key> uint64_t countKeysWithPrefix(const Key &prefix);
+    template<class Key> std::vector<std::pair<std::vector<T>, size_t> > fuzzyFind(const Key &query,
+        size_t maxDistance);
+
+    // Weights and top-k completion (see src/weight.h)
+    double getWeight();
+    void setWeight(double weight);
+    template<class Key> TrieNode *insert(const Key &key, double weight);
+    template<class Key> std::vector<std::pair<std::vector<T>, double> > topK(const Key &prefix, size_t k);
 
     // Deletions
 	TrieNode *operator>>(TrieNode &child);
-	TrieNode *operator>>(T value);
+	TrieNode *operator>>(const T &value);
 
     // Comparisons
+    uint64_t getHash();
     bool operator==(TrieNode &other);
     bool operator!=(TrieNode &other);
 
     // Merging Tries
     void operator+=(TrieNode &other);
+    void operator+=(TrieNode &&other);
+    void mergeAll(const std::vector<TrieNode *> &others, unsigned numThreads = 0);
 
     // Display methods
     // "friend" - Allows outsiders to access & override these methods
-    template<class NodeType> friend inline std::string displayNode(TrieNode<NodeType> &tn);
-    template<class NodeType> friend inline void displayTrie(std::ostream &output, TrieNode<NodeType> &tn);
-    template<class NodeType> friend inline std::ostream &operator<<(std::ostream &output, TrieNode<NodeType> &tn); 
+    template<class NodeType, class NodeTraits> friend inline std::string displayNode(
+        TrieNode<NodeType, NodeTraits> &tn);
+    template<class NodeType, class NodeTraits> friend inline void displayTrie(std::ostream &output,
+        TrieNode<NodeType, NodeTraits> &tn);
+    template<class NodeType, class NodeTraits> friend inline std::ostream &operator<<(std::ostream &output,
+        TrieNode<NodeType, NodeTraits> &tn);
 
     // Destructor
 	void clear();
@@ -83,13 +229,24 @@ public:
 
 /* Implementation */
 #include "src/init.h"
+#include "src/allocate.h"
 #include "src/size.h"
+#include "src/stats.h"
 #include "src/retrieve.h"
 #include "src/clone.h"
+#include "src/move.h"
+#include "src/freeze.h"
+#include "src/serialize.h"
 #include "src/insert.h"
+#include "src/path.h"
+#include "src/bulkLoad.h"
+#include "src/weight.h"
+#include "src/fuzzy.h"
+#include "src/traverse.h"
 #include "src/delete.h"
 #include "src/compare.h"
 #include "src/merge.h"
+#include "src/parallelMerge.h"
 #include "src/display.h"
 #include "src/cleanup.h"
 